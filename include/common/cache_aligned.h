@@ -0,0 +1,108 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_COMMON_CACHE_ALIGNED_H
+#define GRPPI_COMMON_CACHE_ALIGNED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace grppi {
+
+/**
+\brief Size in bytes used to keep objects in different cache lines.
+\note std::hardware_destructive_interference_size is not used as it requires
+C++17 and its value may differ between compilation units.
+*/
+constexpr std::size_t cache_line_size = 64;
+
+/**
+\brief Value padded and aligned to occupy its own cache lines.
+Values written concurrently by different threads (e.g. partial results of a
+reduction) are stored in this wrapper to avoid false sharing.
+\tparam T Type of the wrapped value.
+*/
+template <typename T>
+struct alignas(alignof(T) > cache_line_size ? alignof(T) : cache_line_size)
+cache_aligned {
+  T value{};
+};
+
+/**
+\brief Allocator returning storage aligned to cache line boundaries.
+Over-aligned types are not honoured by the default allocator before C++17,
+so that storage is over-allocated and the start address is aligned by hand.
+\tparam T Type of the allocated values.
+*/
+template <typename T>
+class cache_aligned_allocator {
+public:
+  using value_type = T;
+
+  cache_aligned_allocator() noexcept = default;
+
+  template <typename U>
+  cache_aligned_allocator(const cache_aligned_allocator<U> &) noexcept {}
+
+  T * allocate(std::size_t n) {
+    void * raw = ::operator new(n * sizeof(T) + alignment);
+    // At least one pointer fits before the aligned address to keep raw
+    auto address = (reinterpret_cast<std::uintptr_t>(raw) + alignment) &
+        ~static_cast<std::uintptr_t>(alignment - 1);
+    reinterpret_cast<void**>(address)[-1] = raw;
+    return reinterpret_cast<T*>(address);
+  }
+
+  void deallocate(T * p, std::size_t) noexcept {
+    ::operator delete(reinterpret_cast<void**>(p)[-1]);
+  }
+
+private:
+  constexpr static std::size_t alignment =
+      (alignof(T) > cache_line_size) ? alignof(T) : cache_line_size;
+};
+
+template <typename T, typename U>
+bool operator==(const cache_aligned_allocator<T> &,
+                const cache_aligned_allocator<U> &) noexcept
+{
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const cache_aligned_allocator<T> &,
+                const cache_aligned_allocator<U> &) noexcept
+{
+  return false;
+}
+
+/**
+\brief Sequence of values where every value is in its own cache lines.
+\tparam T Type of the values.
+*/
+template <typename T>
+using cache_aligned_vector =
+    std::vector<cache_aligned<T>, cache_aligned_allocator<cache_aligned<T>>>;
+
+}
+
+#endif
@@ -0,0 +1,142 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_COMMON_CHUNK_SCHEDULER_H
+#define GRPPI_COMMON_CHUNK_SCHEDULER_H
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+namespace grppi {
+
+/**
+\brief Scheduling of the iterations of data parallel patterns.
+- fixed: The sequence is split into as many equal chunks as the concurrency
+degree and every chunk is assigned to a different thread (default).
+- pinned: Same chunks as fixed, but chunk i is always run by the same thread 
+in every data parallel pattern, even if that thread is busy.
+- dynamic: The sequence is split into chunks of a fixed grain size that 
+threads take on demand.
+- guided: Threads take chunks on demand. Chunks are proportional to the 
+number of remaining elements and never smaller than the grain size.
+*/
+enum class scheduling_mode { fixed, pinned, dynamic, guided };
+
+/**
+\brief Partition of a sequence into chunks according to a scheduling mode.
+Chunks are numbered in the order they appear in the sequence. In on demand 
+modes, threads claim chunks through an atomic cursor, so that chunks are 
+claimed in increasing order.
+*/
+class chunk_scheduler {
+public:
+
+  /**
+  \brief Partitions a sequence into chunks.
+  \param mode Scheduling mode.
+  \param sequence_size Number of elements in the sequence.
+  \param num_threads Number of threads taking part in the computation.
+  \param grain Minimum number of elements in a chunk for on demand modes. 
+  A value of 0 lets the scheduler select a grain size.
+  */
+  chunk_scheduler(scheduling_mode mode, std::size_t sequence_size, 
+                  int num_threads, std::size_t grain = 0);
+
+  chunk_scheduler(const chunk_scheduler &) = delete;
+  chunk_scheduler & operator=(const chunk_scheduler &) = delete;
+
+  /**
+  \brief Get the scheduling mode.
+  */
+  scheduling_mode mode() const noexcept { return mode_; }
+
+  /**
+  \brief Get the number of chunks in the partition. There is always at 
+  least one chunk.
+  */
+  std::size_t num_chunks() const noexcept { return offsets_.size() - 1; }
+
+  /**
+  \brief Get the position of the first element of a chunk.
+  */
+  std::size_t chunk_begin(std::size_t index) const noexcept { 
+    return offsets_[index]; 
+  }
+
+  /**
+  \brief Get the number of elements of a chunk.
+  */
+  std::size_t chunk_size(std::size_t index) const noexcept { 
+    return offsets_[index+1] - offsets_[index]; 
+  }
+
+  /**
+  \brief Claims the next chunk not yet claimed by any thread.
+  \param index Index of the claimed chunk.
+  \return false if all chunks have already been claimed.
+  */
+  bool claim(std::size_t & index) noexcept {
+    index = next_.fetch_add(1, std::memory_order_relaxed);
+    return index < num_chunks();
+  }
+
+private:
+  scheduling_mode mode_;
+  std::vector<std::size_t> offsets_;
+  std::atomic<std::size_t> next_{0};
+};
+
+inline chunk_scheduler::chunk_scheduler(scheduling_mode mode, 
+    std::size_t sequence_size, int num_threads, std::size_t grain) :
+  mode_{mode}
+{
+  const std::size_t threads = (num_threads > 0) ? num_threads : 1;
+  offsets_.push_back(0);
+  switch (mode_) {
+    case scheduling_mode::fixed:
+    case scheduling_mode::pinned: {
+      const auto size = sequence_size / threads;
+      for (std::size_t i=1; i<threads; ++i) { offsets_.push_back(size * i); }
+      break;
+    }
+    case scheduling_mode::dynamic: {
+      const auto size = (grain > 0) ? grain : 
+          std::max<std::size_t>(1, sequence_size / (8 * threads));
+      for (auto i=size; i<sequence_size; i+=size) { offsets_.push_back(i); }
+      break;
+    }
+    case scheduling_mode::guided: {
+      const auto min_size = std::max<std::size_t>(1, grain);
+      std::size_t i = 0;
+      while (sequence_size - i > min_size) {
+        const auto remaining = sequence_size - i;
+        i += std::max(min_size, (remaining + 2*threads - 1) / (2*threads));
+        if (i < sequence_size) offsets_.push_back(i);
+      }
+      break;
+    }
+  }
+  offsets_.push_back(sequence_size);
+}
+
+}
+
+#endif
@@ -61,6 +61,13 @@ constexpr bool supports_reduce() { return false; }
 template <typename E>
 constexpr bool supports_map_reduce() { return false; }
 
+/**
+\brief Determines if an execution policy supports the scan pattern.
+\note This must be specialized by every execution policy supporting the pattern.
+*/
+template <typename E>
+constexpr bool supports_scan() { return false; }
+
 /**
 \brief Determines if an execution policy supports the stencil pattern.
 \note This must be specialized by every execution policy supporting the pattern.
@@ -0,0 +1,286 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_COMMON_EXPRESSION_PATTERN_H
+#define GRPPI_COMMON_EXPRESSION_PATTERN_H
+
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+#include "filter_pattern.h"
+
+namespace grppi {
+
+/**
+\brief Representation of a transformation stage of a map expression.
+\tparam Transformer Callable type for the transformation.
+*/
+template <typename Transformer>
+class transform_t {
+public:
+
+  /**
+  \brief Constructs a transformation stage.
+  \param t Transformer for the stage.
+  */
+  template <typename T, typename = std::enable_if_t<
+      !std::is_same<std::decay_t<T>, transform_t>::value>>
+  transform_t(T && t) noexcept :
+    transformer_{std::forward<T>(t)}
+  {}
+
+  /**
+  \brief Invokes the transformer of the stage over a data item.
+  */
+  template <typename I>
+  auto operator()(I && item) const {
+    return transformer_(std::forward<I>(item));
+  }
+
+private:
+  Transformer transformer_;
+};
+
+/**
+\brief Representation of the reduction ending a map expression.
+\tparam Identity Type for the identity value.
+\tparam Combiner Callable type for the combination.
+*/
+template <typename Identity, typename Combiner>
+class fold_t {
+public:
+
+  /**
+  \brief Constructs a reduction with an identity and a combiner.
+  */
+  template <typename I, typename C>
+  fold_t(I && identity, C && combine_op) :
+    identity_{std::forward<I>(identity)},
+    combiner_{std::forward<C>(combine_op)}
+  {}
+
+  /**
+  \brief Identity value of the reduction.
+  */
+  const Identity & identity() const noexcept { return identity_; }
+
+  /**
+  \brief Combination callable object of the reduction.
+  */
+  const Combiner & combiner() const noexcept { return combiner_; }
+
+private:
+  Identity identity_;
+  Combiner combiner_;
+};
+
+/**
+\brief Representation of the output ending a map expression.
+\tparam OutputIt Iterator type for the output sequence.
+*/
+template <typename OutputIt>
+class store_t {
+public:
+
+  /**
+  \brief Constructs an output stage from the first output position.
+  */
+  explicit store_t(OutputIt first_out) noexcept : first_out_{first_out} {}
+
+  /**
+  \brief Iterator to the first element of the output sequence.
+  */
+  OutputIt first() const noexcept { return first_out_; }
+
+private:
+  OutputIt first_out_;
+};
+
+namespace internal {
+
+template <typename ... Stages>
+struct has_filter : std::false_type {};
+
+template <typename Stage, typename ... Stages>
+struct has_filter<Stage, Stages...> : 
+  std::integral_constant<bool, 
+      grppi::is_filter<Stage> || has_filter<Stages...>::value>
+{};
+
+} // namespace internal
+
+/**
+\brief Lazy expression of stages applied to every element of a sequence.
+Stages are transformations (transform_t) and filters (filter_t). Nothing is 
+computed until the expression is reduced or stored. Then, all the stages are 
+fused into a single transformation, so that the sequence is traversed once 
+and no intermediate sequence is built.
+\tparam Execution Execution policy type.
+\tparam InputIt Iterator type for the input sequence.
+\tparam Stages Types of the stages.
+*/
+template <typename Execution, typename InputIt, typename ... Stages>
+class map_expression {
+public:
+
+  /**
+  \brief Constructs an expression on a sequence.
+  \param ex Execution policy object. It must outlive the expression.
+  \param first Iterator to the first element of the sequence.
+  \param size Number of elements in the sequence.
+  \param stages Stages of the expression.
+  */
+  map_expression(const Execution & ex, InputIt first, std::size_t size,
+                 std::tuple<Stages...> stages) :
+    ex_{ex}, first_{first}, size_{size}, stages_{std::move(stages)}
+  {}
+
+  /**
+  \brief Builds an expression with an additional stage at the end.
+  */
+  template <typename Stage>
+  auto append(Stage && stage) const {
+    return map_expression<Execution, InputIt, Stages..., std::decay_t<Stage>>{
+        ex_, first_, size_, 
+        std::tuple_cat(stages_, std::make_tuple(std::forward<Stage>(stage)))};
+  }
+
+  /**
+  \brief Evaluates the expression reducing the elements passing all the
+  filters.
+  \param identity Identity value for the reduction.
+  \param combine_op Combination callable object.
+  \return The reduction of the transformed elements.
+  \note Elements discarded by a filter contribute with the identity value.
+  */
+  template <typename Identity, typename Combiner>
+  auto reduce(Identity && identity, Combiner && combine_op) const {
+    return reduce(std::forward<Identity>(identity), 
+        std::forward<Combiner>(combine_op), 
+        internal::has_filter<Stages...>{});
+  }
+
+  /**
+  \brief Evaluates the expression writing the transformed elements into an 
+  output sequence.
+  \param first_out Iterator to the first element of the output sequence.
+  \pre The expression has no filters.
+  */
+  template <typename OutputIt>
+  void store(OutputIt first_out) const {
+    static_assert(!internal::has_filter<Stages...>(),
+        "an expression with filters cannot be stored");
+    ex_.map(std::make_tuple(first_), first_out, size_, 
+        [this](auto && item) { 
+          return this->transform_from<0>(std::forward<decltype(item)>(item)); 
+        });
+  }
+
+private:
+
+  template <typename Identity, typename Combiner>
+  auto reduce(Identity && identity, Combiner && combine_op, 
+              std::false_type) const 
+  {
+    return ex_.map_reduce(std::make_tuple(first_), size_, 
+        std::forward<Identity>(identity),
+        [this](auto && item) { 
+          return this->transform_from<0>(std::forward<decltype(item)>(item)); 
+        },
+        std::forward<Combiner>(combine_op));
+  }
+
+  template <typename Identity, typename Combiner>
+  auto reduce(Identity && identity, Combiner && combine_op, 
+              std::true_type) const 
+  {
+    using result_type = std::decay_t<Identity>;
+    const result_type init{std::forward<Identity>(identity)};
+    return ex_.map_reduce(std::make_tuple(first_), size_, init,
+        [this,&init](auto && item) {
+          result_type result{init};
+          this->apply_from<0>(std::forward<decltype(item)>(item), 
+              [&result](auto && x) { 
+                result = std::forward<decltype(x)>(x); 
+              });
+          return result;
+        },
+        std::forward<Combiner>(combine_op));
+  }
+
+  // Applies the transformations from stage I on (no filters)
+  template <std::size_t I, typename Item>
+  auto transform_from(Item && item) const {
+    return transform_from<I>(std::forward<Item>(item), 
+        std::integral_constant<bool, I == sizeof...(Stages)>{});
+  }
+
+  template <std::size_t I, typename Item>
+  auto transform_from(Item && item, std::true_type) const {
+    return std::decay_t<Item>(std::forward<Item>(item));
+  }
+
+  template <std::size_t I, typename Item>
+  auto transform_from(Item && item, std::false_type) const {
+    return transform_from<I+1>(std::get<I>(stages_)(std::forward<Item>(item)));
+  }
+
+  // Applies the stages from stage I on and passes the result to a sink
+  template <std::size_t I, typename Item, typename Sink>
+  void apply_from(Item && item, Sink && sink) const {
+    apply_from<I>(std::forward<Item>(item), sink,
+        std::integral_constant<bool, I == sizeof...(Stages)>{});
+  }
+
+  template <std::size_t I, typename Item, typename Sink>
+  void apply_from(Item && item, Sink & sink, std::true_type) const {
+    sink(std::forward<Item>(item));
+  }
+
+  template <std::size_t I, typename Item, typename Sink>
+  void apply_from(Item && item, Sink & sink, std::false_type) const {
+    apply_stage<I>(std::get<I>(stages_), std::forward<Item>(item), sink);
+  }
+
+  template <std::size_t I, typename Predicate, typename Item, typename Sink>
+  void apply_stage(const filter_t<Predicate> & stage, Item && item, 
+                   Sink & sink) const 
+  {
+    if (stage(item)) apply_from<I+1>(std::forward<Item>(item), sink);
+  }
+
+  template <std::size_t I, typename Transformer, typename Item, typename Sink>
+  void apply_stage(const transform_t<Transformer> & stage, Item && item, 
+                   Sink & sink) const 
+  {
+    apply_from<I+1>(stage(std::forward<Item>(item)), sink);
+  }
+
+private:
+  const Execution & ex_;
+  InputIt first_;
+  std::size_t size_;
+  std::tuple<Stages...> stages_;
+};
+
+}
+
+#endif
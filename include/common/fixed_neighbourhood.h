@@ -0,0 +1,253 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_COMMON_FIXED_NEIGHBOURHOOD_H
+#define GRPPI_COMMON_FIXED_NEIGHBOURHOOD_H
+
+#include <array>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "grid_stencil.h"
+#include "iterator.h"
+
+namespace grppi {
+
+/**
+\brief Neighbourhood of a sequence stencil given by offsets known at compile
+time.
+When given as the neighbourhood operation of a stencil, the transformation 
+operation receives the values of the neighbours in a std::array, following
+the order of the offsets. No memory is allocated for the neighbourhoods.
+\tparam Offsets Offsets of the neighbours relative to every element.
+*/
+template <int ... Offsets>
+struct neighbour_offsets {
+  static_assert(sizeof...(Offsets) > 0, "A neighbourhood needs an offset");
+
+  /// Policy for neighbours outside the sequence.
+  boundary_mode boundary = boundary_mode::clamp;
+};
+
+/**
+\brief Neighbourhood operation for a sequence with neighbours at fixed 
+offsets.
+\tparam InputIt Random access iterator type of the sequence.
+\tparam Offsets Offsets of the neighbours relative to every element.
+*/
+template <typename InputIt, int ... Offsets>
+class fixed_neighbourhood {
+public:
+  using value_type = typename std::iterator_traits<InputIt>::value_type;
+  using neighbours_type = std::array<value_type, sizeof...(Offsets)>;
+
+  static_assert(std::is_base_of<std::random_access_iterator_tag,
+      typename std::iterator_traits<InputIt>::iterator_category>::value,
+      "fixed neighbourhoods require random access iterators");
+
+  /**
+  \brief Creates the neighbourhood of a sequence.
+  \param first Iterator to the first element of the sequence.
+  \param size Number of elements of the sequence.
+  \param boundary Policy for neighbours outside the sequence.
+  */
+  fixed_neighbourhood(InputIt first, std::size_t size, 
+                      boundary_mode boundary) noexcept :
+    first_{first}, size_{static_cast<std::ptrdiff_t>(size)}, 
+    boundary_{boundary}
+  {}
+
+  /**
+  \brief Get the values of the neighbours of an element.
+  Iterators to additional sequences are ignored.
+  */
+  template <typename ... OtherIts>
+  neighbours_type operator()(InputIt it, OtherIts ...) const {
+    return checked(it - first_);
+  }
+
+  /**
+  \brief Applies a stencil transformation to consecutive elements of the 
+  sequence. Elements whose neighbours are all in the sequence, are accessed 
+  without boundary checks.
+  \param firsts Tuple of iterators to the first element. Only the first
+  iterator is used.
+  \param first_out Iterator to the output sequence.
+  \param size Number of elements.
+  \param transform_op Stencil transformation invoked with an iterator to 
+  every element and the values of its neighbours.
+  */
+  template <typename ... InputIterators, typename OutputIt, 
+            typename Transformer>
+  void apply(std::tuple<InputIterators...> firsts, OutputIt first_out,
+             std::size_t size, Transformer && transform_op) const;
+
+private:
+  static constexpr std::ptrdiff_t min_offset = 
+      std::min({0, Offsets...});
+  static constexpr std::ptrdiff_t max_offset = 
+      std::max({0, Offsets...});
+
+  neighbours_type checked(std::ptrdiff_t index) const {
+    return {{ value(index + Offsets)... }};
+  }
+
+  neighbours_type unchecked(InputIt it) const {
+    return {{ it[Offsets]... }};
+  }
+
+  value_type value(std::ptrdiff_t index) const;
+
+private:
+  InputIt first_;
+  std::ptrdiff_t size_;
+  boundary_mode boundary_;
+};
+
+template <typename InputIt, int ... Offsets>
+typename fixed_neighbourhood<InputIt,Offsets...>::value_type 
+fixed_neighbourhood<InputIt,Offsets...>::value(std::ptrdiff_t index) const
+{
+  if (index >= 0 && index < size_) return first_[index];
+  switch (boundary_) {
+    case boundary_mode::clamp:
+      return first_[std::min(std::max(index, std::ptrdiff_t{0}), size_-1)];
+    case boundary_mode::periodic:
+      return first_[((index % size_) + size_) % size_];
+    case boundary_mode::constant:
+      break;
+  }
+  return value_type{};
+}
+
+template <typename InputIt, int ... Offsets>
+template <typename ... InputIterators, typename OutputIt, 
+          typename Transformer>
+void fixed_neighbourhood<InputIt,Offsets...>::apply(
+    std::tuple<InputIterators...> firsts, OutputIt first_out,
+    std::size_t size, Transformer && transform_op) const
+{
+  const std::ptrdiff_t begin = std::get<0>(firsts) - first_;
+  const std::ptrdiff_t end = begin + static_cast<std::ptrdiff_t>(size);
+  const auto interior_begin = std::min(std::max(begin, -min_offset), end);
+  const auto interior_end = std::max(std::min(end, size_ - max_offset), 
+      interior_begin);
+
+  auto it = std::next(first_, begin);
+  for (auto i = begin; i < interior_begin; ++i, ++it) {
+    *first_out++ = transform_op(it, checked(i));
+  }
+  for (auto i = interior_begin; i < interior_end; ++i, ++it) {
+    *first_out++ = transform_op(it, unchecked(it));
+  }
+  for (auto i = interior_end; i < end; ++i, ++it) {
+    *first_out++ = transform_op(it, checked(i));
+  }
+}
+
+/**
+\brief Determines if a type is a fixed neighbourhood operation.
+*/
+template <typename T>
+struct is_fixed_neighbourhood : std::false_type {};
+
+template <typename InputIt, int ... Offsets>
+struct is_fixed_neighbourhood<fixed_neighbourhood<InputIt,Offsets...>> :
+  std::true_type {};
+
+namespace internal {
+
+template <typename InputIt, typename Neighbourhood>
+decltype(auto) bind_neighbourhood(InputIt, std::size_t, 
+    Neighbourhood && neighbour_op, std::false_type) 
+{
+  return std::forward<Neighbourhood>(neighbour_op);
+}
+
+template <typename InputIt, int ... Offsets>
+auto bind_neighbourhood(InputIt first, std::size_t size, 
+    const neighbour_offsets<Offsets...> & offsets, std::true_type) 
+{
+  return fixed_neighbourhood<InputIt, Offsets...>{first, size, 
+      offsets.boundary};
+}
+
+template <typename T>
+struct is_neighbour_offsets : std::false_type {};
+
+template <int ... Offsets>
+struct is_neighbour_offsets<neighbour_offsets<Offsets...>> : std::true_type {};
+
+/**
+\brief Binds a neighbourhood given by offsets to a sequence. Other 
+neighbourhood operations are forwarded unchanged.
+*/
+template <typename InputIt, typename Neighbourhood>
+decltype(auto) bind_neighbourhood(InputIt first, std::size_t size, 
+    Neighbourhood && neighbour_op) 
+{
+  return bind_neighbourhood(first, size, 
+      std::forward<Neighbourhood>(neighbour_op), 
+      is_neighbour_offsets<std::decay_t<Neighbourhood>>{});
+}
+
+/**
+\brief Applies a stencil to a sequence, invoking the neighbourhood operation
+for every element.
+*/
+template <typename ... InputIterators, typename OutputIt, 
+          typename StencilTransformer, typename Neighbourhood>
+void stencil_sequence(std::tuple<InputIterators...> firsts, 
+                      OutputIt first_out, std::size_t size,
+                      StencilTransformer && transform_op, 
+                      Neighbourhood && neighbour_op, std::false_type)
+{
+  const auto last = std::next(std::get<0>(firsts), size);
+  while (std::get<0>(firsts) != last) {
+    const auto f = std::get<0>(firsts);
+    *first_out++ = transform_op(f, 
+        grppi::apply_increment(std::forward<Neighbourhood>(neighbour_op), 
+            firsts));
+  }
+}
+
+/**
+\brief Applies a stencil to a sequence with a fixed neighbourhood.
+*/
+template <typename ... InputIterators, typename OutputIt, 
+          typename StencilTransformer, typename Neighbourhood>
+void stencil_sequence(std::tuple<InputIterators...> firsts, 
+                      OutputIt first_out, std::size_t size,
+                      StencilTransformer && transform_op, 
+                      Neighbourhood && neighbour_op, std::true_type)
+{
+  neighbour_op.apply(firsts, first_out, size, 
+      std::forward<StencilTransformer>(transform_op));
+}
+
+} // namespace internal
+
+}
+
+#endif
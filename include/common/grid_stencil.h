@@ -0,0 +1,518 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_COMMON_GRID_STENCIL_H
+#define GRPPI_COMMON_GRID_STENCIL_H
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+#include <vector>
+
+namespace grppi {
+
+/**
+\brief Policy for accessing neighbours outside a grid.
+*/
+enum class boundary_mode {
+  /// Positions are clamped to the nearest element of the grid.
+  clamp,
+  /// Positions wrap around the grid.
+  periodic,
+  /// Neighbours outside the grid take a value-initialized value.
+  constant
+};
+
+/**
+\brief Shape of a multi-dimensional grid used by the stencil pattern.
+Grids are stored in row-major order, so that the last dimension is 
+contiguous in memory.
+\tparam D Number of dimensions.
+*/
+template <std::size_t D>
+struct grid_shape {
+  /// Number of elements in every dimension.
+  std::array<std::size_t,D> extents;
+  /// Maximum distance, in every dimension, to the accessed neighbours.
+  std::size_t halo = 1;
+  /// Policy for neighbours outside the grid.
+  boundary_mode boundary = boundary_mode::clamp;
+  /// Number of elements of a tile in every dimension (0 for a default size).
+  std::array<std::size_t,D> tile{};
+  /// Number of time steps computed per tile by iterated stencils (0 for a 
+  /// default depth).
+  std::size_t time_tile = 0;
+
+  /**
+  \brief Total number of elements in the grid.
+  */
+  std::size_t size() const noexcept {
+    std::size_t result = 1;
+    for (auto e : extents) { result *= e; }
+    return result;
+  }
+};
+
+/**
+\brief Neighbourhood of an element of a grid, passed to stencil 
+transformers.
+Neighbours are accessed by their offsets to the element being computed. 
+Elements farther than the halo width from the grid borders are accessed 
+without boundary checks.
+\tparam InputIt Random access iterator to the grid values.
+\tparam D Number of dimensions.
+*/
+template <typename InputIt, std::size_t D>
+class grid_neighbourhood {
+public:
+  using value_type = typename std::iterator_traits<InputIt>::value_type;
+  using position_type = std::array<std::size_t,D>;
+  using offset_type = std::array<std::ptrdiff_t,D>;
+
+  grid_neighbourhood(InputIt first, const grid_shape<D> & shape) noexcept;
+
+  /**
+  \brief Position of the element being computed.
+  */
+  const position_type & position() const noexcept { return position_; }
+
+  /**
+  \brief Value of the element being computed.
+  */
+  value_type center() const { return first_[index_]; }
+
+  /**
+  \brief Value of a neighbour.
+  \param offsets Offsets of the neighbour in every dimension.
+  \pre The absolute value of every offset is not greater than the halo width.
+  */
+  template <typename ... Offsets>
+  value_type operator()(Offsets ... offsets) const {
+    static_assert(sizeof...(Offsets) == D, 
+        "One offset per dimension is required");
+    return at(offset_type{{static_cast<std::ptrdiff_t>(offsets)...}});
+  }
+
+  /**
+  \brief Value of a neighbour.
+  \param offset Offsets of the neighbour in every dimension.
+  \pre The absolute value of every offset is not greater than the halo width.
+  */
+  value_type at(const offset_type & offset) const;
+
+  /**
+  \brief Moves the neighbourhood to another element.
+  \param position Position of the element.
+  \param index Index of the element in the row-major sequence.
+  */
+  void move_to(const position_type & position, std::size_t index) noexcept {
+    move_to(position, position, index);
+  }
+
+  /**
+  \brief Moves the neighbourhood to an element of a grid stored as a block 
+  of a larger grid.
+  \param position Position of the element in the larger grid.
+  \param local Position of the element in the stored block.
+  \param index Index of the element in the row-major sequence of the block.
+  */
+  void move_to(const position_type & position, const position_type & local,
+               std::size_t index) noexcept;
+
+private:
+  InputIt first_;
+  const grid_shape<D> & shape_;
+  std::array<std::ptrdiff_t,D> strides_;
+  position_type position_{};
+  position_type local_{};
+  std::size_t index_ = 0;
+  bool interior_ = false;
+};
+
+template <typename InputIt, std::size_t D>
+grid_neighbourhood<InputIt,D>::grid_neighbourhood(
+    InputIt first, 
+    const grid_shape<D> & shape) noexcept 
+  :
+    first_{first},
+    shape_{shape}
+{
+  std::ptrdiff_t stride = 1;
+  for (std::size_t d=D; d>0; --d) {
+    strides_[d-1] = stride;
+    stride *= shape.extents[d-1];
+  }
+}
+
+template <typename InputIt, std::size_t D>
+auto grid_neighbourhood<InputIt,D>::at(const offset_type & offset) const
+  -> value_type
+{
+  std::ptrdiff_t index = 0;
+  if (interior_) {
+    for (std::size_t d=0; d<D; ++d) { index += offset[d] * strides_[d]; }
+    return first_[index_ + index];
+  }
+
+  for (std::size_t d=0; d<D; ++d) {
+    const auto n = static_cast<std::ptrdiff_t>(shape_.extents[d]);
+    auto p = static_cast<std::ptrdiff_t>(local_[d]) + offset[d];
+    if (p < 0 || p >= n) {
+      switch (shape_.boundary) {
+        case boundary_mode::clamp:
+          p = (p < 0) ? 0 : n-1;
+          break;
+        case boundary_mode::periodic:
+          p = ((p % n) + n) % n;
+          break;
+        case boundary_mode::constant:
+          return value_type{};
+      }
+    }
+    index += p * strides_[d];
+  }
+  return first_[index];
+}
+
+template <typename InputIt, std::size_t D>
+void grid_neighbourhood<InputIt,D>::move_to(
+    const position_type & position, 
+    const position_type & local,
+    std::size_t index) noexcept
+{
+  position_ = position;
+  local_ = local;
+  index_ = index;
+  interior_ = true;
+  for (std::size_t d=0; d<D; ++d) {
+    interior_ = interior_ && local[d] >= shape_.halo && 
+        local[d] + shape_.halo < shape_.extents[d];
+  }
+}
+
+/**
+\brief Partition of a multi-dimensional grid in tiles.
+Tiles are small blocks of the grid whose neighbourhoods fit in the cache, 
+so that values loaded for an element are reused by the next ones.
+\tparam D Number of dimensions.
+*/
+template <std::size_t D>
+class grid_tiling {
+public:
+  using position_type = std::array<std::size_t,D>;
+
+  explicit grid_tiling(const grid_shape<D> & shape) noexcept;
+
+  /**
+  \brief Number of tiles in the grid.
+  */
+  std::size_t num_tiles() const noexcept { return num_tiles_; }
+
+  /**
+  \brief Number of time steps computed per tile by iterated stencils.
+  */
+  std::size_t time_tile() const noexcept { return time_tile_; }
+
+  /**
+  \brief Gets the bounds of a tile.
+  \param tile Index of the tile.
+  \param lower Position of the first element of the tile.
+  \param upper Position one past the last element of the tile in every 
+  dimension.
+  */
+  void tile_bounds(std::size_t tile, 
+                   position_type & lower, position_type & upper) const noexcept;
+
+  /**
+  \brief Applies an operation to every element of a tile in row-major order.
+  \param tile Index of the tile.
+  \param op Callable invoked with the position of every element and its index
+  in the row-major sequence.
+  */
+  template <typename Operation>
+  void for_each_element(std::size_t tile, Operation && op) const;
+
+private:
+  position_type extents_;
+  position_type tile_;
+  position_type tiles_per_dim_;
+  std::size_t num_tiles_ = 1;
+  std::size_t time_tile_ = 1;
+};
+
+template <std::size_t D>
+grid_tiling<D>::grid_tiling(const grid_shape<D> & shape) noexcept :
+  extents_{shape.extents}
+{
+  // By default, tiles keep long contiguous rows and a few elements in the 
+  // other dimensions.
+  constexpr std::size_t default_row = 256;
+  constexpr std::size_t default_other = (D <= 2) ? 32 : 8;
+  for (std::size_t d=0; d<D; ++d) {
+    auto size = shape.tile[d];
+    if (size == 0) size = (d == D-1) ? default_row : default_other;
+    tile_[d] = std::max<std::size_t>(1, std::min(size, extents_[d]));
+    tiles_per_dim_[d] = (extents_[d] + tile_[d] - 1) / tile_[d];
+    num_tiles_ *= tiles_per_dim_[d];
+  }
+
+  // By default, the halo added in every time step is kept small compared to
+  // the tile, as it is computed redundantly by neighbouring tiles.
+  constexpr std::size_t max_time_tile = 8;
+  time_tile_ = shape.time_tile;
+  if (time_tile_ == 0) {
+    time_tile_ = max_time_tile;
+    if (shape.halo > 0) {
+      for (std::size_t d=0; d<D; ++d) {
+        time_tile_ = std::min(time_tile_, tile_[d] / (4 * shape.halo));
+      }
+    }
+    time_tile_ = std::max<std::size_t>(1, time_tile_);
+  }
+}
+
+template <std::size_t D>
+void grid_tiling<D>::tile_bounds(std::size_t tile, 
+    position_type & lower, position_type & upper) const noexcept
+{
+  for (std::size_t d=D; d>0; --d) {
+    const auto t = tile % tiles_per_dim_[d-1];
+    tile /= tiles_per_dim_[d-1];
+    lower[d-1] = t * tile_[d-1];
+    upper[d-1] = std::min(lower[d-1] + tile_[d-1], extents_[d-1]);
+  }
+}
+
+template <std::size_t D>
+template <typename Operation>
+void grid_tiling<D>::for_each_element(std::size_t tile, Operation && op) const
+{
+  position_type lower, upper;
+  tile_bounds(tile, lower, upper);
+  if (lower[0] >= upper[0]) return;
+
+  // Odometer on the outer dimensions, contiguous loop on the last one
+  auto position = lower;
+  for (;;) {
+    position[D-1] = lower[D-1];
+    std::size_t index = 0;
+    for (std::size_t d=0; d<D; ++d) { index = index * extents_[d] + position[d]; }
+    for (; position[D-1] < upper[D-1]; ++position[D-1]) {
+      op(position, index++);
+    }
+
+    std::size_t d = D-1;
+    while (d > 0) {
+      --d;
+      if (++position[d] < upper[d]) break;
+      position[d] = lower[d];
+      if (d == 0) return;
+    }
+    if (D == 1) return;
+  }
+}
+
+namespace internal {
+
+/**
+\brief Applies an operation to every row of a block of a grid in row-major 
+order.
+\param lower Position of the first element of the block.
+\param upper Position one past the last element of the block in every 
+dimension.
+\param op Callable invoked with the position of the first element of every 
+row.
+*/
+template <std::size_t D, typename Operation>
+void for_each_row(const std::array<std::ptrdiff_t,D> & lower,
+                  const std::array<std::ptrdiff_t,D> & upper,
+                  Operation && op)
+{
+  for (std::size_t d=0; d<D; ++d) { 
+    if (lower[d] >= upper[d]) return; 
+  }
+  auto position = lower;
+  for (;;) {
+    op(position);
+    std::size_t d = D-1;
+    for (;;) {
+      if (d == 0) return;
+      --d;
+      if (++position[d] < upper[d]) break;
+      position[d] = lower[d];
+    }
+  }
+}
+
+/**
+\brief Applies several time steps of a stencil transformation to a range of 
+tiles (temporal blocking).
+Every tile is loaded in a local block together with the halo needed by all 
+the steps. The region computed at every step shrinks by the halo width, so 
+that the last step produces exactly the tile. Halo elements are computed 
+redundantly by neighbouring tiles, which therefore do not synchronize 
+between steps.
+*/
+template <typename InputIt, typename OutputIt, std::size_t D, 
+          typename StencilTransformer>
+void grid_stencil_tiles_temporal(const grid_shape<D> & shape, 
+                                 const grid_tiling<D> & tiling,
+                                 InputIt first, OutputIt first_out,
+                                 std::size_t num_steps,
+                                 StencilTransformer && transform_op,
+                                 std::size_t first_tile, std::size_t last_tile)
+{
+  using value_type = typename std::iterator_traits<InputIt>::value_type;
+  using buffer_type = std::vector<value_type>;
+  using position_type = std::array<std::size_t,D>;
+  using offset_type = std::array<std::ptrdiff_t,D>;
+
+  const bool periodic = shape.boundary == boundary_mode::periodic;
+  const auto halo = static_cast<std::ptrdiff_t>(shape.halo);
+
+  // Region of the grid around a tile, clipped to the grid unless it wraps
+  auto region = [&](const position_type & lower, const position_type & upper,
+                    std::ptrdiff_t width, offset_type & lo, offset_type & hi) {
+    for (std::size_t d=0; d<D; ++d) {
+      const auto n = static_cast<std::ptrdiff_t>(shape.extents[d]);
+      lo[d] = static_cast<std::ptrdiff_t>(lower[d]) - width;
+      hi[d] = static_cast<std::ptrdiff_t>(upper[d]) + width;
+      if (!periodic) {
+        lo[d] = std::max<std::ptrdiff_t>(lo[d], 0);
+        hi[d] = std::min(hi[d], n);
+      }
+    }
+  };
+  auto wrap = [&](std::ptrdiff_t p, std::size_t d) -> std::size_t {
+    if (!periodic) return p;
+    const auto n = static_cast<std::ptrdiff_t>(shape.extents[d]);
+    return ((p % n) + n) % n;
+  };
+
+  // The block contains the whole halo of a periodic grid, so that it is 
+  // never accessed beyond its bounds.
+  grid_shape<D> block;
+  block.halo = shape.halo;
+  block.boundary = periodic ? boundary_mode::clamp : shape.boundary;
+
+  buffer_type current, next;
+  position_type lower, upper, position, local;
+  offset_type block_lower, block_upper, lo, hi;
+  for (auto t=first_tile; t<last_tile; ++t) {
+    tiling.tile_bounds(t, lower, upper);
+    region(lower, upper, halo * num_steps, block_lower, block_upper);
+    std::size_t block_size = 1;
+    for (std::size_t d=0; d<D; ++d) {
+      block.extents[d] = block_upper[d] - block_lower[d];
+      block_size *= block.extents[d];
+    }
+    current.resize(block_size);
+    next.resize(block_size);
+
+    std::size_t index = 0;
+    for_each_row(block_lower, block_upper, [&](const offset_type & row) {
+      std::size_t offset = 0;
+      for (std::size_t d=0; d<D-1; ++d) {
+        offset = (offset + wrap(row[d], d)) * shape.extents[d+1];
+      }
+      for (auto p=row[D-1]; p<block_upper[D-1]; ++p) {
+        current[index++] = first[offset + wrap(p, D-1)];
+      }
+    });
+
+    for (std::size_t step=1; step<=num_steps; ++step) {
+      region(lower, upper, halo * (num_steps - step), lo, hi);
+      grid_neighbourhood<typename buffer_type::const_iterator, D> 
+          neighbourhood{current.cbegin(), block};
+      for_each_row(lo, hi, [&](const offset_type & row) {
+        std::size_t index = 0;
+        for (std::size_t d=0; d<D; ++d) {
+          position[d] = wrap(row[d], d);
+          local[d] = row[d] - block_lower[d];
+          index = index * block.extents[d] + local[d];
+        }
+        for (auto p=row[D-1]; p<hi[D-1]; ++p, ++index) {
+          position[D-1] = wrap(p, D-1);
+          local[D-1] = p - block_lower[D-1];
+          neighbourhood.move_to(position, local, index);
+          next[index] = transform_op(neighbourhood);
+        }
+      });
+      std::swap(current, next);
+    }
+
+    region(lower, upper, 0, lo, hi);
+    for_each_row(lo, hi, [&](const offset_type & row) {
+      std::size_t offset = 0, index = 0;
+      for (std::size_t d=0; d<D-1; ++d) {
+        offset = (offset + row[d]) * shape.extents[d+1];
+        index = (index + row[d] - block_lower[d]) * block.extents[d+1];
+      }
+      index += row[D-1] - block_lower[D-1];
+      for (auto p=row[D-1]; p<hi[D-1]; ++p) {
+        first_out[offset + p] = current[index++];
+      }
+    });
+  }
+}
+
+}
+
+/**
+\brief Applies a stencil transformation to the elements of a range of tiles.
+\param shape Shape of the grid.
+\param tiling Partition of the grid in tiles.
+\param first Iterator to the first element of the input grid.
+\param first_out Iterator to the first element of the output grid.
+\param num_steps Number of time steps computed per tile. When greater than 
+one, each tile is computed on a local copy extended by the halo of all the 
+steps.
+\param transform_op Stencil transformation invoked with a grid_neighbourhood.
+\param first_tile Index of the first tile.
+\param last_tile Index of one past the last tile.
+*/
+template <typename InputIt, typename OutputIt, std::size_t D, 
+          typename StencilTransformer>
+void grid_stencil_tiles(const grid_shape<D> & shape, 
+                        const grid_tiling<D> & tiling,
+                        InputIt first, OutputIt first_out,
+                        std::size_t num_steps,
+                        StencilTransformer && transform_op,
+                        std::size_t first_tile, std::size_t last_tile)
+{
+  if (num_steps > 1) {
+    internal::grid_stencil_tiles_temporal(shape, tiling, first, first_out,
+        num_steps, transform_op, first_tile, last_tile);
+    return;
+  }
+
+  grid_neighbourhood<InputIt,D> neighbourhood{first, shape};
+  for (auto t=first_tile; t<last_tile; ++t) {
+    tiling.for_each_element(t, [&](const auto & position, std::size_t index) {
+      neighbourhood.move_to(position, index);
+      first_out[index] = transform_op(neighbourhood);
+    });
+  }
+}
+
+}
+
+#endif
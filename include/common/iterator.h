@@ -156,7 +156,7 @@ namespace internal {
 
 template <typename T, std::size_t ... I>
 auto iterators_next_impl(T && t, int n, std::index_sequence<I...>) {
-  return make_tuple(
+  return std::make_tuple(
     std::next(std::get<I>(t), n)...
   );
 }
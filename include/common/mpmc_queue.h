@@ -25,6 +25,7 @@
 #include <vector>
 #include <atomic>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 
@@ -34,6 +35,20 @@ namespace grppi{
 
 enum class queue_mode {lockfree = true, blocking = false};
 
+/**
+\brief Bounded multiple-producer/multiple-consumer queue.
+
+In blocking mode the queue is protected by a mutex and threads wait on
+condition variables when the queue is full or empty.
+
+In lock-free mode the queue follows the bounded MPMC design by D. Vyukov. 
+Every cell in the ring buffer carries a sequence number that tells whether 
+the cell is ready to be written or read for a given position. A producer 
+(or consumer) only needs a single CAS on the shared tail (or head) position 
+and never waits for other producers (or consumers) to commit their 
+operations. Threads finding the queue full (or empty) spin for a bounded 
+number of attempts and then park on a condition variable.
+*/
 template <typename T>
 class mpmc_queue{
 
@@ -41,16 +56,18 @@ class mpmc_queue{
       using value_type = T;
 
       mpmc_queue<T>(int q_size, queue_mode q_mode ):
-           size{q_size}, buffer{std::vector<T>(q_size)}, mode{q_mode}, pread{0}, pwrite{0}, internal_pread{0}, internal_pwrite{0} { }
+           size{q_size}, cells{new cell[q_size]}, mode{q_mode}, 
+           pread{0}, pwrite{0}
+      { 
+        for (int i=0; i<size; ++i) cells[i].sequence.store(i);
+      }
       
       mpmc_queue(mpmc_queue && q) :
         size{q.size},
-        buffer{std::move(q.buffer)},
+        cells{std::move(q.cells)},
         mode{q.mode},
         pread{q.pread.load()},
         pwrite{q.pwrite.load()},
-        internal_pread{q.internal_pread.load()},
-        internal_pwrite{q.internal_pwrite.load()},
         m{},
         empty{},
         full{}
@@ -63,19 +80,61 @@ class mpmc_queue{
       T pop () ;
       bool push (T item) ;
 
+      /**
+      \brief Pushes a sequence of items moving them into the queue.
+      In blocking mode, all the items fitting in the queue are inserted under
+      a single lock acquisition.
+      */
+      template <typename InputIt>
+      void push_bulk(InputIt first, InputIt last);
+
+      /**
+      \brief Pops up to max_items items, waiting only if the queue is empty.
+      \return The number of items written to out (at least one).
+      */
+      template <typename OutputIt>
+      int pop_bulk(OutputIt out, int max_items);
+
+      /**
+      \brief Pops up to max_items items without waiting.
+      \return The number of items written to out (may be zero).
+      */
+      template <typename OutputIt>
+      int try_pop_bulk(OutputIt out, int max_items);
+
    private:
       bool is_full (unsigned long long current) const noexcept;
       bool is_empty (unsigned long long current) const noexcept;
 
+      bool try_push_lockfree(T & item);
+      bool try_pop_lockfree(T & item);
+      bool ready_to_push() const noexcept;
+      bool ready_to_pop() const noexcept;
+      void wake_producers();
+      void wake_consumers();
+
+      /// Number of attempts before a lock-free operation parks the thread.
+      constexpr static int max_spins = 1024;
+
+      struct cell {
+        std::atomic<unsigned long long> sequence;
+        T value;
+      };
+
       int size;
-      std::vector<T> buffer;
+      std::unique_ptr<cell[]> cells;
       queue_mode mode;
 
+      // Positions are kept in different cache lines to avoid false sharing
+      // between producers and consumers.
+      char pad0[64];
       std::atomic<unsigned long long> pread;
+      char pad1[64];
       std::atomic<unsigned long long> pwrite;
-      std::atomic<unsigned long long> internal_pread;
-      std::atomic<unsigned long long> internal_pwrite;
+      char pad2[64];
 
+      std::atomic<int> waiting_producers{0};
+      std::atomic<int> waiting_consumers{0};
 
       std::mutex m;
       std::condition_variable empty;
@@ -92,21 +151,15 @@ bool mpmc_queue<T>::is_empty() const noexcept {
 template <typename T>
 T mpmc_queue<T>::pop(){
   if(mode == queue_mode::lockfree){
-    
-     unsigned long long current;
-
-     do{
-        current = internal_pread.load();
-     }while(!internal_pread.compare_exchange_weak(current, current+1));
-          
-     while(is_empty(current));
-
-     auto item = std::move(buffer[current%size]); 
-     auto aux = current;
-     do{
-        current = aux;
-     }while(!pread.compare_exchange_weak(current, current+1));
-     
+     T item;
+     for (int spins=0; !try_pop_lockfree(item); ++spins) {
+       if (spins < max_spins) continue;
+       std::unique_lock<std::mutex> lk(m);
+       waiting_consumers++;
+       empty.wait(lk, [this]{ return ready_to_pop(); });
+       waiting_consumers--;
+     }
+     wake_producers();
      return std::move(item);
   }else{
      
@@ -114,7 +167,7 @@ T mpmc_queue<T>::pop(){
      while(is_empty(pread)){
         empty.wait(lk);
      }  
-     auto item = std::move(buffer[pread%size]);
+     auto item = std::move(cells[pread%size].value);
      pread++;    
      lk.unlock();
      full.notify_one();
@@ -127,20 +180,14 @@ T mpmc_queue<T>::pop(){
 template <typename T>
 bool mpmc_queue<T>::push(T item){
   if(mode == queue_mode::lockfree){
-     unsigned long long current;
-     do{
-         current = internal_pwrite.load();
-     }while(!internal_pwrite.compare_exchange_weak(current, current+1));
-
-     while(is_full(current));
-
-     buffer[current%size] = std::move(item);
-  
-     auto aux = current;
-     do{
-        current = aux;
-     }while(!pwrite.compare_exchange_weak(current, current+1));
-
+     for (int spins=0; !try_push_lockfree(item); ++spins) {
+       if (spins < max_spins) continue;
+       std::unique_lock<std::mutex> lk(m);
+       waiting_producers++;
+       full.wait(lk, [this]{ return ready_to_push(); });
+       waiting_producers--;
+     }
+     wake_consumers();
      return true;
   }else{
 
@@ -148,7 +195,7 @@ bool mpmc_queue<T>::push(T item){
     while(is_full(pwrite)){
         full.wait(lk);
     }
-    buffer[pwrite%size] = std::move(item);
+    cells[pwrite%size].value = std::move(item);
 
     pwrite++;
     lk.unlock();
@@ -158,6 +205,159 @@ bool mpmc_queue<T>::push(T item){
   }
 }
 
+template <typename T>
+template <typename InputIt>
+void mpmc_queue<T>::push_bulk(InputIt first, InputIt last){
+  if(mode == queue_mode::lockfree){
+     for (; first!=last; ++first) push(std::move(*first));
+     return;
+  }
+
+  while (first!=last) {
+    std::unique_lock<std::mutex> lk(m);
+    while(is_full(pwrite)){
+        full.wait(lk);
+    }
+    const auto limit = pread.load() + size;
+    auto current = pwrite.load();
+    for (; first!=last && current<limit; ++first, ++current) {
+      cells[current%size].value = std::move(*first);
+    }
+    pwrite = current;
+    lk.unlock();
+    empty.notify_all();
+  }
+}
+
+template <typename T>
+template <typename OutputIt>
+int mpmc_queue<T>::pop_bulk(OutputIt out, int max_items){
+  if(mode == queue_mode::lockfree){
+     *out++ = pop();
+     return 1 + try_pop_bulk(out, max_items-1);
+  }
+
+  std::unique_lock<std::mutex> lk(m);
+  while(is_empty(pread)){
+     empty.wait(lk);
+  }
+  int n = 0;
+  auto current = pread.load();
+  const auto last = pwrite.load();
+  for (; n<max_items && current<last; ++n, ++current) {
+    *out++ = std::move(cells[current%size].value);
+  }
+  pread = current;
+  lk.unlock();
+  full.notify_all();
+  return n;
+}
+
+template <typename T>
+template <typename OutputIt>
+int mpmc_queue<T>::try_pop_bulk(OutputIt out, int max_items){
+  int n = 0;
+  if(mode == queue_mode::lockfree){
+     T item;
+     for (; n<max_items && try_pop_lockfree(item); ++n) {
+       *out++ = std::move(item);
+     }
+     if (n>0) wake_producers();
+     return n;
+  }
+
+  std::unique_lock<std::mutex> lk(m);
+  auto current = pread.load();
+  const auto last = pwrite.load();
+  for (; n<max_items && current<last; ++n, ++current) {
+    *out++ = std::move(cells[current%size].value);
+  }
+  pread = current;
+  lk.unlock();
+  if (n>0) full.notify_all();
+  return n;
+}
+
+template <typename T>
+void mpmc_queue<T>::wake_producers() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiting_producers.load() > 0) {
+    std::lock_guard<std::mutex> lk(m);
+    full.notify_all();
+  }
+}
+
+template <typename T>
+void mpmc_queue<T>::wake_consumers() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiting_consumers.load() > 0) {
+    std::lock_guard<std::mutex> lk(m);
+    empty.notify_all();
+  }
+}
+
+template <typename T>
+bool mpmc_queue<T>::try_push_lockfree(T & item) {
+  auto current = pwrite.load(std::memory_order_relaxed);
+  for (;;) {
+    auto & c = cells[current%size];
+    const auto seq = c.sequence.load(std::memory_order_acquire);
+    const auto dif = static_cast<long long>(seq - current);
+    if (dif == 0) {
+      if (pwrite.compare_exchange_weak(current, current+1, 
+          std::memory_order_relaxed)) 
+      {
+        c.value = std::move(item);
+        c.sequence.store(current+1, std::memory_order_release);
+        return true;
+      }
+    }
+    else if (dif < 0) {
+      return false; // Full
+    }
+    else {
+      current = pwrite.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <typename T>
+bool mpmc_queue<T>::try_pop_lockfree(T & item) {
+  auto current = pread.load(std::memory_order_relaxed);
+  for (;;) {
+    auto & c = cells[current%size];
+    const auto seq = c.sequence.load(std::memory_order_acquire);
+    const auto dif = static_cast<long long>(seq - (current+1));
+    if (dif == 0) {
+      if (pread.compare_exchange_weak(current, current+1,
+          std::memory_order_relaxed))
+      {
+        item = std::move(c.value);
+        c.sequence.store(current+size, std::memory_order_release);
+        return true;
+      }
+    }
+    else if (dif < 0) {
+      return false; // Empty
+    }
+    else {
+      current = pread.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <typename T>
+bool mpmc_queue<T>::ready_to_push() const noexcept {
+  const auto current = pwrite.load();
+  return cells[current%size].sequence.load() == current;
+}
+
+template <typename T>
+bool mpmc_queue<T>::ready_to_pop() const noexcept {
+  const auto current = pread.load();
+  return cells[current%size].sequence.load() == current+1;
+}
+
 template <typename T>
 bool mpmc_queue<T>::is_empty(unsigned long long current) const noexcept {
   if(current >= pwrite.load()) return true;
@@ -84,6 +84,36 @@ constexpr bool is_no_pattern =
 template <typename T>
 using requires_no_pattern = std::enable_if_t<is_no_pattern<T>,int>;
 
+namespace internal {
+
+template <typename ... Stages>
+struct has_single_consumer : std::false_type {};
+
+template <typename Stage, typename ... Stages>
+struct has_single_consumer<Stage, Stages...> : 
+  std::integral_constant<bool, 
+    grppi::is_no_pattern<Stage> || grppi::is_filter<Stage> || 
+    grppi::is_reduce<Stage>>
+{};
+
+template <typename ... Transformers, typename ... Stages>
+struct has_single_consumer<pipeline_t<Transformers...>, Stages...> :
+  has_single_consumer<std::decay_t<Transformers>...> 
+{};
+
+} // end namespace internal
+
+/**
+\brief Determines if the first of a sequence of stages consumes its input 
+stream from a single thread.
+Farms and iterations have several threads reading from (or writing back to) 
+their input stream, while transformers, consumers, filters and reductions 
+read it from a single thread. A nested pipeline behaves as its first stage.
+*/
+template <typename ... Stages>
+constexpr bool has_single_consumer = 
+  internal::has_single_consumer<std::decay_t<Stages>...>();
+
 } // end namespace grppi
 
 #endif
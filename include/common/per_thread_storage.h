@@ -0,0 +1,215 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_COMMON_PER_THREAD_STORAGE_H
+#define GRPPI_COMMON_PER_THREAD_STORAGE_H
+
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <new>
+
+#include "cache_aligned.h"
+
+namespace grppi {
+
+/**
+\brief Scratch storage with one lazily created instance per thread.
+
+Instances are indexed by the thread index of an execution policy, so that 
+threads which get the same index at different times (e.g. workers of a 
+relaunched pool) reuse the same instance. An instance is created by the 
+initializer the first time its thread calls local(), and it is kept until
+the storage is destroyed. Every instance is kept in its own cache lines.
+
+Slots are kept in segments of growing size which are never reallocated. 
+Consequently, looking up the instance of a thread never blocks.
+
+\tparam T Type of the per thread instances.
+\tparam IndexFunction Callable object type returning the index of the calling
+thread.
+\pre The index function never returns the same index to two threads running
+concurrently.
+*/
+template <typename T, typename IndexFunction>
+class per_thread_storage {
+public:
+  using value_type = T;
+
+  /**
+  \brief Creates an empty storage.
+  \param init_op Callable object returning the initial value of an instance.
+  \param index_op Callable object returning the index of the calling thread.
+  \param size_hint Expected number of threads.
+  */
+  per_thread_storage(std::function<T()> init_op, IndexFunction index_op,
+                     int size_hint = 1);
+
+  per_thread_storage(per_thread_storage &&) noexcept = default;
+  per_thread_storage & operator=(per_thread_storage &&) = delete;
+
+  ~per_thread_storage();
+
+  /**
+  \brief Get the instance of the calling thread, creating it if needed.
+  */
+  T & local();
+
+  /**
+  \brief Applies an operation to every instance created so far.
+  \pre No thread is calling local() concurrently.
+  */
+  template <typename F>
+  void for_each(F && f);
+
+  /**
+  \brief Get the number of instances created so far.
+  \pre No thread is calling local() concurrently.
+  */
+  int size() const noexcept;
+
+private:
+  using slot_type = std::atomic<cache_aligned<T>*>;
+
+  // Segment s holds first_size_<<s slots
+  constexpr static int max_segments = 24;
+
+  slot_type & slot(int index);
+
+private:
+  std::function<T()> init_op_;
+  IndexFunction index_op_;
+  int first_size_;
+  std::unique_ptr<std::atomic<slot_type*>[]> segments_;
+};
+
+template <typename T, typename IndexFunction>
+per_thread_storage<T,IndexFunction>::per_thread_storage(
+    std::function<T()> init_op, IndexFunction index_op, int size_hint)
+  :
+  init_op_{std::move(init_op)},
+  index_op_{std::move(index_op)},
+  first_size_{1},
+  segments_{new std::atomic<slot_type*>[max_segments]}
+{
+  while (first_size_ < size_hint) { first_size_ *= 2; }
+  for (int s=0; s<max_segments; ++s) { segments_[s] = nullptr; }
+}
+
+template <typename T, typename IndexFunction>
+per_thread_storage<T,IndexFunction>::~per_thread_storage()
+{
+  if (!segments_) return; // Moved from
+  cache_aligned_allocator<cache_aligned<T>> allocator;
+  for (int s=0; s<max_segments; ++s) {
+    auto * segment = segments_[s].load();
+    if (!segment) continue;
+    const int size = first_size_ << s;
+    for (int i=0; i<size; ++i) {
+      auto * instance = segment[i].load();
+      if (!instance) continue;
+      instance->~cache_aligned<T>();
+      allocator.deallocate(instance, 1);
+    }
+    delete [] segment;
+  }
+}
+
+template <typename T, typename IndexFunction>
+T & per_thread_storage<T,IndexFunction>::local()
+{
+  auto & current = slot(index_op_());
+  auto * instance = current.load(std::memory_order_acquire);
+  if (!instance) {
+    cache_aligned_allocator<cache_aligned<T>> allocator;
+    instance = allocator.allocate(1);
+    try {
+      new (instance) cache_aligned<T>{init_op_()};
+    }
+    catch (...) {
+      allocator.deallocate(instance, 1);
+      throw;
+    }
+    current.store(instance, std::memory_order_release);
+  }
+  return instance->value;
+}
+
+template <typename T, typename IndexFunction>
+template <typename F>
+void per_thread_storage<T,IndexFunction>::for_each(F && f)
+{
+  for (int s=0; s<max_segments; ++s) {
+    auto * segment = segments_[s].load(std::memory_order_acquire);
+    if (!segment) continue;
+    const int size = first_size_ << s;
+    for (int i=0; i<size; ++i) {
+      auto * instance = segment[i].load(std::memory_order_acquire);
+      if (instance) f(instance->value);
+    }
+  }
+}
+
+template <typename T, typename IndexFunction>
+int per_thread_storage<T,IndexFunction>::size() const noexcept
+{
+  int result = 0;
+  for (int s=0; s<max_segments; ++s) {
+    auto * segment = segments_[s].load(std::memory_order_acquire);
+    if (!segment) continue;
+    const int size = first_size_ << s;
+    for (int i=0; i<size; ++i) {
+      if (segment[i].load(std::memory_order_acquire)) result++;
+    }
+  }
+  return result;
+}
+
+template <typename T, typename IndexFunction>
+typename per_thread_storage<T,IndexFunction>::slot_type & 
+per_thread_storage<T,IndexFunction>::slot(int index)
+{
+  // Segment s starts at first_size_ * (2^s - 1)
+  int s = 0;
+  int offset = index;
+  while (offset >= (first_size_ << s)) {
+    offset -= first_size_ << s;
+    s++;
+  }
+
+  auto * segment = segments_[s].load(std::memory_order_acquire);
+  if (!segment) {
+    const int size = first_size_ << s;
+    auto * created = new slot_type[size];
+    for (int i=0; i<size; ++i) { created[i] = nullptr; }
+    if (segments_[s].compare_exchange_strong(segment, created,
+        std::memory_order_acq_rel, std::memory_order_acquire)) {
+      segment = created;
+    }
+    else {
+      delete [] created; // Another thread installed the segment
+    }
+  }
+  return segment[offset];
+}
+
+}
+
+#endif
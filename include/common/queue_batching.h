@@ -0,0 +1,154 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_COMMON_QUEUE_BATCHING_H
+#define GRPPI_COMMON_QUEUE_BATCHING_H
+
+#include <vector>
+#include <iterator>
+#include <type_traits>
+
+namespace grppi {
+
+/**
+\brief Buffered writer transferring items to a queue in batches.
+Items are accumulated locally and pushed to the queue with a single bulk 
+operation when the batch is complete or when flush() is called.
+\tparam Queue Type of the target queue.
+\note With a batch size of 1 every item is directly pushed to the queue.
+*/
+template <typename Queue>
+class queue_writer {
+public:
+  using value_type = typename Queue::value_type;
+
+  queue_writer(Queue & queue, int batch_size) :
+    queue_{queue}, batch_size_{batch_size}
+  {
+    if (batch_size_ > 1) buffer_.reserve(batch_size_);
+  }
+
+  /**
+  \brief Adds an item to the current batch.
+  */
+  void push(value_type item) {
+    if (batch_size_ <= 1) {
+      queue_.push(std::move(item));
+      return;
+    }
+    buffer_.push_back(std::move(item));
+    if (static_cast<int>(buffer_.size()) >= batch_size_) flush();
+  }
+
+  /**
+  \brief Pushes the items in the current batch to the queue.
+  */
+  void flush() {
+    if (buffer_.empty()) return;
+    queue_.push_bulk(std::make_move_iterator(buffer_.begin()), 
+        std::make_move_iterator(buffer_.end()));
+    buffer_.clear();
+  }
+
+  /**
+  \brief Determines if there are items not yet pushed to the queue.
+  */
+  bool pending() const noexcept { return !buffer_.empty(); }
+
+private:
+  Queue & queue_;
+  int batch_size_;
+  std::vector<value_type> buffer_;
+};
+
+/**
+\brief Buffered reader getting items from a queue in batches.
+Every access to the queue takes all the available items up to the batch size.
+\tparam Queue Type of the source queue.
+\note With a batch size of 1 every item is directly popped from the queue.
+*/
+template <typename Queue>
+class queue_reader {
+public:
+  using value_type = typename Queue::value_type;
+
+  queue_reader(Queue & queue, int batch_size) :
+    queue_{queue}, batch_size_{(batch_size > 1) ? batch_size : 1}
+  {
+    if (batch_size_ > 1) buffer_.reserve(batch_size_);
+  }
+
+  /**
+  \brief Gets the next item, waiting for it if needed.
+  */
+  value_type pop() {
+    if (next_ < buffer_.size()) return std::move(buffer_[next_++]);
+    if (batch_size_ == 1) return queue_.pop();
+    buffer_.clear();
+    next_ = 0;
+    queue_.pop_bulk(std::back_inserter(buffer_), batch_size_);
+    return std::move(buffer_[next_++]);
+  }
+
+  /**
+  \brief Gets the next item flushing a writer before waiting for it.
+  A stage must not wait for its input while keeping output items buffered,
+  as the next stage could be waiting for them.
+  */
+  template <typename Writer>
+  value_type pop(Writer & writer) {
+    if (next_ < buffer_.size()) return std::move(buffer_[next_++]);
+    if (writer.pending()) {
+      buffer_.clear();
+      next_ = 0;
+      if (queue_.try_pop_bulk(std::back_inserter(buffer_), batch_size_) > 0) {
+        return std::move(buffer_[next_++]);
+      }
+      writer.flush();
+    }
+    return pop();
+  }
+
+private:
+  Queue & queue_;
+  int batch_size_;
+  std::vector<value_type> buffer_;
+  std::size_t next_ = 0;
+};
+
+/**
+\brief Makes a batched writer for a queue.
+*/
+template <typename Queue>
+queue_writer<std::decay_t<Queue>> make_queue_writer(Queue & queue, int batch_size) {
+  return {queue, batch_size};
+}
+
+/**
+\brief Makes a batched reader for a queue.
+*/
+template <typename Queue>
+queue_reader<std::decay_t<Queue>> make_queue_reader(Queue & queue, int batch_size) {
+  return {queue, batch_size};
+}
+
+}
+
+#endif
@@ -0,0 +1,473 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_COMMON_RANGE_H
+#define GRPPI_COMMON_RANGE_H
+
+#include <iterator>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <tuple>
+#include <cstddef>
+
+namespace grppi {
+
+class sequential_execution;
+
+/**
+\brief A range defined by a pair of iterators and its number of elements.
+\tparam Iterator Iterator type.
+*/
+template <typename Iterator>
+class subrange {
+public:
+
+  /**
+  \brief Constructs a range from its bounds and its size.
+  \pre size == std::distance(first,last)
+  */
+  subrange(Iterator first, Iterator last, std::size_t size) :
+    first_{first}, last_{last}, size_{size}
+  {}
+
+  /**
+  \brief Iterator to the first element.
+  */
+  Iterator begin() const { return first_; }
+
+  /**
+  \brief Iterator to one past the last element.
+  */
+  Iterator end() const { return last_; }
+
+  /**
+  \brief Number of elements in the range.
+  */
+  std::size_t size() const noexcept { return size_; }
+
+private:
+  Iterator first_;
+  Iterator last_;
+  std::size_t size_;
+};
+
+namespace internal {
+
+template <typename T, typename = void>
+struct is_range : std::false_type {};
+
+template <typename T>
+struct is_range<T, decltype(
+    (void)std::begin(std::declval<T&>()), 
+    (void)std::end(std::declval<T&>()))> : std::true_type {};
+
+template <typename T, typename = void>
+struct has_size : std::false_type {};
+
+template <typename T>
+struct has_size<T, decltype((void)std::declval<const T&>().size())> : 
+  std::true_type {};
+
+template <typename T, typename = void>
+struct has_data : std::false_type {};
+
+template <typename T>
+struct has_data<T, std::enable_if_t<std::is_pointer<
+    decltype(std::declval<T&>().data())>::value>> : std::true_type {};
+
+template <typename T>
+using range_iterator_t = decltype(std::begin(std::declval<T&>()));
+
+template <typename Iterator>
+constexpr bool is_random_access_iterator = std::is_base_of<
+    std::random_access_iterator_tag, 
+    typename std::iterator_traits<Iterator>::iterator_category>::value;
+
+template <typename Iterator>
+constexpr bool is_forward_iterator = std::is_base_of<
+    std::forward_iterator_tag, 
+    typename std::iterator_traits<Iterator>::iterator_category>::value;
+
+template <typename T, bool = is_range<T>::value>
+struct is_random_access_range : std::false_type {};
+
+template <typename T>
+struct is_random_access_range<T, true> : std::integral_constant<bool,
+    is_random_access_iterator<range_iterator_t<T>>> {};
+
+} // namespace internal
+
+/**
+\brief Determines if a type is a range (it has std::begin and std::end).
+*/
+template <typename T>
+constexpr bool is_range = internal::is_range<std::remove_reference_t<T>>::value;
+
+template <typename T>
+using requires_range = std::enable_if_t<is_range<T>, int>;
+
+/**
+\brief Determines if a type is a range with random access iterators.
+Random access ranges are split in chunks in constant time.
+*/
+template <typename T>
+constexpr bool is_random_access_range = 
+    internal::is_random_access_range<std::remove_reference_t<T>>::value;
+
+/**
+\brief Determines if a type is a random access range storing its elements
+contiguously (it has a data() member returning a pointer).
+Kernels access contiguous ranges through pointers.
+*/
+template <typename T>
+constexpr bool is_contiguous_range = is_random_access_range<T> && 
+    internal::has_data<std::remove_reference_t<T>>::value;
+
+namespace internal {
+
+template <typename Range>
+auto range_size(const Range & range, std::true_type) {
+  return static_cast<std::size_t>(range.size());
+}
+
+template <typename Range>
+auto range_size(const Range & range, std::false_type) {
+  return static_cast<std::size_t>(
+      std::distance(std::begin(range), std::end(range)));
+}
+
+template <typename Range>
+auto range_first(Range & range, std::true_type) { return range.data(); }
+
+template <typename Range>
+auto range_first(Range & range, std::false_type) { return std::begin(range); }
+
+} // namespace internal
+
+/**
+\brief Number of elements of a range.
+*/
+template <typename Range>
+std::size_t range_size(const Range & range) {
+  return internal::range_size(range, internal::has_size<Range>{});
+}
+
+/**
+\brief Iterator to the first element of a range. For contiguous ranges it is
+a pointer.
+*/
+template <typename Range>
+auto range_first(Range & range) {
+  return internal::range_first(range, 
+      std::integral_constant<bool, is_contiguous_range<Range>>{});
+}
+
+/**
+\brief Splits a range into consecutive parts of similar sizes.
+This is the default implementation of the split customization point. It 
+traverses a non random access range once. A range type may provide its own
+split function, found by argument dependent lookup, returning a random access
+sequence of ranges that together hold all the elements in order.
+\param range Range to be split.
+\param num_parts Maximum number of parts.
+\return A vector of subranges with at least one element each.
+*/
+template <typename Range,
+          requires_range<Range> = 0>
+auto split(const Range & range, std::size_t num_parts)
+{
+  using iterator = internal::range_iterator_t<const Range>;
+  const auto size = range_size(range);
+  const auto parts = std::min(std::max<std::size_t>(num_parts, 1), size);
+
+  std::vector<subrange<iterator>> result;
+  result.reserve(parts);
+  auto first = std::begin(range);
+  for (std::size_t p=0; p<parts; ++p) {
+    const auto part_size = size / parts + ((p < size % parts) ? 1 : 0);
+    auto last = std::next(first, part_size);
+    result.emplace_back(first, last, part_size);
+    first = last;
+  }
+  return result;
+}
+
+namespace internal {
+
+/**
+\brief Number of parts in which non random access ranges are split.
+Parallel policies get a few parts per thread to balance the load.
+*/
+template <typename Execution>
+std::size_t default_num_parts(const Execution & ex) {
+  const int degree = ex.concurrency_degree();
+  return (degree > 1) ? 4 * static_cast<std::size_t>(degree) : 1;
+}
+
+/**
+\brief Invokes the split customization point on a range.
+*/
+template <typename Range>
+auto split_range(const Range & range, std::size_t num_parts) {
+  using grppi::split;
+  return split(range, num_parts);
+}
+
+/**
+\brief Random access iterator over consecutive indices.
+Used as an input sequence without storing the indices.
+*/
+class index_iterator {
+public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const std::size_t *;
+  using reference = std::size_t;
+
+  explicit index_iterator(std::size_t index = 0) noexcept : index_{index} {}
+
+  std::size_t operator*() const noexcept { return index_; }
+  std::size_t operator[](difference_type n) const noexcept { 
+    return index_ + n; 
+  }
+
+  index_iterator & operator++() noexcept { ++index_; return *this; }
+  index_iterator operator++(int) noexcept { return index_iterator{index_++}; }
+  index_iterator & operator--() noexcept { --index_; return *this; }
+  index_iterator operator--(int) noexcept { return index_iterator{index_--}; }
+  index_iterator & operator+=(difference_type n) noexcept { 
+    index_ += n; 
+    return *this; 
+  }
+  index_iterator & operator-=(difference_type n) noexcept { 
+    index_ -= n; 
+    return *this; 
+  }
+
+  friend index_iterator operator+(index_iterator it, difference_type n) noexcept
+  { return it += n; }
+  friend index_iterator operator+(difference_type n, index_iterator it) noexcept
+  { return it += n; }
+  friend index_iterator operator-(index_iterator it, difference_type n) noexcept
+  { return it -= n; }
+  friend difference_type operator-(index_iterator a, index_iterator b) noexcept
+  { return static_cast<difference_type>(a.index_ - b.index_); }
+
+  friend bool operator==(index_iterator a, index_iterator b) noexcept 
+  { return a.index_ == b.index_; }
+  friend bool operator!=(index_iterator a, index_iterator b) noexcept 
+  { return a.index_ != b.index_; }
+  friend bool operator<(index_iterator a, index_iterator b) noexcept 
+  { return a.index_ < b.index_; }
+  friend bool operator>(index_iterator a, index_iterator b) noexcept 
+  { return a.index_ > b.index_; }
+  friend bool operator<=(index_iterator a, index_iterator b) noexcept 
+  { return a.index_ <= b.index_; }
+  friend bool operator>=(index_iterator a, index_iterator b) noexcept 
+  { return a.index_ >= b.index_; }
+
+private:
+  std::size_t index_;
+};
+
+/**
+\brief Output iterator discarding every value assigned through it.
+*/
+struct discard_iterator {
+  // Random access so that advancing takes constant time
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = void;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = void;
+
+  const discard_iterator & operator*() const noexcept { return *this; }
+  template <typename T>
+  const discard_iterator & operator=(T &&) const noexcept { return *this; }
+  discard_iterator & operator++() noexcept { return *this; }
+  discard_iterator operator++(int) noexcept { return *this; }
+  discard_iterator & operator--() noexcept { return *this; }
+  discard_iterator & operator+=(difference_type) noexcept { return *this; }
+};
+
+/**
+\brief Invokes an operation on every index in [0,n) as a map on an 
+execution policy.
+*/
+template <typename Execution, typename Operation>
+void for_each_index(const Execution & ex, std::size_t n, Operation && op)
+{
+  ex.map(std::make_tuple(index_iterator{0}), discard_iterator{}, n,
+      [&op](std::size_t i) { op(i); return char{1}; });
+}
+
+/**
+\brief Invokes an operation on every index in [0,n) in order.
+\note Specialization for sequential_execution.
+*/
+template <typename Operation>
+void for_each_index(const sequential_execution &, std::size_t n, 
+                    Operation && op)
+{
+  for (std::size_t i=0; i<n; ++i) { op(i); }
+}
+
+/**
+\brief Splits the range starting at an iterator in parts with the same sizes
+as the parts of another range.
+*/
+template <typename Iterator, typename Parts>
+auto split_like(Iterator first, const Parts & parts) {
+  std::vector<subrange<Iterator>> result;
+  result.reserve(parts.size());
+  for (const auto & part : parts) {
+    const auto size = grppi::range_size(part);
+    auto last = std::next(first, size);
+    result.emplace_back(first, last, size);
+    first = last;
+  }
+  return result;
+}
+
+/**
+\brief Applies a map to a range with an execution policy.
+Random access ranges are passed directly to the execution policy. Other 
+ranges are split and their parts are processed as the elements of a random
+access sequence, so that chunking takes constant time.
+*/
+template <typename Execution, typename InRange, typename OutputIt,
+          typename Transformer>
+void map_range(const Execution & ex, InRange & in, OutputIt first_out,
+               Transformer && transform_op, std::true_type)
+{
+  ex.map(std::make_tuple(grppi::range_first(in)), first_out, 
+      grppi::range_size(in), std::forward<Transformer>(transform_op));
+}
+
+template <typename Execution, typename InRange, typename OutputIt,
+          typename Transformer>
+void map_range(const Execution & ex, InRange & in, OutputIt first_out,
+               Transformer && transform_op, std::false_type)
+{
+  const auto in_parts = split_range(in, default_num_parts(ex));
+  const auto out_parts = split_like(first_out, in_parts);
+  ex.map(std::make_tuple(std::begin(in_parts), std::begin(out_parts)), 
+      discard_iterator{}, in_parts.size(),
+      [&transform_op](const auto & in_part, const auto & out_part) {
+        auto out_it = std::begin(out_part);
+        for (auto && x : in_part) { *out_it++ = transform_op(x); }
+        return char{1};
+      });
+}
+
+/**
+\brief Applies a map to a non random access range in a single traversal.
+\note Specialization for sequential_execution.
+*/
+template <typename InRange, typename OutputIt, typename Transformer>
+void map_range(const sequential_execution & ex, InRange & in, 
+               OutputIt first_out, Transformer && transform_op, 
+               std::false_type)
+{
+  map_range(ex, in, first_out, std::forward<Transformer>(transform_op), 
+      std::true_type{});
+}
+
+/**
+\brief Applies a map/reduce to a range with an execution policy.
+*/
+template <typename Execution, typename Range, typename Identity,
+          typename Transformer, typename Combiner>
+auto map_reduce_range(const Execution & ex, Range & range, 
+                      Identity && identity, Transformer && transform_op, 
+                      Combiner && combine_op, std::true_type)
+{
+  return ex.map_reduce(std::make_tuple(grppi::range_first(range)), 
+      grppi::range_size(range), 
+      std::forward<Identity>(identity), 
+      std::forward<Transformer>(transform_op), 
+      std::forward<Combiner>(combine_op));
+}
+
+template <typename Execution, typename Range, typename Identity,
+          typename Transformer, typename Combiner>
+auto map_reduce_range(const Execution & ex, Range & range, 
+                      Identity && identity, Transformer && transform_op, 
+                      Combiner && combine_op, std::false_type)
+{
+  using result_type = std::decay_t<Identity>;
+  const result_type init{std::forward<Identity>(identity)};
+  const auto parts = split_range(range, default_num_parts(ex));
+  return ex.map_reduce(std::make_tuple(std::begin(parts)), parts.size(), init,
+      [&](const auto & part) {
+        result_type result{init};
+        for (auto && x : part) { result = combine_op(result, transform_op(x)); }
+        return result;
+      },
+      std::forward<Combiner>(combine_op));
+}
+
+/**
+\brief Applies a map/reduce to a non random access range in a single 
+traversal.
+\note Specialization for sequential_execution.
+*/
+template <typename Range, typename Identity, typename Transformer, 
+          typename Combiner>
+auto map_reduce_range(const sequential_execution & ex, Range & range, 
+                      Identity && identity, Transformer && transform_op, 
+                      Combiner && combine_op, std::false_type)
+{
+  return map_reduce_range(ex, range, std::forward<Identity>(identity),
+      std::forward<Transformer>(transform_op), 
+      std::forward<Combiner>(combine_op), std::true_type{});
+}
+
+/**
+\brief Applies a reduction to a range with an execution policy.
+*/
+template <typename Execution, typename Range, typename Identity,
+          typename Combiner>
+auto reduce_range(const Execution & ex, Range & range, Identity && identity, 
+                  Combiner && combine_op, std::true_type)
+{
+  return ex.reduce(grppi::range_first(range), grppi::range_size(range), 
+      std::forward<Identity>(identity), std::forward<Combiner>(combine_op));
+}
+
+template <typename Execution, typename Range, typename Identity,
+          typename Combiner>
+auto reduce_range(const Execution & ex, Range & range, Identity && identity, 
+                  Combiner && combine_op, std::false_type)
+{
+  return internal::map_reduce_range(ex, range, 
+      std::forward<Identity>(identity),
+      [](const auto & x) { return x; }, std::forward<Combiner>(combine_op),
+      std::false_type{});
+}
+
+} // namespace internal
+
+}
+
+#endif
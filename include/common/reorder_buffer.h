@@ -0,0 +1,142 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_COMMON_REORDER_BUFFER_H
+#define GRPPI_COMMON_REORDER_BUFFER_H
+
+#include <vector>
+#include <algorithm>
+
+namespace grppi {
+
+/**
+\brief Buffer restoring the order of a stream of items tagged with sequence 
+numbers.
+Items arriving in order are released immediately. Items arriving out of order
+are kept in a min-heap keyed by their sequence number until all the previous
+items have been released. Consequently, every item is inserted and released 
+in logarithmic time on the number of buffered items.
+\tparam Item Type of the items. The sequence number of an item is taken from
+its `second` member (e.g. `std::pair<optional<T>,long>`).
+*/
+template <typename Item>
+class reorder_buffer {
+public:
+
+  /**
+  \brief Constructs an empty buffer.
+  \param first Sequence number of the first item in the stream.
+  */
+  explicit reorder_buffer(long first = 0) noexcept : next_{first} {}
+
+  /**
+  \brief Adds an item to the buffer and releases all the items that are 
+  ready to be delivered in order.
+  \param item Item to be added.
+  \param release_op Callable object invoked for every released item.
+  */
+  template <typename Release>
+  void push(Item && item, Release && release_op);
+
+  /**
+  \brief Adds an item to the buffer and releases all the items that are 
+  ready to be delivered in order.
+  \param item Item to be added.
+  \param release_op Callable object invoked for every released item.
+  */
+  template <typename Release>
+  void push(const Item & item, Release && release_op) {
+    push(Item{item}, std::forward<Release>(release_op));
+  }
+
+  /**
+  \brief Releases all the buffered items in order, regardless of any gap in 
+  the sequence numbers.
+  \param release_op Callable object invoked for every released item.
+  */
+  template <typename Release>
+  void flush(Release && release_op);
+
+  /**
+  \brief Determines if there are no buffered items.
+  */
+  bool empty() const noexcept { return heap_.empty(); }
+
+  /**
+  \brief Get the number of buffered items.
+  */
+  std::size_t size() const noexcept { return heap_.size(); }
+
+  /**
+  \brief Get the sequence number of the next item to be released.
+  */
+  long next() const noexcept { return next_; }
+
+private:
+  struct later {
+    bool operator()(const Item & a, const Item & b) const noexcept {
+      return a.second > b.second;
+    }
+  };
+
+  Item pop_first() {
+    std::pop_heap(heap_.begin(), heap_.end(), later{});
+    Item item{std::move(heap_.back())};
+    heap_.pop_back();
+    return item;
+  }
+
+private:
+  long next_;
+  std::vector<Item> heap_;
+};
+
+template <typename Item>
+template <typename Release>
+void reorder_buffer<Item>::push(Item && item, Release && release_op)
+{
+  if (item.second != next_) {
+    heap_.push_back(std::move(item));
+    std::push_heap(heap_.begin(), heap_.end(), later{});
+    return;
+  }
+
+  release_op(std::move(item));
+  next_++;
+  while (!heap_.empty() && heap_.front().second == next_) {
+    release_op(pop_first());
+    next_++;
+  }
+}
+
+template <typename Item>
+template <typename Release>
+void reorder_buffer<Item>::flush(Release && release_op)
+{
+  while (!heap_.empty()) {
+    auto item = pop_first();
+    next_ = item.second + 1;
+    release_op(std::move(item));
+  }
+}
+
+}
+
+#endif
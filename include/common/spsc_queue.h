@@ -0,0 +1,253 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_COMMON_SPSC_QUEUE_H
+#define GRPPI_COMMON_SPSC_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+#include "mpmc_queue.h"
+
+namespace grppi {
+
+/**
+\brief Bounded single-producer/single-consumer queue.
+
+The queue is a ring buffer where the producer is the only writer of the write
+position and the consumer is the only writer of the read position. 
+Consequently, both push and pop are completed with a fixed number of steps 
+and without any atomic read-modify-write operation.
+
+When the queue is full (or empty) the producer (or consumer) spins for a 
+bounded number of attempts and then parks on a condition variable. In 
+blocking mode threads park without spinning.
+
+\note At most one thread may push and at most one thread may pop 
+concurrently.
+*/
+template <typename T>
+class spsc_queue {
+public:
+  using value_type = T;
+
+  spsc_queue(int q_size, queue_mode q_mode) :
+    size_{q_size}, 
+    items_{new T[q_size]}, 
+    max_spins_{(q_mode == queue_mode::lockfree) ? 1024 : 0}
+  {}
+
+  spsc_queue(spsc_queue && q) :
+    size_{q.size_},
+    items_{std::move(q.items_)},
+    max_spins_{q.max_spins_},
+    pread_{q.pread_.load()},
+    pwrite_{q.pwrite_.load()}
+  {}
+
+  spsc_queue(const spsc_queue &) = delete;
+  spsc_queue & operator=(const spsc_queue &) = delete;
+
+  bool is_empty() const noexcept;
+  T pop();
+  bool push(T item);
+
+  /**
+  \brief Pushes a sequence of items moving them into the queue.
+  All the items fitting in the queue are published at once.
+  */
+  template <typename InputIt>
+  void push_bulk(InputIt first, InputIt last);
+
+  /**
+  \brief Pops up to max_items items, waiting only if the queue is empty.
+  \return The number of items written to out (at least one).
+  */
+  template <typename OutputIt>
+  int pop_bulk(OutputIt out, int max_items);
+
+  /**
+  \brief Pops up to max_items items without waiting.
+  \return The number of items written to out (may be zero).
+  */
+  template <typename OutputIt>
+  int try_pop_bulk(OutputIt out, int max_items);
+
+private:
+  bool can_push() const noexcept;
+  bool can_pop() const noexcept;
+  void wait_push();
+  void wait_pop();
+  void wake(std::atomic<bool> & waiting, std::condition_variable & cv);
+
+private:
+  int size_;
+  std::unique_ptr<T[]> items_;
+  int max_spins_;
+
+  // Positions are kept in different cache lines to avoid false sharing
+  // between the producer and the consumer.
+  char pad0_[64];
+  std::atomic<unsigned long long> pread_{0};
+  char pad1_[64];
+  std::atomic<unsigned long long> pwrite_{0};
+  char pad2_[64];
+
+  std::atomic<bool> producer_waiting_{false};
+  std::atomic<bool> consumer_waiting_{false};
+
+  std::mutex mutex_;
+  std::condition_variable empty_;
+  std::condition_variable full_;
+};
+
+template <typename T>
+bool spsc_queue<T>::is_empty() const noexcept
+{
+  return pread_.load() == pwrite_.load();
+}
+
+template <typename T>
+T spsc_queue<T>::pop()
+{
+  wait_pop();
+  const auto current = pread_.load(std::memory_order_relaxed);
+  T item = std::move(items_[current % size_]);
+  pread_.store(current + 1, std::memory_order_release);
+  wake(producer_waiting_, full_);
+  return item;
+}
+
+template <typename T>
+bool spsc_queue<T>::push(T item)
+{
+  wait_push();
+  const auto current = pwrite_.load(std::memory_order_relaxed);
+  items_[current % size_] = std::move(item);
+  pwrite_.store(current + 1, std::memory_order_release);
+  wake(consumer_waiting_, empty_);
+  return true;
+}
+
+template <typename T>
+template <typename InputIt>
+void spsc_queue<T>::push_bulk(InputIt first, InputIt last)
+{
+  while (first != last) {
+    wait_push();
+    auto current = pwrite_.load(std::memory_order_relaxed);
+    const auto limit = pread_.load(std::memory_order_acquire) + size_;
+    for (; first!=last && current<limit; ++first, ++current) {
+      items_[current % size_] = std::move(*first);
+    }
+    pwrite_.store(current, std::memory_order_release);
+    wake(consumer_waiting_, empty_);
+  }
+}
+
+template <typename T>
+template <typename OutputIt>
+int spsc_queue<T>::pop_bulk(OutputIt out, int max_items)
+{
+  wait_pop();
+  return try_pop_bulk(out, max_items);
+}
+
+template <typename T>
+template <typename OutputIt>
+int spsc_queue<T>::try_pop_bulk(OutputIt out, int max_items)
+{
+  auto current = pread_.load(std::memory_order_relaxed);
+  const auto last = pwrite_.load(std::memory_order_acquire);
+  int n = 0;
+  for (; n<max_items && current<last; ++n, ++current) {
+    *out++ = std::move(items_[current % size_]);
+  }
+  if (n == 0) return 0;
+  pread_.store(current, std::memory_order_release);
+  wake(producer_waiting_, full_);
+  return n;
+}
+
+template <typename T>
+void spsc_queue<T>::wait_push()
+{
+  for (int spins=0; !can_push(); ++spins) {
+    if (spins < max_spins_) continue;
+    std::unique_lock<std::mutex> lock{mutex_};
+    producer_waiting_.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    full_.wait(lock, [this]() { return can_push(); });
+    producer_waiting_.store(false);
+  }
+}
+
+template <typename T>
+void spsc_queue<T>::wait_pop()
+{
+  for (int spins=0; !can_pop(); ++spins) {
+    if (spins < max_spins_) continue;
+    std::unique_lock<std::mutex> lock{mutex_};
+    consumer_waiting_.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    empty_.wait(lock, [this]() { return can_pop(); });
+    consumer_waiting_.store(false);
+  }
+}
+
+template <typename T>
+bool spsc_queue<T>::can_push() const noexcept
+{
+  return pwrite_.load(std::memory_order_relaxed) - 
+         pread_.load(std::memory_order_acquire) < 
+         static_cast<unsigned long long>(size_);
+}
+
+template <typename T>
+bool spsc_queue<T>::can_pop() const noexcept
+{
+  return pread_.load(std::memory_order_relaxed) != 
+         pwrite_.load(std::memory_order_acquire);
+}
+
+template <typename T>
+void spsc_queue<T>::wake(std::atomic<bool> & waiting, 
+                         std::condition_variable & cv)
+{
+  // Pairs with the store of the waiting flag done by the parked thread.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiting.load()) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    cv.notify_one();
+  }
+}
+
+namespace internal {
+
+template <typename T>
+struct is_queue<spsc_queue<T>> : std::true_type {};
+
+}
+
+}
+
+#endif
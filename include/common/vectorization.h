@@ -0,0 +1,279 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_COMMON_VECTORIZATION_H
+#define GRPPI_COMMON_VECTORIZATION_H
+
+#include "iterator.h"
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace grppi {
+
+/**
+\brief Default number of lanes in the batches passed to vectorized
+transformers.
+*/
+constexpr std::size_t default_lane_count = 8;
+
+/**
+\brief Batch of values of an arithmetic type processed together.
+Arithmetic operators are applied lane by lane in fixed size loops, which
+compilers turn into SIMD instructions.
+\tparam T Type of the values.
+\tparam N Number of lanes.
+*/
+template <typename T, std::size_t N>
+struct lane_batch {
+  T lanes[N];
+
+  /**
+  \brief Number of lanes in the batch.
+  */
+  static constexpr std::size_t size() noexcept { return N; }
+
+  /**
+  \brief Loads a batch from consecutive positions.
+  \param p Pointer to the first value.
+  */
+  static lane_batch load(const T * p) noexcept {
+    lane_batch result;
+    for (std::size_t i=0; i<N; ++i) { result.lanes[i] = p[i]; }
+    return result;
+  }
+
+  /**
+  \brief Stores the batch into consecutive positions.
+  \param p Pointer to the first position.
+  */
+  template <typename U>
+  void store(U * p) const noexcept {
+    for (std::size_t i=0; i<N; ++i) { p[i] = static_cast<U>(lanes[i]); }
+  }
+
+  T & operator[](std::size_t i) noexcept { return lanes[i]; }
+  const T & operator[](std::size_t i) const noexcept { return lanes[i]; }
+};
+
+template <typename T, std::size_t N>
+lane_batch<T,N> operator-(const lane_batch<T,N> & x) noexcept {
+  lane_batch<T,N> result;
+  for (std::size_t i=0; i<N; ++i) { result.lanes[i] = -x.lanes[i]; }
+  return result;
+}
+
+// Lane by lane operators between two batches and between a batch and a scalar
+#define GRPPI_LANE_BATCH_OPERATOR(OP)\
+template <typename T, typename U, std::size_t N>\
+auto operator OP(const lane_batch<T,N> & x, const lane_batch<U,N> & y) noexcept {\
+  lane_batch<decltype(x.lanes[0] OP y.lanes[0]),N> result;\
+  for (std::size_t i=0; i<N; ++i) { result.lanes[i] = x.lanes[i] OP y.lanes[i]; }\
+  return result;\
+}\
+template <typename T, typename U, std::size_t N,\
+          std::enable_if_t<std::is_arithmetic<U>::value, int> = 0>\
+auto operator OP(const lane_batch<T,N> & x, U y) noexcept {\
+  lane_batch<decltype(x.lanes[0] OP y),N> result;\
+  for (std::size_t i=0; i<N; ++i) { result.lanes[i] = x.lanes[i] OP y; }\
+  return result;\
+}\
+template <typename T, typename U, std::size_t N,\
+          std::enable_if_t<std::is_arithmetic<U>::value, int> = 0>\
+auto operator OP(U x, const lane_batch<T,N> & y) noexcept {\
+  lane_batch<decltype(x OP y.lanes[0]),N> result;\
+  for (std::size_t i=0; i<N; ++i) { result.lanes[i] = x OP y.lanes[i]; }\
+  return result;\
+}
+
+GRPPI_LANE_BATCH_OPERATOR(+)
+GRPPI_LANE_BATCH_OPERATOR(-)
+GRPPI_LANE_BATCH_OPERATOR(*)
+GRPPI_LANE_BATCH_OPERATOR(/)
+
+#undef GRPPI_LANE_BATCH_OPERATOR
+
+/**
+\brief Transformer which may also be invoked with batches of lanes.
+When all the sequences of a map are contiguous sequences of arithmetic
+values, the transformer is invoked with lane_batch arguments for full
+batches and with scalar values for the remaining elements. Otherwise, it is
+invoked with scalar values.
+\tparam Transformer Callable type accepting both scalar values and batches
+(e.g. a generic lambda using arithmetic operators).
+\tparam N Number of lanes in a batch.
+*/
+template <typename Transformer, std::size_t N>
+class vectorized_transformer {
+public:
+  /// Number of lanes in a batch.
+  constexpr static std::size_t lanes = N;
+
+  explicit vectorized_transformer(Transformer transform_op) :
+    transform_op_{std::move(transform_op)}
+  {}
+
+  template <typename ... Args>
+  decltype(auto) operator()(Args && ... args) const {
+    return transform_op_(std::forward<Args>(args)...);
+  }
+
+private:
+  Transformer transform_op_;
+};
+
+/**
+\brief Wraps a transformer so that map invokes it with batches of lanes
+on contiguous arithmetic sequences.
+\tparam N Number of lanes in a batch.
+\param transform_op Transformer accepting both scalar values and batches.
+*/
+template <std::size_t N = default_lane_count, typename Transformer>
+auto vectorize(Transformer && transform_op) {
+  return vectorized_transformer<std::decay_t<Transformer>, N>{
+      std::forward<Transformer>(transform_op)};
+}
+
+namespace internal {
+
+template <typename I>
+using iterator_value_t = typename std::iterator_traits<I>::value_type;
+
+template <typename I, typename = void>
+struct is_contiguous_arithmetic : std::false_type {};
+
+// Booleans are excluded as values in std::vector<bool> are not addressable
+template <typename I>
+struct is_contiguous_arithmetic<I,
+    std::enable_if_t<std::is_arithmetic<iterator_value_t<I>>::value &&
+                     !std::is_same<iterator_value_t<I>,bool>::value>>
+  : std::integral_constant<bool,
+        std::is_pointer<I>::value ||
+        std::is_same<I, typename std::vector<iterator_value_t<I>>::iterator>::value ||
+        std::is_same<I, typename std::vector<iterator_value_t<I>>::const_iterator>::value>
+{};
+
+template <typename ... Is>
+struct all_contiguous_arithmetic : std::true_type {};
+
+template <typename I, typename ... Is>
+struct all_contiguous_arithmetic<I, Is...> : std::integral_constant<bool,
+    is_contiguous_arithmetic<I>::value && all_contiguous_arithmetic<Is...>::value>
+{};
+
+template <typename T>
+struct is_vectorized_transformer : std::false_type {};
+
+template <typename T, std::size_t N>
+struct is_vectorized_transformer<vectorized_transformer<T,N>> : std::true_type
+{};
+
+// Input pointers keep the constness of the iterators, so that transformers
+// taking non-const references are still accepted.
+template <typename Transformer, typename Output, typename ... Inputs>
+void map_pointers(std::false_type, Transformer && transform_op,
+                  std::size_t size, Output * out, Inputs * ... ins)
+{
+  for (std::size_t i=0; i<size; ++i) {
+    out[i] = transform_op(ins[i]...);
+  }
+}
+
+template <typename Transformer, typename Output, typename ... Inputs>
+void map_pointers(std::true_type, Transformer && transform_op,
+                  std::size_t size, Output * out, Inputs * ... ins)
+{
+  constexpr std::size_t N = std::decay_t<Transformer>::lanes;
+  std::size_t i=0;
+  for (; i+N<=size; i+=N) {
+    transform_op(lane_batch<std::remove_const_t<Inputs>,N>::load(ins+i)...)
+        .store(out+i);
+  }
+  for (; i<size; ++i) {
+    out[i] = transform_op(ins[i]...);
+  }
+}
+
+template <typename ... InputIterators, typename OutputIterator,
+          typename Transformer, std::size_t ... I>
+void map_sequence(std::tuple<InputIterators...> firsts,
+                  OutputIterator first_out, std::size_t size,
+                  Transformer && transform_op, std::true_type,
+                  std::index_sequence<I...>)
+{
+  if (size == 0) return;
+  using vectorized = is_vectorized_transformer<std::decay_t<Transformer>>;
+  map_pointers(vectorized{}, std::forward<Transformer>(transform_op), size,
+      std::addressof(*first_out), std::addressof(*std::get<I>(firsts))...);
+}
+
+template <typename ... InputIterators, typename OutputIterator,
+          typename Transformer, std::size_t ... I>
+void map_sequence(std::tuple<InputIterators...> firsts,
+                  OutputIterator first_out, std::size_t size,
+                  Transformer && transform_op, std::false_type,
+                  std::index_sequence<I...>)
+{
+  const auto last = std::next(std::get<0>(firsts), size);
+  while (std::get<0>(firsts) != last) {
+    *first_out++ = grppi::apply_deref_increment(
+        std::forward<Transformer>(transform_op), firsts);
+  }
+}
+
+} // namespace internal
+
+/**
+\brief Applies a transformation to multiple sequences leaving the result in
+another sequence.
+When the output and all the input sequences are contiguous sequences of
+arithmetic values, the loop is run on plain pointers so that the compiler
+can vectorize it. In that case vectorized transformers are invoked with
+batches of lanes.
+\tparam InputIterators Iterator types for input sequences.
+\tparam OutputIterator Iterator type for the output sequence.
+\tparam Transformer Callable object type for the transformation.
+\param firsts Tuple of iterators to input sequences.
+\param first_out Iterator to the output sequence.
+\param size Size of the input sequences.
+\param transform_op Transformation callable object.
+*/
+template <typename ... InputIterators, typename OutputIterator,
+          typename Transformer>
+void map_sequence(std::tuple<InputIterators...> firsts,
+                  OutputIterator first_out, std::size_t size,
+                  Transformer && transform_op)
+{
+  using contiguous = internal::all_contiguous_arithmetic<
+      OutputIterator, InputIterators...>;
+  internal::map_sequence(firsts, first_out, size,
+      std::forward<Transformer>(transform_op),
+      std::integral_constant<bool, contiguous::value>{},
+      std::index_sequence_for<InputIterators...>{});
+}
+
+}
+
+#endif
@@ -63,6 +63,42 @@ auto divide_conquer(
         std::forward<Combiner>(combiner_op));
 }
 
+/**
+\brief Invoke \ref md_divide-conquer with a base case predicate.
+\parapm Execution Execution type.
+\tparam Input Type used for the input problem.
+\tparam Divider Callable type for the divider operation.
+\tparam Predicate Callable type for the base case predicate.
+\tparam Solver Callable type for the solver operation.
+\tparam Combiner Callable type for the combiner operation.
+\param ex Execution policy object.
+\param input Input problem to be solved.
+\param divider_op Divider operation.
+\param predicate_op Predicate operation that determines if a problem is a 
+base case. Base cases are solved without further division.
+\param solver_op Solver operation.
+\param combiner_op Combiner operation.
+*/
+template <typename Execution, typename Input, 
+          typename Divider, typename Predicate, 
+          typename Solver, typename Combiner>
+auto divide_conquer(
+    const Execution & ex, 
+    Input && input, 
+    Divider && divider_op, 
+    Predicate && predicate_op,
+    Solver && solver_op, 
+    Combiner && combiner_op) 
+{
+  static_assert(supports_divide_conquer<Execution>(),
+      "divide/conquer pattern not supported for execution type");
+  return ex.divide_conquer(std::forward<Input>(input), 
+        std::forward<Divider>(divider_op), 
+        std::forward<Predicate>(predicate_op), 
+        std::forward<Solver>(solver_op), 
+        std::forward<Combiner>(combiner_op));
+}
+
 /**
 @}
 @}
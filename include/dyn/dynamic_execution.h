@@ -26,21 +26,73 @@
 #include "../tbb/parallel_execution_tbb.h"
 #include "../omp/parallel_execution_omp.h"
 
-#include <memory>
+#include <type_traits>
+#include <new>
 
 namespace grppi{
 
+/**
+\brief Execution policy selected at run time.
+
+The selected policy is stored in place together with a tag identifying it, so
+that no heap allocation is needed. Every pattern is dispatched through a single
+switch on the tag, without RTTI.
+*/
 class dynamic_execution {
 public:
 
+  /**
+  \brief Constructs a dynamic execution without a policy.
+  */
   dynamic_execution() noexcept :
-    execution_{}
+    kind_{execution_kind::none}
   {}
 
-  template <typename E>
-  dynamic_execution(const E & e) : execution_{std::make_unique<execution<E>>(e)} {}
+  /**
+  \brief Constructs a dynamic execution from an execution policy.
+  \note If the policy is not supported in the current compilation, the 
+  dynamic execution has no policy.
+  \note A policy passed as an rvalue is moved into the dynamic execution.
+  */
+  template <typename E, typename = std::enable_if_t<
+      !std::is_same<std::decay_t<E>, dynamic_execution>::value>>
+  dynamic_execution(E && e) :
+    kind_{execution_kind::none}
+  {
+    using execution_type = std::decay_t<E>;
+    constexpr auto kind = kind_of(static_cast<const execution_type*>(nullptr));
+    if (kind != execution_kind::none) {
+      new (&storage_) execution_type{std::forward<E>(e)};
+      kind_ = kind;
+    }
+  }
+
+  dynamic_execution(const dynamic_execution &) = delete;
+  dynamic_execution & operator=(const dynamic_execution &) = delete;
+
+  dynamic_execution(dynamic_execution && other) :
+    kind_{execution_kind::none}
+  {
+    move_from(other);
+  }
+
+  dynamic_execution & operator=(dynamic_execution && other) {
+    if (this != &other) {
+      reset();
+      move_from(other);
+    }
+    return *this;
+  }
+
+  ~dynamic_execution() { reset(); }
+
+  bool has_execution() const noexcept { return kind_ != execution_kind::none; }
 
-  bool has_execution() const { return execution_.get() != nullptr; }
+  /**
+  \brief Get the concurrency degree of the wrapped policy.
+  \return The concurrency degree, or 1 if there is no policy.
+  */
+  int concurrency_degree() const noexcept;
 
   /**
   \brief Applies a trasnformation to multiple sequences leaving the result in
@@ -101,6 +153,28 @@ public:
           Identity && identity,
           Transformer && transform_op, Combiner && combine_op) const;
 
+  /**
+  \brief Applies a scan (prefix combination) to a sequence of data items.
+  \tparam InputIterator Iterator type for the input sequence.
+  \tparam OutputIterator Iterator type for the output sequence.
+  \tparam Identity Type for the identity value.
+  \tparam Combiner Callable object type for the combination.
+  \param first Iterator to the first element of the sequence.
+  \param first_out Iterator to the first element of the output sequence.
+  \param sequence_size Size of the input sequence.
+  \param identity Identity value for the combination.
+  \param combine_op Associative combination callable object.
+  \param mode Inclusive or exclusive scan.
+  \pre Iterators in the ranges `[first, next(first,sequence_size))` and
+  `[first_out, next(first_out,sequence_size))` are valid. 
+  \return The combination of the identity and all the elements.
+  */
+  template <typename InputIterator, typename OutputIterator, 
+            typename Identity, typename Combiner>
+  auto scan(InputIterator first, OutputIterator first_out, 
+            std::size_t sequence_size, Identity && identity, 
+            Combiner && combine_op, scan_mode mode) const;
+
   /**
   \brief Applies a stencil to multiple sequences leaving the result in
   another sequence.
@@ -124,6 +198,28 @@ public:
           StencilTransformer && transform_op,
           Neighbourhood && neighbour_op) const;
 
+  /**
+  \brief Applies a number of time steps of a stencil to a multi-dimensional 
+  grid leaving the result in another grid.
+  \tparam InputIt Random access iterator type for the input grid.
+  \tparam OutputIt Random access iterator type for the output grid.
+  \tparam D Number of dimensions of the grid.
+  \tparam StencilTransformer Callable object type for the stencil 
+  transformation.
+  \param shape Shape of the grid.
+  \param first Iterator to the first element of the input grid.
+  \param first_out Iterator to the first element of the output grid.
+  \param num_steps Number of time steps computed per tile without 
+  synchronization.
+  \param transform_op Stencil transformation callable object invoked with a
+  grid_neighbourhood.
+  */
+  template <typename InputIt, typename OutputIt, std::size_t D,
+            typename StencilTransformer>
+  void stencil(const grid_shape<D> & shape, InputIt first, 
+               OutputIt first_out, std::size_t num_steps,
+               StencilTransformer && transform_op) const;
+
   /**
   \brief Invoke \ref md_divide-conquer.
   \tparam Input Type used for the input problem.
@@ -142,6 +238,27 @@ public:
                       Solver && solve_op, 
                       Combiner && combine_op) const; 
 
+  /**
+  \brief Invoke \ref md_divide-conquer with a base case predicate.
+  \tparam Input Type used for the input problem.
+  \tparam Divider Callable type for the divider operation.
+  \tparam Predicate Callable type for the base case predicate.
+  \tparam Solver Callable type for the solver operation.
+  \tparam Combiner Callable type for the combiner operation.
+  \param input Input problem to be solved.
+  \param divider_op Divider operation.
+  \param predicate_op Base case predicate operation.
+  \param solver_op Solver operation.
+  \param combine_op Combiner operation.
+  */
+  template <typename Input, typename Divider, typename Predicate, 
+            typename Solver, typename Combiner>
+  auto divide_conquer(Input && input, 
+                      Divider && divide_op, 
+                      Predicate && predicate_op,
+                      Solver && solve_op, 
+                      Combiner && combine_op) const; 
+
   /**
   \brief Invoke \ref md_pipeline.
   \tparam Generator Callable type for the generator operation.
@@ -155,23 +272,72 @@ public:
 
 private:
 
-  class execution_base {
-  public:
-    virtual ~execution_base() {};
-  };
+  /// Tag of the stored execution policy.
+  enum class execution_kind { none, sequential, native, omp, tbb };
+
+  static constexpr execution_kind kind_of(const void *) noexcept {
+    return execution_kind::none;
+  }
+
+  static constexpr execution_kind kind_of(const sequential_execution *) noexcept {
+    return execution_kind::sequential;
+  }
+
+  static constexpr execution_kind kind_of(
+      const parallel_execution_native *) noexcept 
+  {
+    return execution_kind::native;
+  }
+
+#ifdef GRPPI_OMP
+  static constexpr execution_kind kind_of(
+      const parallel_execution_omp *) noexcept 
+  {
+    return execution_kind::omp;
+  }
+#endif
+
+#ifdef GRPPI_TBB
+  static constexpr execution_kind kind_of(
+      const parallel_execution_tbb *) noexcept 
+  {
+    return execution_kind::tbb;
+  }
+#endif
+
+  template <typename E>
+  const E & get() const noexcept {
+    return *reinterpret_cast<const E*>(&storage_);
+  }
 
   template <typename E>
-  class execution : public execution_base {
-  public:
-    execution(const E & e) : ex_{e} {}
-    virtual ~execution() = default;
-    E ex_;
-  };
+  E & get() noexcept {
+    return *reinterpret_cast<E*>(&storage_);
+  }
+
+  template <typename E>
+  void construct_from(E & other) {
+    new (&storage_) E{std::move(other)};
+  }
+
+  void move_from(dynamic_execution & other);
+  void reset() noexcept;
 
 private:
-  /// Pointer to dynamically allocated execution policy.
-  std::unique_ptr<execution_base> execution_;
+  using storage_type = std::aligned_union_t<0,
+      sequential_execution,
+      parallel_execution_native
+#ifdef GRPPI_OMP
+      , parallel_execution_omp
+#endif
+#ifdef GRPPI_TBB
+      , parallel_execution_tbb
+#endif
+  >;
 
+  /// Storage for the selected execution policy.
+  storage_type storage_;
+  execution_kind kind_;
 };
 
 /**
@@ -202,6 +368,13 @@ constexpr bool supports_reduce<dynamic_execution>() { return true; }
 template <>
 constexpr bool supports_map_reduce<dynamic_execution>() { return true; }
 
+/**
+\brief Determines if an execution policy supports the scan pattern.
+\note Specialization for dynamic_execution.
+*/
+template <>
+constexpr bool supports_scan<dynamic_execution>() { return true; }
+
 /**
 \brief Determines if an execution policy supports the stencil pattern.
 \note Specialization for dynamic_execution.
@@ -225,35 +398,95 @@ constexpr bool supports_pipeline<dynamic_execution>() { return true; }
 
 
 
-#define GRPPI_TRY_PATTERN(E,PATTERN,...)\
-{\
-  if (supports_##PATTERN<E>()) {\
-    auto * ex = dynamic_cast<execution<E>*>(execution_.get());\
-    if (ex) {\
-      return ex->ex_.PATTERN(__VA_ARGS__);\
-    }\
-  }\
+#ifdef GRPPI_OMP
+#define GRPPI_CASE_OMP(K,CASE) CASE(K::omp, parallel_execution_omp)
+#else
+#define GRPPI_CASE_OMP(K,CASE)
+#endif
+
+#ifdef GRPPI_TBB
+#define GRPPI_CASE_TBB(K,CASE) CASE(K::tbb, parallel_execution_tbb)
+#else
+#define GRPPI_CASE_TBB(K,CASE)
+#endif
+
+#define GRPPI_CASE_ALL(K,CASE) \
+CASE(K::sequential, sequential_execution) \
+CASE(K::native, parallel_execution_native) \
+GRPPI_CASE_OMP(K,CASE) \
+GRPPI_CASE_TBB(K,CASE)
+
+inline void dynamic_execution::move_from(dynamic_execution & other)
+{
+#define GRPPI_MOVE_CASE(KIND,E) \
+  case KIND: construct_from(other.get<E>()); break;
+
+  switch (other.kind_) {
+    GRPPI_CASE_ALL(execution_kind, GRPPI_MOVE_CASE)
+    default: break;
+  }
+  kind_ = other.kind_;
+  other.reset();
+
+#undef GRPPI_MOVE_CASE
 }
 
+inline int dynamic_execution::concurrency_degree() const noexcept
+{
+#define GRPPI_DEGREE_CASE(KIND,E) \
+  case KIND: return get<E>().concurrency_degree();
+
+  switch (kind_) {
+    GRPPI_CASE_ALL(execution_kind, GRPPI_DEGREE_CASE)
+    default: return 1;
+  }
+
+#undef GRPPI_DEGREE_CASE
+}
+
+inline void dynamic_execution::reset() noexcept
+{
+#define GRPPI_RESET_CASE(KIND,E) \
+  case KIND: get<E>().~E(); break;
+
+  switch (kind_) {
+    GRPPI_CASE_ALL(execution_kind, GRPPI_RESET_CASE)
+    default: break;
+  }
+  kind_ = execution_kind::none;
+
+#undef GRPPI_RESET_CASE
+}
+
+#define GRPPI_TRY_PATTERN(KIND,E,PATTERN,...)\
+  case KIND:\
+    if (supports_##PATTERN<E>()) {\
+      return get<E>().PATTERN(__VA_ARGS__);\
+    }\
+    break;
+
 #ifdef GRPPI_OMP
 #define GRPPI_TRY_PATTERN_OMP(PATTERN,...) \
-GRPPI_TRY_PATTERN(parallel_execution_omp,PATTERN,__VA_ARGS__)
+GRPPI_TRY_PATTERN(execution_kind::omp,parallel_execution_omp,PATTERN,__VA_ARGS__)
 #else
 #define GRPPI_TRY_PATTERN_OMP(PATTERN,...)
 #endif
 
 #ifdef GRPPI_TBB
 #define GRPPI_TRY_PATTERN_TBB(PATTERN,...) \
-GRPPI_TRY_PATTERN(parallel_execution_tbb,PATTERN,__VA_ARGS__)
+GRPPI_TRY_PATTERN(execution_kind::tbb,parallel_execution_tbb,PATTERN,__VA_ARGS__)
 #else
 #define GRPPI_TRY_PATTERN_TBB(PATTERN,...)
 #endif
 
 #define GRPPI_TRY_PATTERN_ALL(...) \
-GRPPI_TRY_PATTERN(sequential_execution, __VA_ARGS__) \
-GRPPI_TRY_PATTERN(parallel_execution_native, __VA_ARGS__) \
+switch (kind_) {\
+GRPPI_TRY_PATTERN(execution_kind::sequential, sequential_execution, __VA_ARGS__) \
+GRPPI_TRY_PATTERN(execution_kind::native, parallel_execution_native, __VA_ARGS__) \
 GRPPI_TRY_PATTERN_OMP(__VA_ARGS__) \
 GRPPI_TRY_PATTERN_TBB(__VA_ARGS__) \
+default: break;\
+}
 
 template <typename ... InputIterators, typename OutputIterator, 
           typename Transformer>
@@ -291,6 +524,20 @@ auto dynamic_execution::map_reduce(
       std::forward<Combiner>(combine_op));
 }
 
+template <typename InputIterator, typename OutputIterator, 
+          typename Identity, typename Combiner>
+auto dynamic_execution::scan(
+    InputIterator first, OutputIterator first_out,
+    std::size_t sequence_size,
+    Identity && identity,
+    Combiner && combine_op,
+    scan_mode mode) const
+{
+  GRPPI_TRY_PATTERN_ALL(scan, first, first_out, sequence_size, 
+      std::forward<Identity>(identity), std::forward<Combiner>(combine_op), 
+      mode);
+}
+
 template <typename ... InputIterators, typename OutputIterator,
           typename StencilTransformer, typename Neighbourhood>
 void dynamic_execution::stencil(
@@ -305,6 +552,18 @@ void dynamic_execution::stencil(
       std::forward<Neighbourhood>(neighbour_op));
 }
 
+template <typename InputIt, typename OutputIt, std::size_t D,
+          typename StencilTransformer>
+void dynamic_execution::stencil(
+    const grid_shape<D> & shape, 
+    InputIt first, OutputIt first_out, 
+    std::size_t num_steps,
+    StencilTransformer && transform_op) const
+{
+  GRPPI_TRY_PATTERN_ALL(stencil, shape, first, first_out, num_steps,
+      std::forward<StencilTransformer>(transform_op));
+}
+
 template <typename Input, typename Divider, typename Solver, typename Combiner>
 auto dynamic_execution::divide_conquer(
     Input && input, 
@@ -318,6 +577,22 @@ auto dynamic_execution::divide_conquer(
       std::forward<Combiner>(combine_op));
 }
 
+template <typename Input, typename Divider, typename Predicate, 
+          typename Solver, typename Combiner>
+auto dynamic_execution::divide_conquer(
+    Input && input, 
+    Divider && divide_op, 
+    Predicate && predicate_op,
+    Solver && solve_op, 
+    Combiner && combine_op) const
+{
+  GRPPI_TRY_PATTERN_ALL(divide_conquer, std::forward<Input>(input),
+      std::forward<Divider>(divide_op),
+      std::forward<Predicate>(predicate_op),
+      std::forward<Solver>(solve_op),
+      std::forward<Combiner>(combine_op));
+}
+
 template <typename Generator, typename ... Transformers>
 void dynamic_execution::pipeline(
     Generator && generate_op, 
@@ -331,6 +606,9 @@ void dynamic_execution::pipeline(
 #undef GRPPI_TRY_PATTERN_OMP
 #undef GRPPI_TRY_PATTERN_TBB
 #undef GRPPI_TRY_PATTERN_ALL
+#undef GRPPI_CASE_OMP
+#undef GRPPI_CASE_TBB
+#undef GRPPI_CASE_ALL
 
 } // end namespace grppi
 
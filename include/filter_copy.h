@@ -0,0 +1,224 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_FILTER_COPY_H
+#define GRPPI_FILTER_COPY_H
+
+#include <utility>
+#include <iterator>
+#include <vector>
+#include <tuple>
+
+#include "common/execution_traits.h"
+#include "common/iterator_traits.h"
+#include "common/range.h"
+
+namespace grppi {
+
+namespace internal {
+
+/**
+\brief Splits a sequence in parts and counts the elements satisfying a 
+predicate in every part.
+\return The parts and the number of elements satisfying the predicate before 
+every part. The last value is the total count.
+*/
+template <typename Execution, typename InputIt, typename Predicate>
+auto count_parts(const Execution & ex, InputIt first, InputIt last,
+                 Predicate & predicate_op)
+{
+  const auto size = static_cast<std::size_t>(std::distance(first, last));
+  const auto parts = grppi::split(subrange<InputIt>{first, last, size},
+      default_num_parts(ex));
+
+  std::vector<std::size_t> offsets(parts.size() + 1, 0);
+  ex.map(std::make_tuple(std::begin(parts)), std::next(std::begin(offsets)), 
+      parts.size(),
+      [&predicate_op](const auto & part) {
+        std::size_t count = 0;
+        for (auto && x : part) { if (predicate_op(x)) count++; }
+        return count;
+      });
+  for (std::size_t i=1; i<offsets.size(); ++i) {
+    offsets[i] += offsets[i-1];
+  }
+  return std::make_pair(std::move(parts), std::move(offsets));
+}
+
+/**
+\brief Copies the elements of every part to their output positions.
+Elements satisfying the predicate are written after the first offset[p] 
+elements of the first output sequence and the others after the first
+begin(p) - offset[p] elements of the second output sequence.
+*/
+template <typename Execution, typename Parts, typename TrueIt, 
+          typename FalseIt, typename Predicate>
+void scatter_parts(const Execution & ex, const Parts & parts, 
+                   const std::vector<std::size_t> & offsets,
+                   TrueIt first_true, FalseIt first_false,
+                   Predicate & predicate_op)
+{
+  std::vector<std::size_t> part_begins(parts.size(), 0);
+  for (std::size_t i=1; i<parts.size(); ++i) {
+    part_begins[i] = part_begins[i-1] + grppi::range_size(parts[i-1]);
+  }
+
+  ex.map(std::make_tuple(std::begin(parts), std::begin(offsets), 
+          std::begin(part_begins)), 
+      discard_iterator{}, parts.size(),
+      [&](const auto & part, std::size_t offset, std::size_t part_begin) {
+        auto out_true = std::next(first_true, offset);
+        auto out_false = std::next(first_false, part_begin - offset);
+        for (auto && x : part) { 
+          if (predicate_op(x)) { *out_true++ = x; }
+          else { *out_false++ = x; }
+        }
+        return char{1};
+      });
+}
+
+} // namespace internal
+
+/** 
+\addtogroup data_patterns
+@{
+\defgroup filter_copy_pattern Filter copy pattern
+\brief Interface for applying the \ref md_filter-copy.
+@{
+*/
+
+/**
+\brief Invoke \ref md_filter-copy on a data sequence, copying the elements 
+that satisfy a predicate. The relative order of the copied elements is 
+preserved.
+\tparam Execution Execution type.
+\tparam InputIt Iterator type used for the input sequence.
+\tparam OutputIt Iterator type used for the output sequence.
+\tparam Predicate Callable type for the predicate.
+\param ex Execution policy object.
+\param first Iterator to the first element in the input sequence.
+\param last Iterator to one past the end of the input sequence.
+\param first_out Iterator to the first element in the output sequence.
+\param predicate_op Predicate. It is invoked twice for every element.
+\return Iterator to one past the last copied element.
+*/
+template <typename Execution, typename InputIt, typename OutputIt, 
+          typename Predicate,
+          requires_iterator<InputIt> = 0,
+          requires_iterator<OutputIt> = 0>
+OutputIt filter_copy(const Execution & ex, 
+                     InputIt first, InputIt last, 
+                     OutputIt first_out,
+                     Predicate && predicate_op)
+{
+  static_assert(supports_map<Execution>(),
+      "map not supported on execution type");
+  auto counts = internal::count_parts(ex, first, last, predicate_op);
+  internal::scatter_parts(ex, counts.first, counts.second, 
+      first_out, internal::discard_iterator{}, predicate_op);
+  return std::next(first_out, counts.second.back());
+}
+
+/**
+\brief Invoke \ref md_filter-copy on a data sequence, copying the elements 
+that satisfy a predicate to a sequence and the other elements to another
+sequence. The relative order of the elements is preserved in both output
+sequences.
+\tparam Execution Execution type.
+\tparam InputIt Iterator type used for the input sequence.
+\tparam TrueIt Iterator type used for the output sequence of elements 
+satisfying the predicate.
+\tparam FalseIt Iterator type used for the output sequence of elements not
+satisfying the predicate.
+\tparam Predicate Callable type for the predicate.
+\param ex Execution policy object.
+\param first Iterator to the first element in the input sequence.
+\param last Iterator to one past the end of the input sequence.
+\param first_true Iterator to the first element in the output sequence of
+elements satisfying the predicate.
+\param first_false Iterator to the first element in the output sequence of
+elements not satisfying the predicate.
+\param predicate_op Predicate. It is invoked twice for every element.
+\return Pair of iterators to one past the last element copied to each output
+sequence.
+*/
+template <typename Execution, typename InputIt, typename TrueIt, 
+          typename FalseIt, typename Predicate,
+          requires_iterator<InputIt> = 0,
+          requires_iterator<TrueIt> = 0,
+          requires_iterator<FalseIt> = 0>
+std::pair<TrueIt,FalseIt> partition_copy(const Execution & ex, 
+                                         InputIt first, InputIt last, 
+                                         TrueIt first_true, 
+                                         FalseIt first_false,
+                                         Predicate && predicate_op)
+{
+  static_assert(supports_map<Execution>(),
+      "map not supported on execution type");
+  auto counts = internal::count_parts(ex, first, last, predicate_op);
+  internal::scatter_parts(ex, counts.first, counts.second, 
+      first_true, first_false, predicate_op);
+  const auto num_true = counts.second.back();
+  const auto num_false = std::distance(first, last) - num_true;
+  return {std::next(first_true, num_true), std::next(first_false, num_false)};
+}
+
+/**
+\brief Invoke \ref md_filter-copy on a data sequence, reordering the 
+elements so that the elements satisfying a predicate precede the other 
+elements. The relative order of the elements is preserved in both groups.
+\tparam Execution Execution type.
+\tparam ForwardIt Iterator type used for the sequence.
+\tparam Predicate Callable type for the predicate.
+\param ex Execution policy object.
+\param first Iterator to the first element in the sequence.
+\param last Iterator to one past the end of the sequence.
+\param predicate_op Predicate. It is invoked twice for every element.
+\return Iterator to the first element not satisfying the predicate.
+\note The elements are copied to a temporary buffer and moved back.
+*/
+template <typename Execution, typename ForwardIt, typename Predicate,
+          requires_iterator<ForwardIt> = 0>
+ForwardIt partition(const Execution & ex, 
+                    ForwardIt first, ForwardIt last, 
+                    Predicate && predicate_op)
+{
+  static_assert(supports_map<Execution>(),
+      "map not supported on execution type");
+  using value_type = typename std::iterator_traits<ForwardIt>::value_type;
+  auto counts = internal::count_parts(ex, first, last, predicate_op);
+  const auto num_true = counts.second.back();
+  std::vector<value_type> buffer(std::distance(first, last));
+  internal::scatter_parts(ex, counts.first, counts.second, 
+      std::begin(buffer), std::next(std::begin(buffer), num_true), 
+      predicate_op);
+  ex.map(std::make_tuple(std::make_move_iterator(std::begin(buffer))), first,
+      buffer.size(), [](auto && x) { return std::move(x); });
+  return std::next(first, num_true);
+}
+
+/**
+@}
+@}
+*/
+
+}
+
+#endif
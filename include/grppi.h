@@ -25,7 +25,12 @@
 #include "map.h"
 #include "mapreduce.h"
 #include "reduce.h"
+#include "scan.h"
+#include "filter_copy.h"
+#include "sort.h"
+#include "reduce_by_key.h"
 #include "stencil.h"
+#include "map_expression.h"
 
 namespace grppi {
 
@@ -25,6 +25,7 @@
 
 #include "common/execution_traits.h"
 #include "common/iterator_traits.h"
+#include "common/range.h"
 
 namespace grppi {
 
@@ -58,8 +59,43 @@ void map(const Execution & ex,
 {
   static_assert(supports_map<Execution>(),
       "map not supported on execution type");
-  ex.map(make_tuple(first), first_out,
-      std::distance(first, last), transform_op);
+  // Non random access sequences are split once instead of in every chunk
+  subrange<InputIt> in{first, last, 
+      static_cast<std::size_t>(std::distance(first, last))};
+  internal::map_range(ex, in, first_out, transform_op, 
+      std::integral_constant<bool, 
+          (internal::is_random_access_iterator<InputIt> && 
+           internal::is_random_access_iterator<OutputIt>) ||
+          !internal::is_forward_iterator<OutputIt>>{});
+}
+
+/**
+\brief Invoke \ref md_map on a range.
+Random access ranges are chunked in constant time and contiguous ranges are
+accessed through pointers. Other ranges are split through the split 
+customization point.
+\tparam Execution Execution type.
+\tparam InRange Type of the input range.
+\tparam OutRange Type of the output range.
+\tparam Transformer Callable type for the transformation operation.
+\param ex Execution policy object.
+\param in Input range.
+\param out Output range.
+\param transform_op Transformation operation.
+\pre out has at least as many elements as in.
+*/
+template <typename Execution, typename InRange, typename OutRange,
+          typename Transformer,
+          requires_range<InRange> = 0,
+          requires_range<OutRange> = 0>
+void map(const Execution & ex, InRange && in, OutRange && out,
+         Transformer transform_op)
+{
+  static_assert(supports_map<Execution>(),
+      "map not supported on execution type");
+  internal::map_range(ex, in, range_first(out), transform_op, 
+      std::integral_constant<bool, is_random_access_range<InRange> && 
+          is_random_access_range<OutRange>>{});
 }
 
 /**
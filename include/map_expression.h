@@ -0,0 +1,189 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_MAP_EXPRESSION_H
+#define GRPPI_MAP_EXPRESSION_H
+
+#include <iterator>
+#include <utility>
+#include <type_traits>
+
+#include "common/expression_pattern.h"
+#include "common/execution_traits.h"
+#include "common/iterator_traits.h"
+#include "common/range.h"
+#include "stream_filter.h"
+
+namespace grppi {
+
+/** 
+\addtogroup data_patterns
+@{
+\defgroup map_expression_pattern Map expressions
+\brief Interface for composing \ref md_map and \ref md_map-reduce into a
+single pass.
+@{
+*/
+
+/**
+\brief Builds a lazy map expression on a data sequence.
+The expression may be extended with further stages through operator|:
+transformations (grppi::transform()) and filters (grppi::keep() and
+grppi::discard()). It is evaluated when it is ended with grppi::fold() or
+grppi::store(), and then all the stages are applied in a single pass over
+the sequence.
+\tparam Execution Execution type.
+\tparam InputIt Iterator type used for the input sequence.
+\tparam Transformer Callable type for the transformation operation.
+\param ex Execution policy object. It must outlive the expression.
+\param first Iterator to the first element in the input sequence.
+\param last Iterator to one past the end of the input sequence.
+\param transform_op Transformation operation.
+\return The lazy expression.
+*/
+template <typename Execution, typename InputIt, typename Transformer,
+          requires_iterator<InputIt> = 0>
+auto lazy_map(const Execution & ex, InputIt first, InputIt last, 
+              Transformer && transform_op)
+{
+  static_assert(supports_map_reduce<Execution>(),
+      "map/reduce not supported on execution type");
+  using stage_type = transform_t<std::decay_t<Transformer>>;
+  return map_expression<Execution, InputIt, stage_type>{
+      ex, first, static_cast<std::size_t>(std::distance(first,last)),
+      std::make_tuple(stage_type{std::forward<Transformer>(transform_op)})};
+}
+
+/**
+\brief Builds a lazy map expression on a range.
+Contiguous ranges are accessed through pointers.
+\tparam Execution Execution type.
+\tparam Range Type of the input range.
+\tparam Transformer Callable type for the transformation operation.
+\param ex Execution policy object. It must outlive the expression.
+\param range Input range. It must outlive the expression.
+\param transform_op Transformation operation.
+\return The lazy expression.
+*/
+template <typename Execution, typename Range, typename Transformer,
+          requires_range<Range> = 0>
+auto lazy_map(const Execution & ex, Range && range, 
+              Transformer && transform_op)
+{
+  static_assert(supports_map_reduce<Execution>(),
+      "map/reduce not supported on execution type");
+  using stage_type = transform_t<std::decay_t<Transformer>>;
+  using iterator_type = decltype(range_first(range));
+  return map_expression<Execution, iterator_type, stage_type>{
+      ex, range_first(range), range_size(range),
+      std::make_tuple(stage_type{std::forward<Transformer>(transform_op)})};
+}
+
+/**
+\brief Builds a transformation stage for a map expression.
+\tparam Transformer Callable type for the transformation operation.
+\param transform_op Transformation operation.
+*/
+template <typename Transformer>
+auto transform(Transformer && transform_op)
+{
+  return transform_t<std::decay_t<Transformer>>{
+      std::forward<Transformer>(transform_op)};
+}
+
+/**
+\brief Builds the reduction ending a map expression.
+\tparam Identity Type for the identity value.
+\tparam Combiner Callable type for the combination operation.
+\param identity Identity value for the combination operation.
+\param combine_op Combination operation.
+*/
+template <typename Identity, typename Combiner>
+auto fold(Identity && identity, Combiner && combine_op)
+{
+  return fold_t<std::decay_t<Identity>, std::decay_t<Combiner>>{
+      std::forward<Identity>(identity), std::forward<Combiner>(combine_op)};
+}
+
+/**
+\brief Builds the output ending a map expression without filters.
+\tparam OutputIt Iterator type used for the output sequence.
+\param first_out Iterator to the first element of the output sequence.
+*/
+template <typename OutputIt,
+          requires_iterator<OutputIt> = 0>
+auto store(OutputIt first_out)
+{
+  return store_t<OutputIt>{first_out};
+}
+
+/**
+\brief Appends a transformation to a map expression.
+*/
+template <typename Execution, typename InputIt, typename ... Stages,
+          typename Transformer>
+auto operator|(const map_expression<Execution, InputIt, Stages...> & expr,
+               transform_t<Transformer> stage)
+{
+  return expr.append(std::move(stage));
+}
+
+/**
+\brief Appends a filter to a map expression.
+*/
+template <typename Execution, typename InputIt, typename ... Stages,
+          typename Predicate>
+auto operator|(const map_expression<Execution, InputIt, Stages...> & expr,
+               filter_t<Predicate> stage)
+{
+  return expr.append(std::move(stage));
+}
+
+/**
+\brief Evaluates a map expression reducing its elements in a single pass.
+\return The reduction of the elements passing all the filters.
+*/
+template <typename Execution, typename InputIt, typename ... Stages,
+          typename Identity, typename Combiner>
+auto operator|(const map_expression<Execution, InputIt, Stages...> & expr,
+               const fold_t<Identity, Combiner> & stage)
+{
+  return expr.reduce(stage.identity(), stage.combiner());
+}
+
+/**
+\brief Evaluates a map expression writing its elements in a single pass.
+*/
+template <typename Execution, typename InputIt, typename ... Stages,
+          typename OutputIt>
+void operator|(const map_expression<Execution, InputIt, Stages...> & expr,
+               const store_t<OutputIt> & stage)
+{
+  expr.store(stage.first());
+}
+
+/**
+@}
+@}
+*/
+
+}
+
+#endif
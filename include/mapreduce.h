@@ -25,6 +25,7 @@
 
 #include "common/execution_traits.h"
 #include "common/iterator_traits.h"
+#include "common/range.h"
 
 namespace grppi {
 
@@ -61,10 +62,48 @@ auto map_reduce(const Execution & ex,
 {
   static_assert(supports_map_reduce<Execution>(),
     "map/reduce not supported on execution type");
-  return ex.map_reduce(make_tuple(first), std::distance(first,last), 
+  // Non random access sequences are split once instead of in every chunk
+  subrange<InputIterator> range{first, last, 
+      static_cast<std::size_t>(std::distance(first,last))};
+  return internal::map_reduce_range(ex, range, 
       std::forward<Identity>(identity),
       std::forward<Transformer>(transform_op), 
-      std::forward<Combiner>(combine_op));
+      std::forward<Combiner>(combine_op),
+      std::integral_constant<bool, is_random_access_range<decltype(range)>>{});
+}
+
+/**
+\brief Invoke \ref md_map-reduce on a range.
+Random access ranges are chunked in constant time and contiguous ranges are
+accessed through pointers. Other ranges are split through the split 
+customization point.
+\tparam Execution Execution type.
+\tparam Range Type of the input range.
+\tparam Identity Type for the identity value.
+\tparam Transformer Callable type for the transformation operation.
+\tparam Combiner Callable type for the combination operation of the reduction.
+\param ex Execution policy object.
+\param range Input range.
+\param identity Identity value for the combination operation.
+\param transf_op Transformation operation.
+\param combine_op Combination operation.
+\return Result of the map/reduce operation.
+*/
+template <typename Execution, typename Range, typename Identity, 
+          typename Transformer, typename Combiner,
+          requires_range<Range> = 0>
+auto map_reduce(const Execution & ex, 
+                Range && range,
+                Identity && identity, 
+                Transformer && transform_op, Combiner && combine_op)
+{
+  static_assert(supports_map_reduce<Execution>(),
+    "map/reduce not supported on execution type");
+  return internal::map_reduce_range(ex, range, 
+      std::forward<Identity>(identity),
+      std::forward<Transformer>(transform_op), 
+      std::forward<Combiner>(combine_op),
+      std::integral_constant<bool, is_random_access_range<Range>>{});
 }
 
 /**
@@ -22,7 +22,17 @@
 #define GRPPI_NATIVE_PARALLEL_EXECUTION_NATIVE_H
 
 #include "worker_pool.h"
+#include "work_stealing_pool.h"
+#include "thread_affinity.h"
 #include "../common/mpmc_queue.h"
+#include "../common/spsc_queue.h"
+#include "../common/queue_batching.h"
+#include "../common/reorder_buffer.h"
+#include "../common/chunk_scheduler.h"
+#include "../common/cache_aligned.h"
+#include "../common/per_thread_storage.h"
+#include "../common/grid_stencil.h"
+#include "../common/scan_mode.h"
 #include "../common/iterator.h"
 #include "../common/execution_traits.h"
 
@@ -32,6 +42,8 @@
 #include <vector>
 #include <type_traits>
 #include <tuple>
+#include <memory>
+#include <limits>
 #include <experimental/optional>
 
 namespace grppi {
@@ -41,70 +53,164 @@ namespace grppi {
 
 A thread table provides a simple way to offer thread indices (starting from 0).
 
-When a thread registers itself in the registry, its id is added to the vector 
-of identifiers. When a thread deregisters itself from the registry its entry
-is modified to contain the empty thread id.
-
-To get an integer index, users may call `current_index`, which provides the order
-number of the calling thread in the registry.
-
-\note This class is thread safe by means of using a spin-lock.
+When a thread registers itself in the registry, it takes the lowest free 
+index, which is cached in a thread local table of the thread. When a thread 
+deregisters itself from the registry, its index is released and reused by 
+the next registered thread. Consequently, no two threads hold the same index
+at the same time, and indices stay below the maximum number of simultaneously
+registered threads.
+
+To get an integer index, users may call `current_index`, which only reads the
+thread local table of the calling thread. A thread which is not registered is
+registered by its first call to `current_index` and keeps its index until it
+finishes.
+
+\note Registration and deregistration are thread safe by means of using a 
+spin-lock.
+\note Copies of a registry share the same table of indices.
 */
 class thread_registry {
 public:
-  thread_registry() noexcept = default;
+  thread_registry() : state_{std::make_shared<shared_state>()} {}
+
+  // Copies share the table of indices
+  thread_registry(const thread_registry &) = default;
+  thread_registry & operator=(const thread_registry &) = default;
 
   /**
-  \brief Adds the current thread id in the registry.
+  \brief Adds the current thread in the registry.
+  A thread registered again keeps its index and must be deregistered as many
+  times as it was registered.
+  \throw std::bad_alloc if the tables of indices cannot grow.
   */
-  void register_thread() noexcept;
+  void register_thread();
 
   /**
-  \brief Removes current thread id from the registry.
+  \brief Removes current thread from the registry.
   */
   void deregister_thread() noexcept;
 
   /**
   \brief Integer index for current thread
-  \return Integer value with the registration order of current thread.
-  \pre Current thread is registered.
+  \return Integer value with the index of current thread.
+  \note If the current thread is not registered, it is registered until it
+  finishes.
+  \throw std::bad_alloc if the current thread cannot be registered.
   */
-  int current_index() const noexcept;
+  int current_index() const;
+
+private:
+  // Indices in use, shared with the thread local tables of the threads, which
+  // may outlive the registry.
+  struct shared_state {
+    std::atomic_flag lock = ATOMIC_FLAG_INIT;
+    std::vector<char> in_use;
+    int num_indices = 0;
+
+    int acquire();
+    void release(int index) noexcept;
+  };
+
+  struct registration {
+    std::shared_ptr<shared_state> state;
+    int index;
+    int count;
+  };
+
+  // Registrations of a thread. Those remaining when the thread finishes 
+  // (e.g. registered by current_index) are released.
+  struct registration_table {
+    std::vector<registration> entries;
+    ~registration_table() {
+      for (auto & r : entries) { r.state->release(r.index); }
+    }
+  };
+
+  static std::vector<registration> & registrations() noexcept {
+    static thread_local registration_table table;
+    return table.entries;
+  }
+
+  registration * find_registration() const noexcept {
+    for (auto & r : registrations()) { 
+      if (r.state == state_) return &r; 
+    }
+    return nullptr;
+  }
+
+  registration & add_registration() const {
+    auto & table = registrations();
+    // Entries only held by this thread belong to destroyed registries
+    table.erase(std::remove_if(table.begin(), table.end(),
+        [](auto & r) { return r.state.use_count() == 1; }), table.end());
+    // Room is made before taking an index, so that it is never leaked
+    table.reserve(table.size() + 1);
+    table.push_back({state_, state_->acquire(), 1});
+    return table.back();
+  }
 
 private:
-  mutable std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
-  std::vector<std::thread::id> ids_;
+  std::shared_ptr<shared_state> state_;
 };
 
-inline void thread_registry::register_thread() noexcept 
+inline int thread_registry::shared_state::acquire()
 {
   using namespace std;
-  while (lock_.test_and_set(memory_order_acquire)) {}
-  auto this_id = this_thread::get_id();
-  ids_.push_back(this_id);
-  lock_.clear(memory_order_release);
+  while (lock.test_and_set(memory_order_acquire)) {}
+  int index = 0;
+  while (index < num_indices && in_use[index]) { index++; }
+  if (index == num_indices) {
+    if (in_use.size() <= static_cast<std::size_t>(index)) {
+      try { in_use.resize(index + 1); }
+      catch (...) {
+        lock.clear(memory_order_release);
+        throw;
+      }
+    }
+    num_indices++;
+  }
+  in_use[index] = 1;
+  lock.clear(memory_order_release);
+  return index;
 }
 
-inline void thread_registry::deregister_thread() noexcept
+inline void thread_registry::shared_state::release(int index) noexcept
 {
   using namespace std;
-  while (lock_.test_and_set(memory_order_acquire)) {}
-  auto this_id = this_thread::get_id();
-  auto current = find(begin(ids_), end(ids_), this_id);
-  *current = {}; //Empty thread
-  lock_.clear(memory_order_release);
+  while (lock.test_and_set(memory_order_acquire)) {}
+  in_use[index] = 0;
+  // Trailing free indices are given back
+  while (num_indices > 0 && !in_use[num_indices-1]) { num_indices--; }
+  lock.clear(memory_order_release);
 }
 
-inline int thread_registry::current_index() const noexcept
+inline void thread_registry::register_thread()
 {
-  using namespace std;
-  while (lock_.test_and_set(memory_order_acquire)) {}
-  auto this_id = this_thread::get_id();
-  auto current = find(begin(ids_), end(ids_), this_id);
-  auto index = distance(begin(ids_), current);
-  lock_.clear(memory_order_release);
-  return index;
-};
+  auto * current = find_registration();
+  if (current) {
+    current->count++;
+    return;
+  }
+  add_registration();
+}
+
+inline void thread_registry::deregister_thread() noexcept
+{
+  auto * current = find_registration();
+  if (!current || --current->count > 0) return;
+
+  const int index = current->index;
+  auto & table = registrations();
+  *current = std::move(table.back());
+  table.pop_back();
+  state_->release(index);
+}
+
+inline int thread_registry::current_index() const
+{
+  auto * current = find_registration();
+  return current ? current->index : add_registration().index;
+}
 
 /**
 \brief RAII class to manage registration/deregistration pairs.
@@ -115,21 +221,32 @@ at construction and deregistered a destruction.
 class native_thread_manager {
 public:
   /**
-  \brief Saves a reference to the registry and registers current thread
+  \brief Saves a copy of the registry and registers current thread
   */
-  native_thread_manager(thread_registry & registry) 
+  native_thread_manager(const thread_registry & registry) 
       : registry_{registry}
   { registry_.register_thread(); }
 
+  /**
+  \brief Transfers the deregistration to a new manager.
+  */
+  native_thread_manager(native_thread_manager && other) noexcept
+      : registry_{other.registry_}, registered_{other.registered_}
+  { other.registered_ = false; }
+
+  native_thread_manager(const native_thread_manager &) = delete;
+  native_thread_manager & operator=(const native_thread_manager &) = delete;
+
   /**
   \brief Deregisters current thread from the registry.
   */
   ~native_thread_manager() { 
-    registry_.deregister_thread(); 
+    if (registered_) registry_.deregister_thread(); 
   }
 
 private:
-  thread_registry & registry_;
+  thread_registry registry_;
+  bool registered_ = true;
 };
 
 /** 
@@ -150,7 +267,7 @@ public:
   \note The concurrency degree is fixed to 2 times the hardware concurrency
    degree.
   */
-  parallel_execution_native() noexcept :
+  parallel_execution_native() :
       parallel_execution_native{
           static_cast<int>(2 * std::thread::hardware_concurrency()), 
           true}
@@ -163,20 +280,53 @@ public:
   and ordering mode.
   \param concurrency_degree Number of threads used for parallel algorithms.
   \param order Whether ordered executions is enabled or disabled.
+  \note The worker threads used by data parallel patterns are launched at
+  construction and live as long as the execution object.
   */
-  parallel_execution_native(int concurrency_degree, bool ordering=true) noexcept :
+  parallel_execution_native(int concurrency_degree, bool ordering=true) :
     concurrency_degree_{concurrency_degree},
-    ordering_{ordering}
+    ordering_{ordering},
+    pool_{make_pool()}
   {}
 
+  /**
+  \brief Copies a native parallel execution policy.
+  \note The copy launches its own worker pool, so copies are as expensive as
+  constructing a new policy. This includes wrapping a policy passed as an 
+  lvalue in a dynamic_execution. Move the policy when the original is no 
+  longer needed.
+  */
   parallel_execution_native(const parallel_execution_native & ex) :
-      parallel_execution_native{ex.concurrency_degree_, ex.ordering_}
+    concurrency_degree_{ex.concurrency_degree_},
+    ordering_{ex.ordering_},
+    queue_size_{ex.queue_size_},
+    queue_mode_{ex.queue_mode_},
+    queue_batch_{ex.queue_batch_},
+    scheduling_{ex.scheduling_},
+    grain_{ex.grain_},
+    parallel_combine_{ex.parallel_combine_},
+    placement_{ex.placement_},
+    pool_{make_pool()}
   {}
 
+  /**
+  \brief Moves a native parallel execution policy.
+  The worker pool and the thread indices are transferred, so that no thread 
+  is launched.
+  */
+  parallel_execution_native(parallel_execution_native &&) noexcept = default;
+  parallel_execution_native & operator=(parallel_execution_native &&) 
+      noexcept = default;
+
   /**
   \brief Set number of grppi threads.
+  \note The worker pool is relaunched with the new concurrency degree.
   */
-  void set_concurrency_degree(int degree) noexcept { concurrency_degree_ = degree; }
+  void set_concurrency_degree(int degree) { 
+    concurrency_degree_ = degree; 
+    pool_.reset();
+    pool_ = make_pool();
+  }
 
   /**
   \brief Get number of grppi trheads.
@@ -198,6 +348,71 @@ public:
   */
   bool is_ordered() const noexcept { return ordering_; }
 
+  /**
+  \brief Sets the scheduling of data parallel patterns.
+  With pinned scheduling, every chunk of a sequence is run by the same worker
+  in all the data parallel patterns of this execution. Chunks wait for their 
+  worker to be available, so that this mode should not be used with nested 
+  patterns or patterns launched concurrently from several threads.
+  \param mode Scheduling mode.
+  \param grain Minimum number of elements in a chunk for on demand modes. 
+  A value of 0 lets the implementation select it.
+  */
+  void set_scheduling(scheduling_mode mode, std::size_t grain = 0) noexcept {
+    scheduling_ = mode;
+    grain_ = grain;
+  }
+
+  /**
+  \brief Get the scheduling mode of data parallel patterns.
+  */
+  scheduling_mode scheduling() const noexcept { return scheduling_; }
+
+  /**
+  \brief Get the grain size for on demand scheduling modes.
+  */
+  std::size_t grain_size() const noexcept { return grain_; }
+
+  /**
+  \brief Enable parallel combination of partial results.
+  Partial results of reduce and map_reduce are combined pairwise in a tree
+  whose levels are run in parallel. Useful for expensive combiners.
+  */
+  void enable_parallel_combine() noexcept { parallel_combine_ = true; }
+
+  /**
+  \brief Disable parallel combination of partial results.
+  Partial results are combined in order by the calling thread.
+  */
+  void disable_parallel_combine() noexcept { parallel_combine_ = false; }
+
+  /**
+  \brief Are partial results combined in parallel.
+  */
+  bool is_parallel_combine() const noexcept { return parallel_combine_; }
+
+  /**
+  \brief Sets the placement of the worker threads on the processors.
+  Workers are bound when they are launched, so the worker pool is relaunched.
+  The calling thread, which also takes part in data parallel patterns, is 
+  never bound.
+  \note With pinned scheduling, chunk i of a sequence is always run by 
+  worker i, so that repeated data parallel patterns on a sequence process 
+  every partition in the same processor. Initializing the sequence 
+  with a map on this execution places its memory pages in the NUMA node of 
+  those processors (first touch).
+  */
+  void set_thread_placement(thread_placement placement) {
+    placement_ = placement;
+    pool_.reset();
+    pool_ = make_pool();
+  }
+
+  /**
+  \brief Get the placement of the worker threads.
+  */
+  thread_placement placement() const noexcept { return placement_; }
+
   /**
   \brief Get a manager object for registration/deregistration in the
   thread index table for current thread.
@@ -208,18 +423,52 @@ public:
 
   /**
   \brief Get index of current thread in the thread table
-  \pre The current thread is currently registered.
+  \note Workers take indices from 0 and the calling thread of a data parallel
+  pattern takes the next free one. Any other thread takes a free index at its
+  first call and keeps it until it finishes.
   */
-  int get_thread_id() const noexcept {
+  int get_thread_id() const {
     return thread_registry_.current_index();
   }
+
+  /**
+  \brief Makes a scratch storage with one lazily created instance of T per 
+  thread.
+  Instances are indexed by get_thread_id(), so that they are reused across
+  patterns and relaunches of the worker pool. Threads running patterns 
+  concurrently always get different instances.
+  \pre The execution policy outlives the storage.
+  \tparam T Type of the per thread instances.
+  \param init_op Callable object returning the initial value of an instance.
+  By default, instances are value initialized.
+  \return A storage whose member local() returns the instance of the 
+  calling thread, and whose member for_each() visits all the instances.
+  */
+  template <typename T, typename Initializer>
+  auto thread_local_storage(Initializer && init_op) const {
+    return per_thread_storage<T, std::function<int()>>{
+        std::forward<Initializer>(init_op), 
+        [this]() { return get_thread_id(); }, 
+        concurrency_degree_};
+  }
+
+  template <typename T>
+  auto thread_local_storage() const {
+    return thread_local_storage<T>([]() { return T{}; });
+  }
   
   /**
   \brief Sets the attributes for the queues built through make_queue<T>()
+  \param size Capacity of the queues.
+  \param mode Queue mode (blocking or lock-free).
+  \param batch Number of items transferred at once between pipeline stages.
+  \note Stages flush their partial batches before waiting for new input and
+  at the end of the stream, so batching does not change the results.
   */
-  void set_queue_attributes(int size, queue_mode mode) noexcept {
+  void set_queue_attributes(int size, queue_mode mode, int batch = 1) noexcept {
     queue_size_ = size;
     queue_mode_ = mode;
+    queue_batch_ = batch;
   }
 
   /**
@@ -235,7 +484,7 @@ public:
 
   /**
   \brief Applies a trasnformation to multiple sequences leaving the result in
-  another sequence by chunks according to concurrency degree.
+  another sequence by chunks according to the scheduling mode.
   \tparam InputIterators Iterator types for input sequences.
   \tparam OutputIterator Iterator type for the output sequence.
   \tparam Transformer Callable object type for the transformation.
@@ -290,6 +539,28 @@ public:
                   Identity && identity,
                   Transformer && transform_op, Combiner && combine_op) const;
 
+  /**
+  \brief Applies a scan (prefix combination) to a sequence of data items.
+  \tparam InputIterator Iterator type for the input sequence.
+  \tparam OutputIterator Iterator type for the output sequence.
+  \tparam Identity Type for the identity value.
+  \tparam Combiner Callable object type for the combination.
+  \param first Iterator to the first element of the sequence.
+  \param first_out Iterator to the first element of the output sequence.
+  \param sequence_size Size of the input sequence.
+  \param identity Identity value for the combination.
+  \param combine_op Associative combination callable object.
+  \param mode Inclusive or exclusive scan.
+  \pre Iterators in the ranges `[first, next(first,sequence_size))` and
+  `[first_out, next(first_out,sequence_size))` are valid. 
+  \return The combination of the identity and all the elements.
+  */
+  template <typename InputIterator, typename OutputIterator, 
+            typename Identity, typename Combiner>
+  auto scan(InputIterator first, OutputIterator first_out, 
+            std::size_t sequence_size, Identity && identity, 
+            Combiner && combine_op, scan_mode mode) const;
+
   /**
   \brief Applies a stencil to multiple sequences leaving the result in
   another sequence.
@@ -313,6 +584,28 @@ public:
                StencilTransformer && transform_op,
                Neighbourhood && neighbour_op) const;
 
+  /**
+  \brief Applies a number of time steps of a stencil to a multi-dimensional 
+  grid leaving the result in another grid.
+  \tparam InputIt Random access iterator type for the input grid.
+  \tparam OutputIt Random access iterator type for the output grid.
+  \tparam D Number of dimensions of the grid.
+  \tparam StencilTransformer Callable object type for the stencil 
+  transformation.
+  \param shape Shape of the grid.
+  \param first Iterator to the first element of the input grid.
+  \param first_out Iterator to the first element of the output grid.
+  \param num_steps Number of time steps computed per tile without 
+  synchronization.
+  \param transform_op Stencil transformation callable object invoked with a
+  grid_neighbourhood.
+  */
+  template <typename InputIt, typename OutputIt, std::size_t D,
+            typename StencilTransformer>
+  void stencil(const grid_shape<D> & shape, InputIt first, 
+               OutputIt first_out, std::size_t num_steps,
+               StencilTransformer && transform_op) const;
+
   /**
   \brief Invoke \ref md_divide-conquer.
   \tparam Input Type used for the input problem.
@@ -324,6 +617,9 @@ public:
   \param divider_op Divider operation.
   \param solver_op Solver operation.
   \param combine_op Combiner operation.
+  \note Without a base case predicate, subproblems are only run as tasks in 
+  the first levels of the division, which give every thread a few 
+  subproblems. Deeper levels are solved sequentially.
   */
   template <typename Input, typename Divider, typename Solver, typename Combiner>
   auto divide_conquer(Input && input, 
@@ -331,6 +627,29 @@ public:
                       Solver && solve_op, 
                       Combiner && combine_op) const; 
 
+  /**
+  \brief Invoke \ref md_divide-conquer with a base case predicate.
+  Subproblems are run as tasks in the worker pool. Idle workers steal pending 
+  subproblems, so that unbalanced problem trees keep all the workers busy.
+  \tparam Input Type used for the input problem.
+  \tparam Divider Callable type for the divider operation.
+  \tparam Predicate Callable type for the base case predicate.
+  \tparam Solver Callable type for the solver operation.
+  \tparam Combiner Callable type for the combiner operation.
+  \param input Input problem to be solved.
+  \param divider_op Divider operation.
+  \param predicate_op Base case predicate operation.
+  \param solver_op Solver operation.
+  \param combine_op Combiner operation.
+  */
+  template <typename Input, typename Divider, typename Predicate, 
+            typename Solver, typename Combiner>
+  auto divide_conquer(Input && input, 
+                      Divider && divide_op, 
+                      Predicate && predicate_op,
+                      Solver && solve_op, 
+                      Combiner && combine_op) const; 
+
   /**
   \brief Invoke \ref md_pipeline.
   \tparam Generator Callable type for the generator operation.
@@ -344,12 +663,14 @@ public:
 
 private:
 
-  template <typename Input, typename Divider, typename Solver, typename Combiner>
-  auto divide_conquer(Input && input, 
-                      Divider && divide_op, 
-                      Solver && solve_op, 
-                      Combiner && combine_op,
-                      std::atomic<int> & num_threads) const; 
+  template <typename Input, typename Divider, typename Predicate, 
+            typename Solver, typename Combiner>
+  auto divide_conquer_tasks(Input && input, 
+                            Divider && divide_op, 
+                            Predicate && predicate_op,
+                            Solver && solve_op, 
+                            Combiner && combine_op,
+                            int max_depth) const; 
 
   template <typename Queue, typename Consumer,
             requires_no_pattern<Consumer> = 0>
@@ -504,8 +825,73 @@ private:
       std::tuple<Transformers...> && transform_ops,
       std::index_sequence<I...>) const;
 
+  /**
+  \brief Makes the queue connecting a single producer thread with a sequence 
+  of stages.
+  A single-producer/single-consumer queue is used when the first of the 
+  stages reads its input from a single thread. Otherwise, a
+  multiple-producer/multiple-consumer queue is used.
+  \tparam T Element type for the queue.
+  \tparam Stages Types of the stages consuming from the queue.
+  */
+  template <typename T, typename ... Stages>
+  auto make_stage_queue() const {
+    using queue_type = std::conditional_t<has_single_consumer<Stages...>,
+        spsc_queue<T>, mpmc_queue<T>>;
+    return queue_type{queue_size_, queue_mode_};
+  }
+
+  /**
+  \brief Processes all the chunks of a partition in the worker pool.
+  In fixed mode every chunk but the last is run as a separate task and the 
+  calling thread processes the last one. In pinned mode those tasks are 
+  pinned to the worker with their index. Consequently, chunk i of a sequence
+  of a given size is always processed by the same thread, keeping its data in
+  the caches of that thread across successive patterns. In the other modes 
+  the pool workers and the calling thread claim chunks until all of them are
+  processed.
+  \param chunks Partition of the sequence.
+  \param process_chunk Callable invoked with the first position, the size 
+  and the index of every chunk.
+  */
+  template <typename ChunkProcessor>
+  void for_each_chunk(chunk_scheduler & chunks, 
+                      ChunkProcessor && process_chunk) const;
+
+  /**
+  \brief Combines in order the partial results of a reduction.
+  When parallel combination is enabled, every level of a pairwise 
+  combination tree is run as tasks in the worker pool.
+  \param partials Partial results. Their values are consumed.
+  \param combine_op Combination callable object.
+  \pre partials is not empty.
+  \return The combination of all the partial results.
+  */
+  template <typename Result, typename Combiner>
+  Result combine_partials(cache_aligned_vector<Result> & partials, 
+                          Combiner && combine_op) const;
+
+  /**
+  \brief Creates the pool of workers used by data parallel patterns.
+  The calling thread always takes part in data parallel patterns, so the pool
+  has one worker less than the concurrency degree. Every worker binds itself
+  to its processors according to the thread placement.
+  */
+  std::unique_ptr<work_stealing_pool> make_pool() const {
+    const int num_workers = concurrency_degree_ - 1;
+    auto cpus = (placement_ == thread_placement::none) ?
+        std::vector<std::vector<int>>(std::max(num_workers, 0)) :
+        cpu_topology{}.placement(placement_, num_workers);
+    // Workers keep a copy of the registry, as the policy may be moved
+    return std::make_unique<work_stealing_pool>(num_workers,
+        [registry = thread_registry_, cpus](int index) { 
+          bind_current_thread(cpus[index]);
+          return native_thread_manager{registry}; 
+        });
+  }
+
 private: 
-  mutable thread_registry thread_registry_;
+  thread_registry thread_registry_;
 
   int concurrency_degree_;
   bool ordering_;
@@ -514,6 +900,17 @@ private:
   int queue_size_ = default_queue_size;
 
   queue_mode queue_mode_ = queue_mode::blocking;
+
+  int queue_batch_ = 1;
+
+  scheduling_mode scheduling_ = scheduling_mode::fixed;
+  std::size_t grain_ = 0;
+
+  bool parallel_combine_ = false;
+
+  thread_placement placement_ = thread_placement::none;
+
+  std::unique_ptr<work_stealing_pool> pool_;
 };
 
 /**
@@ -553,6 +950,13 @@ constexpr bool supports_reduce<parallel_execution_native>() { return true; }
 template <>
 constexpr bool supports_map_reduce<parallel_execution_native>() { return true; }
 
+/**
+\brief Determines if an execution policy supports the scan pattern.
+\note Specialization for parallel_execution_native.
+*/
+template <>
+constexpr bool supports_scan<parallel_execution_native>() { return true; }
+
 /**
 \brief Determines if an execution policy supports the stencil pattern.
 \note Specialization for parallel_execution_native.
@@ -574,6 +978,34 @@ constexpr bool supports_divide_conquer<parallel_execution_native>() { return tru
 template <>
 constexpr bool supports_pipeline<parallel_execution_native>() { return true; }
 
+template <typename Result, typename Combiner>
+Result parallel_execution_native::combine_partials(
+    cache_aligned_vector<Result> & partials, 
+    Combiner && combine_op) const
+{
+  if (parallel_combine_) {
+    auto manager = thread_manager();
+    const auto size = partials.size();
+    for (std::size_t stride=1; stride<size; stride*=2) {
+      task_group tasks{*pool_};
+      for (std::size_t i=0; i+stride<size; i+=2*stride) {
+        tasks.run([&partials,&combine_op,i,stride]() {
+          partials[i].value = combine_op(partials[i].value, 
+              partials[i+stride].value);
+        });
+      }
+      tasks.wait();
+    }
+    return std::move(partials[0].value);
+  }
+
+  auto result = std::move(partials[0].value);
+  for (std::size_t i=1; i<partials.size(); ++i) {
+    result = combine_op(result, partials[i].value);
+  }
+  return result;
+}
+
 template <typename ... InputIterators, typename OutputIterator, 
           typename Transformer>
 void parallel_execution_native::map(
@@ -581,34 +1013,13 @@ void parallel_execution_native::map(
     OutputIterator first_out, 
     std::size_t sequence_size, Transformer transform_op) const
 {
-  using namespace std;
-
-  auto process_chunk =
-    [&transform_op](auto fins, std::size_t size, auto fout)
-  {
-    const auto l = next(get<0>(fins), size);
-    while (get<0>(fins)!=l) {
-      *fout++ = apply_deref_increment(
-          std::forward<Transformer>(transform_op), fins);
-    }
-  };
-
-  const int chunk_size = sequence_size / concurrency_degree_;
-  
-  {
-    worker_pool workers{concurrency_degree_};
-    for (int i=0; i!=concurrency_degree_-1; ++i) {
-      const auto delta = chunk_size * i;
-      const auto chunk_firsts = iterators_next(firsts,delta);
-      const auto chunk_first_out = next(first_out, delta);
-      workers.launch(*this, process_chunk, chunk_firsts, chunk_size, chunk_first_out);
-    }
-
-    const auto delta = chunk_size * (concurrency_degree_ - 1);
-    const auto chunk_firsts = iterators_next(firsts,delta);
-    const auto chunk_first_out = next(first_out, delta);
-    process_chunk(chunk_firsts, sequence_size - delta, chunk_first_out);
-  } // Pool synch
+  constexpr sequential_execution seq;
+  chunk_scheduler chunks{scheduling_, sequence_size, 
+      concurrency_degree_, grain_};
+  for_each_chunk(chunks, [&](std::size_t first, std::size_t size, std::size_t) {
+    seq.map(iterators_next(firsts, first), std::next(first_out, first), size, 
+        transform_op);
+  });
 }
 
 template <typename InputIterator, typename Identity, typename Combiner>
@@ -618,32 +1029,20 @@ auto parallel_execution_native::reduce(
     Combiner && combine_op) const
 {
   using result_type = std::decay_t<Identity>;
-  std::vector<result_type> partial_results(concurrency_degree_);
+  chunk_scheduler chunks{scheduling_, sequence_size, 
+      concurrency_degree_, grain_};
+  cache_aligned_vector<result_type> partial_results(chunks.num_chunks());
 
   constexpr sequential_execution seq;
-  auto process_chunk = [&](InputIterator f, std::size_t sz, std::size_t id) {
-    partial_results[id] = seq.reduce(f,sz, std::forward<Identity>(identity), 
+  auto process_chunk = [&](std::size_t f, std::size_t sz, std::size_t id) {
+    // Accumulate locally and write the partial result once
+    partial_results[id].value = seq.reduce(std::next(first,f), sz, 
+        std::forward<Identity>(identity), 
         std::forward<Combiner>(combine_op));
   };
+  for_each_chunk(chunks, process_chunk);
 
-  const auto chunk_size = sequence_size / concurrency_degree_;
-
-  { 
-    worker_pool workers{concurrency_degree_};
-    for (int i=0; i<concurrency_degree_-1; ++i) {
-      const auto delta = chunk_size * i;
-      const auto chunk_first = std::next(first,delta);
-      workers.launch(*this, process_chunk, chunk_first, chunk_size, i);
-    }
-
-    const auto delta = chunk_size * (concurrency_degree_-1);
-    const auto chunk_first = std::next(first, delta);
-    const auto chunk_sz = sequence_size - delta;
-    process_chunk(chunk_first, chunk_sz, concurrency_degree_-1);
-  } // Pool synch
-
-  return seq.reduce(std::next(partial_results.begin()), 
-      partial_results.size()-1, std::forward<result_type>(partial_results[0]), 
+  return combine_partials(partial_results, 
       std::forward<Combiner>(combine_op));
 }
 
@@ -656,34 +1055,73 @@ auto parallel_execution_native::map_reduce(
     Transformer && transform_op, Combiner && combine_op) const
 {
   using result_type = std::decay_t<Identity>;
-  std::vector<result_type> partial_results(concurrency_degree_);
+  chunk_scheduler chunks{scheduling_, sequence_size, 
+      concurrency_degree_, grain_};
+  cache_aligned_vector<result_type> partial_results(chunks.num_chunks());
 
   constexpr sequential_execution seq;
-  auto process_chunk = [&](auto f, std::size_t sz, std::size_t id) {
-    partial_results[id] = seq.map_reduce(f, sz,
-        std::forward<Identity>(partial_results[id]), 
+  auto process_chunk = [&](std::size_t f, std::size_t sz, std::size_t id) {
+    // Accumulate locally and write the partial result once
+    partial_results[id].value = seq.map_reduce(iterators_next(firsts,f), sz,
+        identity, 
         std::forward<Transformer>(transform_op), 
         std::forward<Combiner>(combine_op));
   };
+  for_each_chunk(chunks, process_chunk);
 
-  const auto chunk_size = sequence_size / concurrency_degree_;
+  return combine_partials(partial_results, 
+      std::forward<Combiner>(combine_op));
+}
 
-  {
-    worker_pool workers{concurrency_degree_};
-    for(int i=0;i<concurrency_degree_-1;++i){    
-      const auto delta = chunk_size * i;
-      const auto chunk_firsts = iterators_next(firsts,delta);
-      workers.launch(*this, process_chunk, chunk_firsts, chunk_size, i);
+template <typename InputIterator, typename OutputIterator, 
+          typename Identity, typename Combiner>
+auto parallel_execution_native::scan(
+    InputIterator first, OutputIterator first_out,
+    std::size_t sequence_size,
+    Identity && identity,
+    Combiner && combine_op,
+    scan_mode mode) const
+{
+  constexpr sequential_execution seq;
+
+  using result_type = std::decay_t<Identity>;
+  chunk_scheduler chunks{scheduling_, sequence_size, 
+      concurrency_degree_, grain_};
+  const auto num_chunks = chunks.num_chunks();
+  if (num_chunks == 1) {
+    return seq.scan(first, first_out, sequence_size, identity, combine_op, 
+        mode);
+  }
+
+  // First pass: reduce every chunk but the last one
+  cache_aligned_vector<result_type> prefixes(num_chunks);
+  for_each_chunk(chunks, [&](std::size_t f, std::size_t sz, std::size_t id) {
+    if (id+1 < num_chunks) {
+      prefixes[id].value = seq.reduce(std::next(first,f), sz, identity, 
+          combine_op);
     }
+  });
 
-    const auto delta = chunk_size * (concurrency_degree_-1);
-    const auto chunk_firsts = iterators_next(firsts, delta);
-    process_chunk(chunk_firsts, sequence_size - delta, concurrency_degree_-1);
-  } // Pool synch
+  // Turn chunk results into the prefix of every chunk
+  result_type prefix{identity};
+  for (std::size_t id=0; id<num_chunks; ++id) {
+    auto next = (id+1 < num_chunks) ? 
+        combine_op(prefix, prefixes[id].value) : prefix;
+    prefixes[id].value = std::move(prefix);
+    prefix = std::move(next);
+  }
 
-  return seq.reduce(std::next(partial_results.begin()), 
-     partial_results.size()-1, std::forward<result_type>(partial_results[0]), 
-     std::forward<Combiner>(combine_op));
+  // Second pass: scan every chunk starting from its prefix
+  chunk_scheduler final_chunks{scheduling_, sequence_size, 
+      concurrency_degree_, grain_};
+  result_type total{identity};
+  for_each_chunk(final_chunks, 
+      [&](std::size_t f, std::size_t sz, std::size_t id) {
+    auto result = seq.scan(std::next(first,f), std::next(first_out,f), sz, 
+        prefixes[id].value, combine_op, mode);
+    if (id+1 == num_chunks) total = std::move(result);
+  });
+  return total;
 }
 
 template <typename ... InputIterators, typename OutputIterator,
@@ -703,22 +1141,71 @@ void parallel_execution_native::stencil(
       std::forward<Neighbourhood>(neighbour_op));
   };
 
-  const auto chunk_size = sequence_size / concurrency_degree_;
-  {
-    worker_pool workers{concurrency_degree_};
+  chunk_scheduler chunks{scheduling_, sequence_size, 
+      concurrency_degree_, grain_};
+  for_each_chunk(chunks, [&](std::size_t first, std::size_t size, std::size_t) {
+    process_chunk(iterators_next(firsts,first), size, 
+        std::next(first_out,first));
+  });
+}
+
+template <typename InputIt, typename OutputIt, std::size_t D,
+          typename StencilTransformer>
+void parallel_execution_native::stencil(
+    const grid_shape<D> & shape, 
+    InputIt first, OutputIt first_out, 
+    std::size_t num_steps,
+    StencilTransformer && transform_op) const
+{
+  grid_tiling<D> tiling{shape};
+  chunk_scheduler chunks{scheduling_, tiling.num_tiles(), 
+      concurrency_degree_, grain_};
+  for_each_chunk(chunks, [&](std::size_t f, std::size_t sz, std::size_t) {
+    grid_stencil_tiles(shape, tiling, first, first_out, num_steps,
+        transform_op, f, f+sz);
+  });
+}
 
-    for (int i=0; i!=concurrency_degree_-1; ++i) {
-      const auto delta = chunk_size * i;
-      const auto chunk_firsts = iterators_next(firsts,delta);
-      const auto chunk_out = std::next(first_out,delta);
-      workers.launch(*this, process_chunk, chunk_firsts, chunk_size, chunk_out);
+template <typename ChunkProcessor>
+void parallel_execution_native::for_each_chunk(
+    chunk_scheduler & chunks, 
+    ChunkProcessor && process_chunk) const
+{
+  auto manager = thread_manager();
+  const auto num_chunks = chunks.num_chunks();
+  task_group tasks{*pool_};
+
+  if (chunks.mode() == scheduling_mode::fixed || 
+      chunks.mode() == scheduling_mode::pinned) {
+    for (std::size_t i=0; i+1<num_chunks; ++i) {
+      auto task = [&chunks,&process_chunk,i]() {
+        process_chunk(chunks.chunk_begin(i), chunks.chunk_size(i), i);
+      };
+      // Chunk i is always run by worker i to keep its data in place
+      if (chunks.mode() == scheduling_mode::pinned) {
+        tasks.run_on(static_cast<int>(i), task);
+      }
+      else {
+        tasks.run(task);
+      }
     }
+    const auto last = num_chunks - 1;
+    process_chunk(chunks.chunk_begin(last), chunks.chunk_size(last), last);
+    tasks.wait();
+    return;
+  }
 
-    const auto delta = chunk_size * (concurrency_degree_ - 1);
-    const auto chunk_firsts = iterators_next(firsts,delta);
-    const auto chunk_out = std::next(first_out,delta);
-    process_chunk(chunk_firsts, sequence_size - delta, chunk_out);
-  } // Pool synch
+  auto claim_chunks = [&chunks,&process_chunk]() {
+    std::size_t i;
+    while (chunks.claim(i)) {
+      process_chunk(chunks.chunk_begin(i), chunks.chunk_size(i), i);
+    }
+  };
+  const auto num_tasks = std::min<std::size_t>(concurrency_degree_-1, 
+      num_chunks-1);
+  for (std::size_t i=0; i<num_tasks; ++i) { tasks.run(claim_chunks); }
+  claim_chunks();
+  tasks.wait();
 }
 
 template <typename Input, typename Divider, typename Solver, typename Combiner>
@@ -728,11 +1215,81 @@ auto parallel_execution_native::divide_conquer(
     Solver && solve_op, 
     Combiner && combine_op) const
 {
-  std::atomic<int> num_threads{concurrency_degree_-1};
+  // Binary divisions reach about four subproblems per thread
+  int max_depth = 2;
+  for (int n=1; n<concurrency_degree_; n*=2) { max_depth++; }
+  return divide_conquer_tasks(std::forward<Input>(problem), 
+        std::forward<Divider>(divide_op), 
+        [](auto &&) { return false; },
+        std::forward<Solver>(solve_op), std::forward<Combiner>(combine_op),
+        max_depth);
+}
 
-  return divide_conquer(std::forward<Input>(problem), std::forward<Divider>(divide_op), 
+template <typename Input, typename Divider, typename Predicate, 
+          typename Solver, typename Combiner>
+auto parallel_execution_native::divide_conquer(
+    Input && input, 
+    Divider && divide_op, 
+    Predicate && predicate_op,
+    Solver && solve_op, 
+    Combiner && combine_op) const
+{
+  return divide_conquer_tasks(std::forward<Input>(input), 
+        std::forward<Divider>(divide_op), 
+        std::forward<Predicate>(predicate_op), 
         std::forward<Solver>(solve_op), std::forward<Combiner>(combine_op),
-        num_threads);
+        std::numeric_limits<int>::max());
+}
+
+template <typename Input, typename Divider, typename Predicate, 
+          typename Solver, typename Combiner>
+auto parallel_execution_native::divide_conquer_tasks(
+    Input && input, 
+    Divider && divide_op, 
+    Predicate && predicate_op,
+    Solver && solve_op, 
+    Combiner && combine_op,
+    int max_depth) const
+{
+  constexpr sequential_execution seq;
+  if (max_depth <= 0) {
+    return seq.divide_conquer(std::forward<Input>(input), 
+        std::forward<Divider>(divide_op), 
+        std::forward<Predicate>(predicate_op), 
+        std::forward<Solver>(solve_op), std::forward<Combiner>(combine_op));
+  }
+  if (predicate_op(input)) { return solve_op(std::forward<Input>(input)); }
+  auto subproblems = divide_op(std::forward<Input>(input));
+  if (subproblems.size()<=1) { return solve_op(std::forward<Input>(input)); }
+
+  using subresult_type = 
+      std::decay_t<typename std::result_of<Solver(Input)>::type>;
+  std::vector<subresult_type> partials(subproblems.size()-1);
+
+  auto manager = thread_manager();
+  task_group tasks{*pool_};
+  for (std::size_t i=1; i<subproblems.size(); ++i) {
+    tasks.run([&,i]() {
+      partials[i-1] = this->divide_conquer_tasks(
+          std::forward<Input>(subproblems[i]), 
+          std::forward<Divider>(divide_op), 
+          std::forward<Predicate>(predicate_op), 
+          std::forward<Solver>(solve_op), 
+          std::forward<Combiner>(combine_op), max_depth-1);
+    });
+  }
+
+  // Calling thread works on the first subproblem
+  auto subresult = divide_conquer_tasks(std::forward<Input>(subproblems[0]), 
+      std::forward<Divider>(divide_op), 
+      std::forward<Predicate>(predicate_op), 
+      std::forward<Solver>(solve_op), 
+      std::forward<Combiner>(combine_op), max_depth-1);
+  tasks.wait();
+
+  return seq.reduce(partials.begin(), partials.size(), 
+      std::forward<subresult_type>(subresult), 
+      std::forward<Combiner>(combine_op));
 }
 
 template <typename Generator, typename ... Transformers>
@@ -743,18 +1300,20 @@ void parallel_execution_native::pipeline(
   using namespace std;
   using result_type = decay_t<typename result_of<Generator()>::type>;
   using output_type = pair<result_type,long>;
-  auto output_queue = make_queue<output_type>();
+  auto output_queue = make_stage_queue<output_type, Transformers...>();
 
   thread generator_task([&,this]() {
     auto manager = thread_manager();
+    auto output = make_queue_writer(output_queue, queue_batch_);
 
     long order = 0;
     for (;;) {
       auto item{generate_op()};
-      output_queue.push(make_pair(item, order));
+      output.push(make_pair(item, order));
       order++;
       if (!item) break;
     }
+    output.flush();
   });
 
   do_pipeline(output_queue, forward<Transformers>(transform_ops)...);
@@ -763,59 +1322,6 @@ void parallel_execution_native::pipeline(
 
 // PRIVATE MEMBERS
 
-template <typename Input, typename Divider, typename Solver, typename Combiner>
-auto parallel_execution_native::divide_conquer(
-    Input && input, 
-    Divider && divide_op, 
-    Solver && solve_op, 
-    Combiner && combine_op,
-    std::atomic<int> & num_threads) const
-{
-  constexpr sequential_execution seq;
-  if (num_threads.load() <=0) {
-    return seq.divide_conquer(std::forward<Input>(input), 
-        std::forward<Divider>(divide_op), std::forward<Solver>(solve_op), 
-        std::forward<Combiner>(combine_op));
-  }
-
-  auto subproblems = divide_op(std::forward<Input>(input));
-  if (subproblems.size()<=1) { return solve_op(std::forward<Input>(input)); }
-
-  using subresult_type = 
-      std::decay_t<typename std::result_of<Solver(Input)>::type>;
-  std::vector<subresult_type> partials(subproblems.size()-1);
-
-  auto process_subproblem = [&,this](auto it, std::size_t div) {
-    partials[div] = this->divide_conquer(std::forward<Input>(*it), 
-        std::forward<Divider>(divide_op), std::forward<Solver>(solve_op), 
-        std::forward<Combiner>(combine_op), num_threads);
-  };
-
-  int division = 0;
-
-  worker_pool workers{num_threads.load()};
-  auto i = subproblems.begin() + 1;
-  while (i!=subproblems.end() && num_threads.load()>0) {
-    workers.launch(*this,process_subproblem, i++, division++);
-    num_threads--;
-  }
-
-  while (i!=subproblems.end()) {
-    partials[division] = seq.divide_conquer(std::forward<Input>(*i++), 
-        std::forward<Divider>(divide_op), std::forward<Solver>(solve_op), 
-        std::forward<Combiner>(combine_op));
-  }
-
-  auto subresult = divide_conquer(std::forward<Input>(*subproblems.begin()), 
-      std::forward<Divider>(divide_op), std::forward<Solver>(solve_op), 
-      std::forward<Combiner>(combine_op), num_threads);
-
-  workers.wait();
-
-  return seq.reduce(partials.begin(), partials.size(), 
-      std::forward<subresult_type>(subresult), std::forward<Combiner>(combine_op));
-}
-
 template <typename Queue, typename Consumer,
           requires_no_pattern<Consumer> = 0>
 void parallel_execution_native::do_pipeline(
@@ -827,48 +1333,24 @@ void parallel_execution_native::do_pipeline(
   using input_value_type = typename input_type::first_type;
 
   auto manager = thread_manager();
+  auto input = make_queue_reader(input_queue, queue_batch_);
 
   if (!is_ordered()) {
     for (;;) {
-      auto item = input_queue.pop();
+      auto item = input.pop();
       if (!item.first) break;
       consume_op(*item.first);
     }
     return;
   }
-  vector<input_type> elements;
-  long current = 0;
+  reorder_buffer<input_type> elements;
+  auto consume_item = [&](input_type && item) { consume_op(*item.first); };
   for (;;) {
-    auto item = input_queue.pop();
+    auto item = input.pop();
     if (!item.first) break;
-    if(current == item.second){
-      consume_op(*item.first);
-      current ++;
-    }
-    else {
-      elements.push_back(item);
-    }
-    // TODO: Probably find_if() + erase 
-    for (auto it=elements.begin(); it!=elements.end(); it++) {
-      if(it->second == current) {
-        consume_op(*it->first);
-        elements.erase(it);
-        current++;
-        break;
-      }
-    }
-  }
-  while (elements.size()>0) {
-    // TODO: Probably find_if() + erase
-    for (auto it = elements.begin(); it != elements.end(); it++) {
-      if(it->second == current) {
-        consume_op(*it->first);
-        elements.erase(it);
-        current++;
-        break;
-      }
-    }
+    elements.push(std::move(item), consume_item);
   }
+  elements.flush(consume_item);
 }
 
 template <typename Queue, typename Transformer, 
@@ -888,19 +1370,22 @@ void parallel_execution_native::do_pipeline(
       decay_t<typename result_of<Transformer(input_item_value_type)>::type>;
   using output_item_value_type = optional<transform_result_type>;
   using output_item_type = pair<output_item_value_type,long>;
-  auto output_queue = make_queue<output_item_type>();
+  auto output_queue = 
+      make_stage_queue<output_item_type, OtherTransformers...>();
 
   thread task([&,this]() {
     auto manager = thread_manager();
+    auto input = make_queue_reader(input_queue, queue_batch_);
+    auto output = make_queue_writer(output_queue, queue_batch_);
 
-    long order = 0;
     for (;;) {
-      auto item{input_queue.pop()};
+      auto item{input.pop(output)};
       if (!item.first) break;
       auto out = output_item_value_type{transform_op(*item.first)};
-      output_queue.push(make_pair(out, item.second));
+      output.push(make_pair(out, item.second));
     }
-    output_queue.push(make_pair(output_item_value_type{},-1));
+    output.push(make_pair(output_item_value_type{},-1));
+    output.flush();
   });
 
   do_pipeline(output_queue, 
@@ -961,13 +1446,16 @@ void parallel_execution_native::do_pipeline(
   auto output_queue = make_queue<output_item_type>();
   atomic<int> done_threads{0};
   auto farm_task = [&](int nt) {
-    long order = 0;
-    auto item{input_queue.pop()}; 
+    // Workers share the input queue, so items are taken one at a time
+    auto input = make_queue_reader(input_queue, 1);
+    auto output = make_queue_writer(output_queue, queue_batch_);
+    auto item{input.pop(output)}; 
     while (item.first) {
       auto out = output_item_value_type{farm_obj(*item.first)};
-      output_queue.push(make_pair(out,item.second)) ;
-      item = input_queue.pop(); 
+      output.push(make_pair(out,item.second)) ;
+      item = input.pop(output); 
     }
+    output.flush();
     input_queue.push(item);
     done_threads++;
     if (done_threads == nt) {
@@ -999,74 +1487,52 @@ void parallel_execution_native::do_pipeline(
 
   using input_item_type = typename Queue::value_type;
   using input_value_type = typename input_item_type::first_type;
-  auto filter_queue = make_queue<input_item_type>();
+  auto filter_queue = 
+      make_stage_queue<input_item_type, OtherTransformers...>();
 
   auto filter_task = [&,this]() {
     auto manager = thread_manager();
-    auto item{input_queue.pop()};
+    auto input = make_queue_reader(input_queue, queue_batch_);
+    auto output = make_queue_writer(filter_queue, queue_batch_);
+    auto item{input.pop(output)};
     while (item.first) {
       if (filter_obj(*item.first)) {
-        filter_queue.push(item);
+        output.push(item);
       }
       else {
-        filter_queue.push(make_pair(input_value_type{}, item.second));
+        output.push(make_pair(input_value_type{}, item.second));
       }
-      item = input_queue.pop();
+      item = input.pop(output);
     }
-    filter_queue.push(make_pair(input_value_type{}, -1));
+    output.push(make_pair(input_value_type{}, -1));
+    output.flush();
   };
   thread filter_thread{filter_task};
 
-  auto output_queue = make_queue<input_item_type>();
+  auto output_queue = 
+      make_stage_queue<input_item_type, OtherTransformers...>();
   thread ordering_thread;
   if (is_ordered()) {
     auto ordering_task = [&]() {
       auto manager = thread_manager();
-      vector<input_item_type> elements;
-      int current = 0;
+      reorder_buffer<input_item_type> elements;
       long order = 0;
-      auto item{filter_queue.pop()};
-      for (;;) {
-        if(!item.first && item.second == -1) break; 
-        if (item.second == current) {
-          if (item.first) {
-            output_queue.push(make_pair(item.first,order));
-            order++;
-          }
-          current++;
-        }
-        else {
-          elements.push_back(item);
-        }
-        // TODO: Probably find_if() + erase 
-        for (auto it=elements.begin(); it<elements.end(); it++) {
-          if (it->second == current) {
-            if (it->first) {
-              output_queue.push(make_pair(it->first,order));
-              order++;
-            }
-            elements.erase(it);
-            current++;
-            break;
-          }
+      auto input = make_queue_reader(filter_queue, queue_batch_);
+      auto output = make_queue_writer(output_queue, queue_batch_);
+      auto forward_item = [&](input_item_type && item) {
+        if (item.first) {
+          output.push(make_pair(std::move(item.first), order));
+          order++;
         }
-        item = filter_queue.pop();
+      };
+      auto item{input.pop(output)};
+      while (item.first || item.second != -1) {
+        elements.push(std::move(item), forward_item);
+        item = input.pop(output);
       }
-      while (elements.size()>0) {
-        // TODO: Probably find_if() + erase 
-        for (auto it=elements.begin(); it<elements.end(); it++) {
-          if (it->second == current) {
-            if(it->first) { 
-              output_queue.push(make_pair(it->first,order));
-              order++;
-            }
-            elements.erase(it);
-            current++;
-            break;
-          }
-        }
-      }
-      output_queue.push(item);
+      elements.flush(forward_item);
+      output.push(item);
+      output.flush();
     };
 
     ordering_thread = thread{ordering_task};
@@ -1096,22 +1562,26 @@ void parallel_execution_native::do_pipeline(
   using input_item_value_type = typename input_item_type::first_type::value_type;
   using output_item_value_type = optional<decay_t<Identity>>;
   using output_item_type = pair<output_item_value_type,long>;
-  auto output_queue = make_queue<output_item_type>();
+  auto output_queue = 
+      make_stage_queue<output_item_type, OtherTransformers...>();
 
   auto reduce_task = [&,this]() {
     auto manager = thread_manager();
-    auto item{input_queue.pop()};
+    auto input = make_queue_reader(input_queue, queue_batch_);
+    auto output = make_queue_writer(output_queue, queue_batch_);
+    auto item{input.pop(output)};
     int order = 0;
     while (item.first) {
       reduce_obj.add_item(std::forward<Identity>(*item.first));
-      item = input_queue.pop();
+      item = input.pop(output);
       if (reduce_obj.reduction_needed()) {
         constexpr sequential_execution seq;
         auto red = reduce_obj.reduce_window(seq);
-        output_queue.push(make_pair(red, order++));
+        output.push(make_pair(red, order++));
       }
     }
-    output_queue.push(make_pair(output_item_value_type{}, -1));
+    output.push(make_pair(output_item_value_type{}, -1));
+    output.flush();
   };
   thread reduce_thread{reduce_task};
   do_pipeline(output_queue, forward<OtherTransformers>(other_transform_ops)...);
@@ -1133,7 +1603,8 @@ void parallel_execution_native::do_pipeline(
 
   using input_item_type = typename decay_t<Queue>::value_type;
   using input_item_value_type = typename input_item_type::first_type::value_type;
-  auto output_queue = make_queue<input_item_type>();
+  auto output_queue = 
+      make_stage_queue<input_item_type, OtherTransformers...>();
 
   auto iteration_task = [&]() {
     for (;;) {
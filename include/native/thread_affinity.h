@@ -0,0 +1,327 @@
+/**
+* @version		GrPPI v0.3
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_NATIVE_THREAD_AFFINITY_H
+#define GRPPI_NATIVE_THREAD_AFFINITY_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <tuple>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace grppi {
+
+/**
+\brief Placement of worker threads on the processors of the machine.
+- none: Threads are not bound and the operating system may migrate them
+(default).
+- compact: Consecutive threads are bound to neighbouring processors, filling
+a NUMA node before using the next one.
+- scatter: Consecutive threads are bound to processors in different NUMA
+nodes and different cores, spreading them across the machine.
+- numa_node: Threads are split in consecutive blocks, one per NUMA node, and
+every thread may run on any processor of its node.
+*/
+enum class thread_placement { none, compact, scatter, numa_node };
+
+/**
+\brief Location of a logical processor in the machine.
+*/
+struct cpu_info {
+  /// Operating system identifier of the processor.
+  int cpu;
+  /// Identifier of the physical core within its package.
+  int core;
+  /// Identifier of the physical package (socket).
+  int package;
+  /// NUMA node holding the processor.
+  int node;
+};
+
+namespace internal {
+
+/**
+\brief Parses a list of processors in the sysfs format (e.g. "0-3,8,10-11").
+*/
+inline std::vector<int> parse_cpu_list(const std::string & list)
+{
+  std::vector<int> result;
+  std::istringstream stream{list};
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range.empty()) continue;
+    const auto dash = range.find('-');
+    try {
+      const int first = std::stoi(range.substr(0, dash));
+      const int last = (dash == std::string::npos) ?
+          first : std::stoi(range.substr(dash+1));
+      for (int i=first; i<=last; ++i) { result.push_back(i); }
+    }
+    catch (...) { return {}; }
+  }
+  return result;
+}
+
+/**
+\brief Reads the first line of a file, or an empty string if it cannot be read.
+*/
+inline std::string read_first_line(const std::string & path)
+{
+  std::ifstream file{path};
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+/**
+\brief Reads an integer from a file, or a default value if it cannot be read.
+*/
+inline int read_int(const std::string & path, int default_value)
+{
+  std::ifstream file{path};
+  int value;
+  return (file >> value) ? value : default_value;
+}
+
+/**
+\brief Keeps the processors in the affinity mask of the calling thread (e.g. 
+restricted by taskset or a cpuset). The list is not changed if the mask 
+cannot be read or has none of the processors.
+*/
+inline std::vector<int> allowed_cpus(std::vector<int> cpus)
+{
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) return cpus;
+  std::vector<int> result;
+  for (auto cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &set)) {
+      result.push_back(cpu);
+    }
+  }
+  return result.empty() ? cpus : result;
+#else
+  return cpus;
+#endif
+}
+
+}
+
+/**
+\brief Topology of the logical processors of the machine.
+On Linux the topology is discovered from sysfs without additional libraries,
+and only the online processors where the calling thread may run are used.
+Otherwise, or if sysfs is not available, all the processors reported by the
+C++ runtime are assumed to be different cores of a single NUMA node.
+*/
+class cpu_topology {
+public:
+
+  /**
+  \brief Discovers the topology of the current machine.
+  */
+  cpu_topology();
+
+  /**
+  \brief Builds a topology from a list of processors.
+  */
+  explicit cpu_topology(std::vector<cpu_info> cpus) : cpus_{std::move(cpus)} {}
+
+  /**
+  \brief Get the logical processors of the machine.
+  */
+  const std::vector<cpu_info> & cpus() const noexcept { return cpus_; }
+
+  /**
+  \brief Get the number of NUMA nodes with processors.
+  */
+  int num_nodes() const;
+
+  /**
+  \brief Computes the processors where each of a number of threads may run.
+  \param mode Placement policy.
+  \param num_threads Number of threads.
+  \return A set of processors for every thread. Sets are empty for
+  thread_placement::none.
+  */
+  std::vector<std::vector<int>> placement(thread_placement mode,
+                                          int num_threads) const;
+
+private:
+  std::vector<int> node_ids() const;
+
+private:
+  std::vector<cpu_info> cpus_;
+};
+
+inline cpu_topology::cpu_topology()
+{
+  const std::string cpu_path = "/sys/devices/system/cpu/";
+  const std::string node_path = "/sys/devices/system/node/";
+
+  auto online = internal::parse_cpu_list(
+      internal::read_first_line(cpu_path + "online"));
+  if (online.empty()) {
+    const int n = static_cast<int>(
+        std::max(1u, std::thread::hardware_concurrency()));
+    for (int i=0; i<n; ++i) { online.push_back(i); }
+  }
+  online = internal::allowed_cpus(std::move(online));
+
+  for (auto cpu : online) {
+    const auto topology = cpu_path + "cpu" + std::to_string(cpu) + "/topology/";
+    cpus_.push_back({cpu,
+        internal::read_int(topology + "core_id", cpu),
+        internal::read_int(topology + "physical_package_id", 0),
+        0});
+  }
+
+  const auto nodes = internal::parse_cpu_list(
+      internal::read_first_line(node_path + "online"));
+  for (auto node : nodes) {
+    const auto node_cpus = internal::parse_cpu_list(internal::read_first_line(
+        node_path + "node" + std::to_string(node) + "/cpulist"));
+    for (auto & info : cpus_) {
+      if (std::find(node_cpus.begin(), node_cpus.end(), info.cpu) !=
+          node_cpus.end()) {
+        info.node = node;
+      }
+    }
+  }
+}
+
+inline std::vector<int> cpu_topology::node_ids() const
+{
+  std::vector<int> result;
+  for (const auto & info : cpus_) { result.push_back(info.node); }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+inline int cpu_topology::num_nodes() const
+{
+  return static_cast<int>(node_ids().size());
+}
+
+inline std::vector<std::vector<int>> cpu_topology::placement(
+    thread_placement mode, int num_threads) const
+{
+  std::vector<std::vector<int>> result(std::max(num_threads, 0));
+  if (mode == thread_placement::none || cpus_.empty()) return result;
+
+  auto by_location = [](const cpu_info & a, const cpu_info & b) {
+    return std::tie(a.node, a.package, a.core, a.cpu) <
+           std::tie(b.node, b.package, b.core, b.cpu);
+  };
+  auto sorted = cpus_;
+  std::sort(sorted.begin(), sorted.end(), by_location);
+  const auto nodes = node_ids();
+
+  switch (mode) {
+    case thread_placement::compact: {
+      for (std::size_t i=0; i<result.size(); ++i) {
+        result[i] = { sorted[i % sorted.size()].cpu };
+      }
+      break;
+    }
+    case thread_placement::scatter: {
+      // Within every node, the first processor of every core comes first and
+      // the hardware thread siblings after them.
+      std::vector<std::vector<int>> per_node(nodes.size());
+      std::vector<int> sibling(sorted.size(), 0);
+      for (std::size_t i=1; i<sorted.size(); ++i) {
+        const auto & a = sorted[i-1];
+        const auto & b = sorted[i];
+        if (a.node == b.node && a.package == b.package && a.core == b.core) {
+          sibling[i] = sibling[i-1] + 1;
+        }
+      }
+      for (int level=0; ; ++level) {
+        bool found = false;
+        for (std::size_t i=0; i<sorted.size(); ++i) {
+          if (sibling[i] != level) continue;
+          const auto n = std::lower_bound(nodes.begin(), nodes.end(),
+              sorted[i].node) - nodes.begin();
+          per_node[n].push_back(sorted[i].cpu);
+          found = true;
+        }
+        if (!found) break;
+      }
+      // Interleave the nodes
+      std::vector<int> order;
+      for (std::size_t k=0; order.size() < sorted.size(); ++k) {
+        for (auto & cpus : per_node) {
+          if (k < cpus.size()) order.push_back(cpus[k]);
+        }
+      }
+      for (std::size_t i=0; i<result.size(); ++i) {
+        result[i] = { order[i % order.size()] };
+      }
+      break;
+    }
+    case thread_placement::numa_node: {
+      for (std::size_t i=0; i<result.size(); ++i) {
+        const auto node = nodes[i * nodes.size() / result.size()];
+        for (const auto & info : sorted) {
+          if (info.node == node) result[i].push_back(info.cpu);
+        }
+      }
+      break;
+    }
+    case thread_placement::none:
+      break;
+  }
+  return result;
+}
+
+/**
+\brief Restricts the calling thread to run on a set of processors.
+\param cpus Identifiers of the processors. An empty set leaves the thread
+unbound.
+\return true if the thread was bound, false otherwise (e.g. when thread
+affinity is not supported by the platform).
+*/
+inline bool bind_current_thread(const std::vector<int> & cpus) noexcept
+{
+  if (cpus.empty()) return false;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (auto cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+}
+
+#endif
@@ -0,0 +1,493 @@
+/**
+* @version		GrPPI v0.3
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_NATIVE_WORK_STEALING_POOL_H
+#define GRPPI_NATIVE_WORK_STEALING_POOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <exception>
+
+namespace grppi {
+
+/**
+\brief Persistent pool of worker threads with work stealing.
+
+Workers are launched once when the pool is constructed and joined when the
+pool is destroyed. Consequently, submitting a task never creates a thread.
+
+Every worker owns a double ended queue of tasks. A worker pushes and pops
+tasks at the back of its own queue and, when it runs out of work, steals
+tasks from the front of the queues of the other workers. Threads which are
+not workers of the pool distribute their tasks in a round-robin fashion.
+
+Additionally, tasks may be pinned to a worker. Pinned tasks are kept in a
+separate queue of their worker, which runs them before any other task, and
+are never stolen.
+
+Idle workers sleep on a condition variable which is only signalled when there
+are sleeping workers.
+*/
+class work_stealing_pool {
+public:
+  using task_type = std::function<void()>;
+
+  /**
+  \brief Creates a pool with a number of workers.
+  \tparam Initializer Callable type for the worker initialization.
+  \param num_workers Number of worker threads.
+  \param init_op Operation invoked by every worker with its index when it is
+  started. The returned object is kept alive until the worker finishes (e.g. 
+  a thread manager).
+  \note The constructor returns once every worker has been initialized.
+  \throw The first exception thrown by init_op, if any. In that case, all the
+  workers are joined before throwing.
+  */
+  template <typename Initializer>
+  work_stealing_pool(int num_workers, Initializer init_op);
+
+  /**
+  \brief Destructs the pool after joining all the workers.
+  \pre No task group is waiting on the pool.
+  */
+  ~work_stealing_pool();
+
+  work_stealing_pool(const work_stealing_pool &) = delete;
+  work_stealing_pool & operator=(const work_stealing_pool &) = delete;
+
+  /**
+  \brief Get the number of workers in the pool.
+  */
+  int num_workers() const noexcept { return static_cast<int>(workers_.size()); }
+
+  /**
+  \brief Submits a task to the pool.
+  When called from a worker of this pool the task is queued in the worker
+  own queue. Otherwise, the target queue is selected in round-robin.
+  \note If the pool has no workers the task is run by the calling thread.
+  */
+  void submit(task_type && task);
+
+  /**
+  \brief Submits a task pinned to a given worker.
+  The task is always run by that worker, even when other workers are idle.
+  Pinning related tasks to the same worker keeps their data in the caches of
+  that worker.
+  \param task Task to be run.
+  \param worker Index of the worker.
+  \pre 0 <= worker < num_workers(), or the pool has no workers.
+  \note If the pool has no workers the task is run by the calling thread.
+  */
+  void submit(task_type && task, int worker);
+
+  /**
+  \brief Runs one of the pending tasks in the calling thread.
+  Tasks run through this function may in turn wait and run other tasks. To
+  bound the stack depth, beyond a maximum nesting level a thread only runs
+  tasks from its own queue and does not steal from other workers.
+  \return true if a task was found and run, false otherwise.
+  */
+  bool try_run_one();
+
+  /**
+  \brief Blocks the calling thread until a condition holds or there are 
+  tasks that it may run.
+  \param condition Callable object returning true when the thread may go on.
+  \note Threads changing the condition must call notify_waiters().
+  */
+  template <typename Condition>
+  void wait_for_work(Condition && condition);
+
+  /**
+  \brief Wakes up the threads blocked in wait_for_work().
+  */
+  void notify_waiters();
+
+private:
+  struct worker_queue {
+    std::mutex mutex;
+    std::deque<task_type> tasks;
+    std::deque<task_type> pinned;
+    std::atomic<int> num_pinned{0};
+    char padding[64]; // Keep queues of different workers in different lines
+  };
+
+  struct worker_context {
+    const work_stealing_pool * pool;
+    int index;
+    int depth; // Nesting level of tasks run while waiting
+  };
+
+  static worker_context & current_worker() noexcept {
+    static thread_local worker_context context{nullptr, -1, 0};
+    return context;
+  }
+
+  /// Maximum nesting level at which a waiting thread steals tasks.
+  constexpr static int max_steal_depth = 32;
+
+  int current_index() const noexcept {
+    const auto & context = current_worker();
+    return (context.pool == this) ? context.index : -1;
+  }
+
+  void worker_loop(int index);
+  void stop() noexcept;
+  bool take_task(int index, task_type & task, bool steal = true);
+
+private:
+  std::unique_ptr<worker_queue[]> queues_;
+  std::vector<std::thread> workers_;
+
+  std::atomic<int> pending_{0};
+  std::atomic<int> sleeping_{0};
+  std::atomic<int> initialized_{0};
+  std::atomic<unsigned> next_queue_{0};
+
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  bool done_ = false;
+
+  std::exception_ptr init_exception_; // Guarded by wake_mutex_
+};
+
+template <typename Initializer>
+work_stealing_pool::work_stealing_pool(int num_workers, Initializer init_op) :
+  queues_{new worker_queue[(num_workers>0) ? num_workers : 1]}
+{
+  try {
+    for (int i=0; i<num_workers; ++i) {
+      workers_.emplace_back([this,i,init_op]() {
+        bool initialized = false;
+        try {
+          auto manager = init_op(i);
+          initialized = true;
+          initialized_++;
+          worker_loop(i);
+        }
+        catch (...) {
+          if (initialized) throw;
+          {
+            std::lock_guard<std::mutex> lock{wake_mutex_};
+            if (!init_exception_) init_exception_ = std::current_exception();
+          }
+          initialized_++;
+        }
+      });
+    }
+  }
+  catch (...) {
+    stop();
+    throw;
+  }
+  while (initialized_.load() < num_workers) { std::this_thread::yield(); }
+  if (init_exception_) {
+    stop();
+    std::rethrow_exception(init_exception_);
+  }
+}
+
+inline work_stealing_pool::~work_stealing_pool()
+{
+  stop();
+}
+
+inline void work_stealing_pool::stop() noexcept
+{
+  {
+    std::lock_guard<std::mutex> lock{wake_mutex_};
+    done_ = true;
+  }
+  wake_.notify_all();
+  for (auto && w : workers_) { 
+    if (w.joinable()) w.join(); 
+  }
+}
+
+inline void work_stealing_pool::submit(task_type && task)
+{
+  if (workers_.empty()) {
+    task();
+    return;
+  }
+  const int self = current_index();
+  const int target = (self >= 0) ? self :
+      static_cast<int>(next_queue_++ % workers_.size());
+  {
+    std::lock_guard<std::mutex> lock{queues_[target].mutex};
+    queues_[target].tasks.push_back(std::move(task));
+  }
+  pending_++;
+  if (sleeping_.load() > 0) {
+    std::lock_guard<std::mutex> lock{wake_mutex_};
+    wake_.notify_one();
+  }
+}
+
+inline void work_stealing_pool::submit(task_type && task, int worker)
+{
+  if (workers_.empty()) {
+    task();
+    return;
+  }
+  auto & queue = queues_[worker];
+  {
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    queue.pinned.push_back(std::move(task));
+  }
+  queue.num_pinned++;
+  if (sleeping_.load() > 0) {
+    std::lock_guard<std::mutex> lock{wake_mutex_};
+    // Only the target worker may run the task
+    wake_.notify_all();
+  }
+}
+
+inline bool work_stealing_pool::try_run_one()
+{
+  auto & context = current_worker();
+  task_type task;
+  if (!take_task(current_index(), task, context.depth < max_steal_depth)) {
+    return false;
+  }
+  context.depth++;
+  task();
+  context.depth--;
+  return true;
+}
+
+template <typename Condition>
+void work_stealing_pool::wait_for_work(Condition && condition)
+{
+  const int index = current_index();
+  std::unique_lock<std::mutex> lock{wake_mutex_};
+  sleeping_++;
+  wake_.wait(lock, [&]() {
+    return condition() || pending_.load() > 0 || 
+        (index >= 0 && queues_[index].num_pinned.load() > 0);
+  });
+  sleeping_--;
+}
+
+inline void work_stealing_pool::notify_waiters()
+{
+  if (sleeping_.load() > 0) {
+    std::lock_guard<std::mutex> lock{wake_mutex_};
+    wake_.notify_all();
+  }
+}
+
+inline bool work_stealing_pool::take_task(int index, task_type & task,
+                                          bool steal)
+{
+  const int n = num_workers();
+  if (index >= 0) {
+    auto & own = queues_[index];
+    std::lock_guard<std::mutex> lock{own.mutex};
+    if (!own.pinned.empty()) {
+      task = std::move(own.pinned.front());
+      own.pinned.pop_front();
+      own.num_pinned--;
+      return true;
+    }
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      pending_--;
+      return true;
+    }
+  }
+  if (!steal) return false;
+
+  const int first = (index >= 0) ? index + 1 : 0;
+  for (int i=0; i<n; ++i) {
+    auto & victim = queues_[(first + i) % n];
+    std::lock_guard<std::mutex> lock{victim.mutex};
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      pending_--;
+      return true;
+    }
+  }
+  return false;
+}
+
+inline void work_stealing_pool::worker_loop(int index)
+{
+  current_worker() = {this, index, 0};
+  auto & own = queues_[index];
+  task_type task;
+  for (;;) {
+    if (take_task(index, task)) {
+      task();
+      task = nullptr;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock{wake_mutex_};
+    sleeping_++;
+    wake_.wait(lock, [this,&own]() { 
+      return pending_.load() > 0 || own.num_pinned.load() > 0 || done_; 
+    });
+    sleeping_--;
+    if (done_ && pending_.load() <= 0 && own.num_pinned.load() <= 0) break;
+  }
+  current_worker() = {nullptr, -1, 0};
+}
+
+/**
+\brief Group of tasks submitted to a work stealing pool which may be waited on.
+
+A thread waiting for the completion of the group runs pending tasks from the
+pool, so that groups may be nested (e.g. a task waiting on its own group)
+without exhausting the workers.
+
+A waiting thread which finds no task to run spins for a bounded number of 
+attempts and then blocks until the group completes or new tasks are 
+submitted.
+
+If a task throws an exception, the task is still accounted as completed and 
+the first exception thrown by the tasks of the group is rethrown by wait().
+*/
+class task_group {
+public:
+  /**
+  \brief Creates an empty group of tasks on a pool.
+  */
+  explicit task_group(work_stealing_pool & pool) noexcept : pool_{pool} {}
+
+  /**
+  \brief Destructs the group after waiting for all its tasks.
+  \note Exceptions thrown by the tasks and not collected by wait() are 
+  discarded.
+  */
+  ~task_group() { wait_tasks(); }
+
+  task_group(const task_group &) = delete;
+  task_group & operator=(const task_group &) = delete;
+
+  /**
+  \brief Runs a callable object as a task of the group.
+  \note If the pool has no workers the task is run by the calling thread.
+  */
+  template <typename F>
+  void run(F && f) {
+    if (pool_.num_workers() == 0) {
+      f();
+      return;
+    }
+    pending_++;
+    pool_.submit([this, f=std::forward<F>(f)]() mutable {
+      run_task(f);
+    });
+  }
+
+  /**
+  \brief Runs a callable object as a task of the group pinned to a given 
+  worker.
+  \param worker Index of the worker. It is taken modulo the number of 
+  workers.
+  \param f Callable object.
+  \note If the pool has no workers the task is run by the calling thread.
+  */
+  template <typename F>
+  void run_on(int worker, F && f) {
+    if (pool_.num_workers() == 0) {
+      f();
+      return;
+    }
+    pending_++;
+    pool_.submit([this, f=std::forward<F>(f)]() mutable {
+      run_task(f);
+    }, worker % pool_.num_workers());
+  }
+
+  /**
+  \brief Waits until all the tasks in the group have been completed.
+  \throw The first exception thrown by a task of the group, if any.
+  */
+  void wait() {
+    wait_tasks();
+    if (exception_) {
+      auto exception = exception_;
+      exception_ = nullptr;
+      std::rethrow_exception(exception);
+    }
+  }
+
+private:
+  /// Marks a task as completed when destroyed, even if the task throws.
+  class completion_guard {
+  public:
+    completion_guard(std::atomic<int> & pending, 
+                     work_stealing_pool & pool) noexcept : 
+      pending_{pending}, pool_{pool} {}
+    // The group may be destroyed as soon as the last task is completed
+    ~completion_guard() { if (--pending_ == 0) pool_.notify_waiters(); }
+  private:
+    std::atomic<int> & pending_;
+    work_stealing_pool & pool_;
+  };
+
+  /// Attempts to find a task before a waiting thread blocks.
+  constexpr static int max_spins = 1024;
+
+  template <typename F>
+  void run_task(F & f) noexcept {
+    completion_guard guard{pending_, pool_};
+    try {
+      f();
+    }
+    catch (...) {
+      std::lock_guard<std::mutex> lock{exception_mutex_};
+      if (!exception_) exception_ = std::current_exception();
+    }
+  }
+
+  void wait_tasks() noexcept {
+    int spins = 0;
+    while (pending_.load() > 0) {
+      if (pool_.try_run_one()) { 
+        spins = 0;
+        continue;
+      }
+      if (++spins < max_spins) continue;
+      pool_.wait_for_work([this]() { return pending_.load() <= 0; });
+      spins = 0;
+    }
+  }
+
+private:
+  work_stealing_pool & pool_;
+  std::atomic<int> pending_{0};
+  std::mutex exception_mutex_;
+  std::exception_ptr exception_;
+};
+
+}
+
+#endif
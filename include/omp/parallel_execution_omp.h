@@ -24,6 +24,13 @@
 #ifdef GRPPI_OMP
 
 #include "../common/mpmc_queue.h"
+#include "../common/queue_batching.h"
+#include "../common/reorder_buffer.h"
+#include "../common/chunk_scheduler.h"
+#include "../common/cache_aligned.h"
+#include "../common/per_thread_storage.h"
+#include "../common/grid_stencil.h"
+#include "../common/scan_mode.h"
 #include "../common/iterator.h"
 #include "../common/execution_traits.h"
 #include "../seq/sequential_execution.h"
@@ -105,12 +112,57 @@ public:
   */
   bool is_ordered() const noexcept { return ordering_; }
 
+  /**
+  \brief Sets the scheduling of data parallel patterns.
+  \param mode Scheduling mode.
+  \param grain Minimum number of elements in a chunk for on demand modes. 
+  A value of 0 lets the implementation select it.
+  */
+  void set_scheduling(scheduling_mode mode, std::size_t grain = 0) noexcept {
+    scheduling_ = mode;
+    grain_ = grain;
+  }
+
+  /**
+  \brief Get the scheduling mode of data parallel patterns.
+  */
+  scheduling_mode scheduling() const noexcept { return scheduling_; }
+
+  /**
+  \brief Get the grain size for on demand scheduling modes.
+  */
+  std::size_t grain_size() const noexcept { return grain_; }
+
+  /**
+  \brief Enable parallel combination of partial results.
+  Partial results of reduce and map_reduce are combined pairwise in a tree
+  whose levels are run in parallel. Useful for expensive combiners.
+  */
+  void enable_parallel_combine() noexcept { parallel_combine_ = true; }
+
+  /**
+  \brief Disable parallel combination of partial results.
+  Partial results are combined in order by the calling thread.
+  */
+  void disable_parallel_combine() noexcept { parallel_combine_ = false; }
+
+  /**
+  \brief Are partial results combined in parallel.
+  */
+  bool is_parallel_combine() const noexcept { return parallel_combine_; }
+
   /**
   \brief Sets the attributes for the queues built through make_queue<T>(()
+  \param size Capacity of the queues.
+  \param mode Queue mode (blocking or lock-free).
+  \param batch Number of items transferred at once between pipeline stages.
+  \note Stages flush their partial batches before waiting for new input and
+  at the end of the stream, so batching does not change the results.
   */
-  void set_queue_attributes(int size, queue_mode mode) noexcept {
+  void set_queue_attributes(int size, queue_mode mode, int batch = 1) noexcept {
     queue_size_ = size;
     queue_mode_ = mode;
+    queue_batch_ = batch;
   }
 
   /**
@@ -126,14 +178,45 @@ public:
 
   /**
   \brief Get index of current thread in the thread table
+  The index is taken from the number of the thread in the outermost OpenMP 
+  team, so that it is also valid inside tasks and nested (inactive) parallel 
+  regions. No parallel region is opened.
+  As in parallel_execution_native, the other threads of the team get indices
+  from 0 and the calling thread gets concurrency_degree()-1. A thread which is
+  not in a parallel region also gets concurrency_degree()-1.
+  \return An index in the range [0, concurrency_degree()).
   */
   int get_thread_id() const noexcept {
-    int result;
-    #pragma omp parallel
-    {
-      result = omp_get_thread_num();
-    }
-    return result;
+    if (omp_get_level() == 0) return concurrency_degree_ - 1;
+    const int thread = omp_get_ancestor_thread_num(1);
+    return (thread > 0) ? thread - 1 : omp_get_team_size(1) - 1;
+  }
+
+  /**
+  \brief Makes a scratch storage with one lazily created instance of T per 
+  thread.
+  Instances are indexed by get_thread_id(), so that they are reused across
+  patterns.
+  \pre The execution policy outlives the storage.
+  \pre The storage is not used by two patterns running concurrently, as 
+  threads of different parallel regions may get the same index.
+  \tparam T Type of the per thread instances.
+  \param init_op Callable object returning the initial value of an instance.
+  By default, instances are value initialized.
+  \return A storage whose member local() returns the instance of the 
+  calling thread, and whose member for_each() visits all the instances.
+  */
+  template <typename T, typename Initializer>
+  auto thread_local_storage(Initializer && init_op) const {
+    return per_thread_storage<T, std::function<int()>>{
+        std::forward<Initializer>(init_op), 
+        [this]() { return get_thread_id(); }, 
+        concurrency_degree_};
+  }
+
+  template <typename T>
+  auto thread_local_storage() const {
+    return thread_local_storage<T>([]() { return T{}; });
   }
 
   /**
@@ -193,6 +276,28 @@ public:
                   Identity && identity,
                   Transformer && transform_op, Combiner && combine_op) const;
 
+  /**
+  \brief Applies a scan (prefix combination) to a sequence of data items.
+  \tparam InputIterator Iterator type for the input sequence.
+  \tparam OutputIterator Iterator type for the output sequence.
+  \tparam Identity Type for the identity value.
+  \tparam Combiner Callable object type for the combination.
+  \param first Iterator to the first element of the sequence.
+  \param first_out Iterator to the first element of the output sequence.
+  \param sequence_size Size of the input sequence.
+  \param identity Identity value for the combination.
+  \param combine_op Associative combination callable object.
+  \param mode Inclusive or exclusive scan.
+  \pre Iterators in the ranges `[first, next(first,sequence_size))` and
+  `[first_out, next(first_out,sequence_size))` are valid. 
+  \return The combination of the identity and all the elements.
+  */
+  template <typename InputIterator, typename OutputIterator, 
+            typename Identity, typename Combiner>
+  auto scan(InputIterator first, OutputIterator first_out, 
+            std::size_t sequence_size, Identity && identity, 
+            Combiner && combine_op, scan_mode mode) const;
+
   /**
   \brief Applies a stencil to multiple sequences leaving the result in
   another sequence.
@@ -216,6 +321,28 @@ public:
                StencilTransformer && transform_op,
                Neighbourhood && neighbour_op) const;
 
+  /**
+  \brief Applies a number of time steps of a stencil to a multi-dimensional 
+  grid leaving the result in another grid.
+  \tparam InputIt Random access iterator type for the input grid.
+  \tparam OutputIt Random access iterator type for the output grid.
+  \tparam D Number of dimensions of the grid.
+  \tparam StencilTransformer Callable object type for the stencil 
+  transformation.
+  \param shape Shape of the grid.
+  \param first Iterator to the first element of the input grid.
+  \param first_out Iterator to the first element of the output grid.
+  \param num_steps Number of time steps computed per tile without 
+  synchronization.
+  \param transform_op Stencil transformation callable object invoked with a
+  grid_neighbourhood.
+  */
+  template <typename InputIt, typename OutputIt, std::size_t D,
+            typename StencilTransformer>
+  void stencil(const grid_shape<D> & shape, InputIt first, 
+               OutputIt first_out, std::size_t num_steps,
+               StencilTransformer && transform_op) const;
+
   /**
   \brief Invoke \ref md_divide-conquer.
   \tparam Input Type used for the input problem.
@@ -234,6 +361,27 @@ public:
                       Solver && solve_op, 
                       Combiner && combine_op) const; 
 
+  /**
+  \brief Invoke \ref md_divide-conquer with a base case predicate.
+  \tparam Input Type used for the input problem.
+  \tparam Divider Callable type for the divider operation.
+  \tparam Predicate Callable type for the base case predicate.
+  \tparam Solver Callable type for the solver operation.
+  \tparam Combiner Callable type for the combiner operation.
+  \param input Input problem to be solved.
+  \param divider_op Divider operation.
+  \param predicate_op Base case predicate operation.
+  \param solver_op Solver operation.
+  \param combine_op Combiner operation.
+  */
+  template <typename Input, typename Divider, typename Predicate, 
+            typename Solver, typename Combiner>
+  auto divide_conquer(Input && input, 
+                      Divider && divide_op, 
+                      Predicate && predicate_op,
+                      Solver && solve_op, 
+                      Combiner && combine_op) const; 
+
   /**
   \brief Invoke \ref md_pipeline.
   \tparam Generator Callable type for the generator operation.
@@ -254,6 +402,14 @@ private:
                       Combiner && combine_op,
                       std::atomic<int> & num_threads) const; 
 
+  template <typename Input, typename Divider, typename Predicate, 
+            typename Solver, typename Combiner>
+  auto divide_conquer_task(Input && input, 
+                           Divider && divide_op, 
+                           Predicate && predicate_op,
+                           Solver && solve_op, 
+                           Combiner && combine_op) const; 
+
   template <typename Queue, typename Consumer,
             requires_no_pattern<Consumer> = 0>
   void do_pipeline(Queue & input_queue, Consumer && consume_op) const;
@@ -424,6 +580,34 @@ private:
     return result;
   }
 
+  /**
+  \brief Processes all the chunks of a partition.
+  In fixed mode the chunks are distributed with a plain parallel loop with a
+  static schedule, so that chunk i is always run by thread i of the team and 
+  no task is created. In the other modes the chunks are distributed with a 
+  dynamic loop schedule. As chunk boundaries are computed in advance, guided 
+  scheduling keeps its decreasing chunk sizes.
+  \param chunks Partition of the sequence.
+  \param process_chunk Callable invoked with the first position, the size 
+  and the index of every chunk.
+  */
+  template <typename ChunkProcessor>
+  void for_each_chunk(const chunk_scheduler & chunks, 
+                      ChunkProcessor && process_chunk) const;
+
+  /**
+  \brief Combines in order the partial results of a reduction.
+  When parallel combination is enabled, every level of a pairwise 
+  combination tree is run as a parallel loop.
+  \param partials Partial results. Their values are consumed.
+  \param combine_op Combination callable object.
+  \pre partials is not empty.
+  \return The combination of all the partial results.
+  */
+  template <typename Result, typename Combiner>
+  Result combine_partials(cache_aligned_vector<Result> & partials, 
+                          Combiner && combine_op) const;
+
 private:
 
   int concurrency_degree_;
@@ -434,6 +618,13 @@ private:
   int queue_size_ = default_queue_size;
 
   queue_mode queue_mode_ = queue_mode::blocking;
+
+  int queue_batch_ = 1;
+
+  scheduling_mode scheduling_ = scheduling_mode::fixed;
+  std::size_t grain_ = 0;
+
+  bool parallel_combine_ = false;
 };
 
 /**
@@ -473,6 +664,13 @@ constexpr bool supports_reduce<parallel_execution_omp>() { return true; }
 template <>
 constexpr bool supports_map_reduce<parallel_execution_omp>() { return true; }
 
+/**
+\brief Determines if an execution policy supports the scan pattern.
+\note Specialization for parallel_execution_omp when GRPPI_OMP is enabled.
+*/
+template <>
+constexpr bool supports_scan<parallel_execution_omp>() { return true; }
+
 /**
 \brief Determines if an execution policy supports the stencil pattern.
 \note Specialization for parallel_execution_omp when GRPPI_OMP is enabled.
@@ -501,10 +699,13 @@ void parallel_execution_omp::map(
     OutputIterator first_out, 
     std::size_t sequence_size, Transformer transform_op) const
 {
-  #pragma omp parallel for
-  for (std::size_t i=0; i<sequence_size; ++i) {
-    first_out[i] = apply_iterators_indexed(transform_op, firsts, i);
-  }
+  constexpr sequential_execution seq;
+  chunk_scheduler chunks{scheduling_, sequence_size, 
+      concurrency_degree_, grain_};
+  for_each_chunk(chunks, [&](std::size_t first, std::size_t size, std::size_t) {
+    seq.map(iterators_next(firsts, first), std::next(first_out, first), size, 
+        transform_op);
+  });
 }
 
 template <typename InputIterator, typename Identity, typename Combiner>
@@ -516,40 +717,19 @@ auto parallel_execution_omp::reduce(
   constexpr sequential_execution seq;
 
   using result_type = std::decay_t<Identity>;
-  std::vector<result_type> partial_results(concurrency_degree_);
-  auto process_chunk = [&](InputIterator f, std::size_t sz, std::size_t id) {
-    partial_results[id] = seq.reduce(f, sz, std::forward<Identity>(identity), 
+  chunk_scheduler chunks{scheduling_, sequence_size, 
+      concurrency_degree_, grain_};
+  cache_aligned_vector<result_type> partial_results(chunks.num_chunks());
+  auto process_chunk = [&](std::size_t f, std::size_t sz, std::size_t id) {
+    // Accumulate locally and write the partial result once
+    partial_results[id].value = seq.reduce(std::next(first,f), sz, 
+        std::forward<Identity>(identity), 
         std::forward<Combiner>(combine_op));
   };
+  for_each_chunk(chunks, process_chunk);
 
-  const auto chunk_size = sequence_size/concurrency_degree_;
-
-  #pragma omp parallel
-  {
-    #pragma omp single nowait
-    {
-      for (int i=0 ;i<concurrency_degree_-1; ++i) {
-        const auto delta = chunk_size * i;
-        const auto chunk_first = std::next(first,delta);
-
-        #pragma omp task firstprivate (chunk_first, chunk_size, i)
-        {
-          process_chunk(chunk_first, chunk_size, i);
-        }
-      }
-    
-      //Main thread
-      const auto delta = chunk_size * (concurrency_degree_ - 1);
-      const auto chunk_first= std::next(first,delta);
-      const auto chunk_sz = sequence_size - delta;
-      process_chunk(chunk_first, chunk_sz, concurrency_degree_-1);
-      #pragma omp taskwait
-    }
-  }
-
-  return seq.reduce(std::next(partial_results.begin()), 
-      partial_results.size()-1,
-      partial_results[0], std::forward<Combiner>(combine_op));
+  return combine_partials(partial_results, 
+      std::forward<Combiner>(combine_op));
 }
 
 template <typename ... InputIterators, typename Identity, 
@@ -563,45 +743,72 @@ auto parallel_execution_omp::map_reduce(
   constexpr sequential_execution seq;
 
   using result_type = std::decay_t<Identity>;
-  std::vector<result_type> partial_results(concurrency_degree_);
-
-  auto process_chunk = [&](auto f, std::size_t sz, std::size_t i) {
-    partial_results[i] = seq.map_reduce(
-        f, sz, partial_results[i],
+  chunk_scheduler chunks{scheduling_, sequence_size, 
+      concurrency_degree_, grain_};
+  cache_aligned_vector<result_type> partial_results(chunks.num_chunks());
+
+  auto process_chunk = [&](std::size_t f, std::size_t sz, std::size_t i) {
+    // Accumulate locally and write the partial result once
+    partial_results[i].value = seq.map_reduce(
+        iterators_next(firsts,f), sz, identity,
         std::forward<Transformer>(transform_op), 
         std::forward<Combiner>(combine_op));
   };
+  for_each_chunk(chunks, process_chunk);
 
-  const auto chunk_size = sequence_size / concurrency_degree_;
+  return combine_partials(partial_results, 
+      std::forward<Combiner>(combine_op));
+}
 
-  #pragma omp parallel
-  {
-    #pragma omp single nowait
-    {
+template <typename InputIterator, typename OutputIterator, 
+          typename Identity, typename Combiner>
+auto parallel_execution_omp::scan(
+    InputIterator first, OutputIterator first_out,
+    std::size_t sequence_size,
+    Identity && identity,
+    Combiner && combine_op,
+    scan_mode mode) const
+{
+  constexpr sequential_execution seq;
 
-      for (int i=0;i<concurrency_degree_-1;++i) {    
-        #pragma omp task firstprivate(i)
-        {
-          const auto delta = chunk_size * i;
-          const auto chunk_firsts = iterators_next(firsts,delta);
-          const auto chunk_last = std::next(std::get<0>(chunk_firsts), chunk_size);
-          process_chunk(chunk_firsts, chunk_size, i);
-        }
-      }
+  using result_type = std::decay_t<Identity>;
+  chunk_scheduler chunks{scheduling_, sequence_size, 
+      concurrency_degree_, grain_};
+  const auto num_chunks = chunks.num_chunks();
+  if (num_chunks == 1) {
+    return seq.scan(first, first_out, sequence_size, identity, combine_op, 
+        mode);
+  }
 
-      const auto delta = chunk_size * (concurrency_degree_ - 1);
-      auto chunk_firsts = iterators_next(firsts,delta);
-      auto chunk_last = std::next(std::get<0>(firsts), sequence_size);
-      process_chunk(chunk_firsts, 
-          std::distance(std::get<0>(chunk_firsts), chunk_last), 
-          concurrency_degree_ - 1);
-      #pragma omp taskwait
+  // First pass: reduce every chunk but the last one
+  cache_aligned_vector<result_type> prefixes(num_chunks);
+  for_each_chunk(chunks, [&](std::size_t f, std::size_t sz, std::size_t id) {
+    if (id+1 < num_chunks) {
+      prefixes[id].value = seq.reduce(std::next(first,f), sz, identity, 
+          combine_op);
     }
+  });
+
+  // Turn chunk results into the prefix of every chunk
+  result_type prefix{identity};
+  for (std::size_t id=0; id<num_chunks; ++id) {
+    auto next = (id+1 < num_chunks) ? 
+        combine_op(prefix, prefixes[id].value) : prefix;
+    prefixes[id].value = std::move(prefix);
+    prefix = std::move(next);
   }
 
-  return seq.reduce(std::next(partial_results.begin()), 
-      partial_results.size()-1,
-      partial_results[0], std::forward<Combiner>(combine_op));
+  // Second pass: scan every chunk starting from its prefix
+  chunk_scheduler final_chunks{scheduling_, sequence_size, 
+      concurrency_degree_, grain_};
+  result_type total{identity};
+  for_each_chunk(final_chunks, 
+      [&](std::size_t f, std::size_t sz, std::size_t id) {
+    auto result = seq.scan(std::next(first,f), std::next(first_out,f), sz, 
+        prefixes[id].value, combine_op, mode);
+    if (id+1 == num_chunks) total = std::move(result);
+  });
+  return total;
 }
 
 template <typename ... InputIterators, typename OutputIterator,
@@ -613,35 +820,81 @@ void parallel_execution_omp::stencil(
     Neighbourhood && neighbour_op) const
 {
   constexpr sequential_execution seq;
-  const auto chunk_size = sequence_size / concurrency_degree_;
-  auto process_chunk = [&](auto f, std::size_t sz, std::size_t delta) {
-    seq.stencil(f, std::next(first_out,delta), sz,
+  auto process_chunk = [&](std::size_t f, std::size_t sz, std::size_t) {
+    seq.stencil(iterators_next(firsts,f), std::next(first_out,f), sz,
       std::forward<StencilTransformer>(transform_op),
       std::forward<Neighbourhood>(neighbour_op));
   };
 
-  #pragma omp parallel 
-  {
-    #pragma omp single nowait
-    {
-      for (int i=0; i<concurrency_degree_-1; ++i) {
-        #pragma omp task firstprivate(i)
-        {
-          const auto delta = chunk_size * i;
-          const auto chunk_firsts = iterators_next(firsts,delta);
-          process_chunk(chunk_firsts, chunk_size, delta);
-        }
-      }
+  chunk_scheduler chunks{scheduling_, sequence_size, 
+      concurrency_degree_, grain_};
+  for_each_chunk(chunks, process_chunk);
+}
 
-      const auto delta = chunk_size * (concurrency_degree_ - 1);
-      const auto chunk_firsts = iterators_next(firsts,delta);
-      const auto chunk_last = std::next(std::get<0>(firsts), sequence_size);
-      process_chunk(chunk_firsts, 
-          std::distance(std::get<0>(chunk_firsts), chunk_last), delta);
+template <typename InputIt, typename OutputIt, std::size_t D,
+          typename StencilTransformer>
+void parallel_execution_omp::stencil(
+    const grid_shape<D> & shape, 
+    InputIt first, OutputIt first_out, 
+    std::size_t num_steps,
+    StencilTransformer && transform_op) const
+{
+  grid_tiling<D> tiling{shape};
+  chunk_scheduler chunks{scheduling_, tiling.num_tiles(), 
+      concurrency_degree_, grain_};
+  for_each_chunk(chunks, [&](std::size_t f, std::size_t sz, std::size_t) {
+    grid_stencil_tiles(shape, tiling, first, first_out, num_steps,
+        transform_op, f, f+sz);
+  });
+}
 
-      #pragma omp taskwait
+template <typename ChunkProcessor>
+void parallel_execution_omp::for_each_chunk(
+    const chunk_scheduler & chunks, 
+    ChunkProcessor && process_chunk) const
+{
+  const auto num_chunks = chunks.num_chunks();
+
+  // Static scheduling already runs chunk i in the same thread of the team
+  if (chunks.mode() == scheduling_mode::fixed || 
+      chunks.mode() == scheduling_mode::pinned) {
+    #pragma omp parallel for schedule(static,1)
+    for (std::size_t i=0; i<num_chunks; ++i) {
+      process_chunk(chunks.chunk_begin(i), chunks.chunk_size(i), i);
+    }
+    return;
+  }
+
+  #pragma omp parallel for schedule(dynamic,1)
+  for (std::size_t i=0; i<num_chunks; ++i) {
+    process_chunk(chunks.chunk_begin(i), chunks.chunk_size(i), i);
+  }
+}
+
+template <typename Result, typename Combiner>
+Result parallel_execution_omp::combine_partials(
+    cache_aligned_vector<Result> & partials, 
+    Combiner && combine_op) const
+{
+  if (parallel_combine_) {
+    const auto size = partials.size();
+    for (std::size_t stride=1; stride<size; stride*=2) {
+      const std::size_t num_pairs = (size - stride + 2*stride - 1) / (2*stride);
+      #pragma omp parallel for schedule(dynamic,1)
+      for (std::size_t k=0; k<num_pairs; ++k) {
+        const auto i = 2 * stride * k;
+        partials[i].value = combine_op(partials[i].value, 
+            partials[i+stride].value);
+      }
     }
+    return std::move(partials[0].value);
+  }
+
+  auto result = std::move(partials[0].value);
+  for (std::size_t i=1; i<partials.size(); ++i) {
+    result = combine_op(result, partials[i].value);
   }
+  return result;
 }
 
 template <typename Input, typename Divider, typename Solver, typename Combiner>
@@ -659,6 +912,33 @@ auto parallel_execution_omp::divide_conquer(
       num_threads);
 }
 
+template <typename Input, typename Divider, typename Predicate, 
+          typename Solver, typename Combiner>
+auto parallel_execution_omp::divide_conquer(
+    Input && input, 
+    Divider && divide_op, 
+    Predicate && predicate_op,
+    Solver && solve_op, 
+    Combiner && combine_op) const
+{
+  using result_type = 
+      std::decay_t<typename std::result_of<Solver(Input)>::type>;
+  result_type result;
+
+  #pragma omp parallel
+  {
+    #pragma omp single nowait
+    {
+      result = divide_conquer_task(std::forward<Input>(input), 
+          std::forward<Divider>(divide_op), 
+          std::forward<Predicate>(predicate_op), 
+          std::forward<Solver>(solve_op), 
+          std::forward<Combiner>(combine_op));
+    }
+  }
+  return result;
+}
+
 template <typename Generator, typename ... Transformers>
 void parallel_execution_omp::pipeline(
     Generator && generate_op, 
@@ -675,12 +955,14 @@ void parallel_execution_omp::pipeline(
     {
       #pragma omp task shared(generate_op,output_queue)
       {
+        auto output = make_queue_writer(output_queue, queue_batch_);
         long order = 0;
         for (;;) {
           auto item = generate_op();
-          output_queue.push(make_pair(item,order++)) ;
+          output.push(make_pair(item,order++)) ;
           if (!item) break;
         }
+        output.flush();
       }
       do_pipeline(output_queue,
           forward<Transformers>(transform_ops)...);
@@ -761,53 +1043,73 @@ auto parallel_execution_omp::divide_conquer(
       std::forward<subresult_type>(subresult), combine_op);
 }
 
+template <typename Input, typename Divider, typename Predicate, 
+          typename Solver, typename Combiner>
+auto parallel_execution_omp::divide_conquer_task(
+    Input && input, 
+    Divider && divide_op, 
+    Predicate && predicate_op,
+    Solver && solve_op, 
+    Combiner && combine_op) const
+{
+  if (predicate_op(input)) { return solve_op(std::forward<Input>(input)); }
+  auto subproblems = divide_op(std::forward<Input>(input));
+  if (subproblems.size()<=1) { return solve_op(std::forward<Input>(input)); }
+
+  using subresult_type = 
+      std::decay_t<typename std::result_of<Solver(Input)>::type>;
+  std::vector<subresult_type> partials(subproblems.size()-1);
+
+  for (std::size_t i=1; i<subproblems.size(); ++i) {
+    #pragma omp task firstprivate(i) \
+            shared(partials,subproblems,divide_op,predicate_op,solve_op,combine_op)
+    {
+      partials[i-1] = divide_conquer_task(std::forward<Input>(subproblems[i]), 
+          std::forward<Divider>(divide_op), 
+          std::forward<Predicate>(predicate_op), 
+          std::forward<Solver>(solve_op), 
+          std::forward<Combiner>(combine_op));
+    }
+  }
+
+  //Main thread works on the first subproblem.
+  auto subresult = divide_conquer_task(std::forward<Input>(subproblems[0]), 
+      std::forward<Divider>(divide_op), 
+      std::forward<Predicate>(predicate_op), 
+      std::forward<Solver>(solve_op), 
+      std::forward<Combiner>(combine_op));
+  #pragma omp taskwait
+
+  constexpr sequential_execution seq;
+  return seq.reduce(partials.begin(), partials.size(), 
+      std::forward<subresult_type>(subresult), combine_op);
+}
+
 template <typename Queue, typename Consumer,
           requires_no_pattern<Consumer> =0>
 void parallel_execution_omp::do_pipeline(Queue & input_queue, Consumer && consume_op) const
 {
   using namespace std;
   using input_type = typename Queue::value_type;
+  auto input = make_queue_reader(input_queue, queue_batch_);
 
   if (!is_ordered()) {
     for (;;) {
-      auto item = input_queue.pop();
+      auto item = input.pop();
       if (!item.first) break;
       consume_op(*item.first);
     }
     return;
   }
 
-  vector<input_type> elements;
-  long current = 0;
-  auto item = input_queue.pop( );
+  reorder_buffer<input_type> elements;
+  auto consume_item = [&](input_type && item) { consume_op(*item.first); };
+  auto item = input.pop();
   while (item.first) {
-    if (current == item.second) {
-      consume_op(*item.first);
-      current ++;
-    } 
-    else {
-      elements.push_back(item);
-    }
-    for (auto it=elements.begin(); it!=elements.end(); it++) {
-      if (it->second == current) {
-        consume_op(*it->first);
-        elements.erase(it);
-        current++;
-        break;
-      }
-    }
-    item = input_queue.pop( );
-  }
-  while(elements.size()>0){
-    for(auto it = elements.begin(); it != elements.end(); it++){
-      if(it->second == current) {
-        consume_op(*it->first);
-        elements.erase(it);
-        current++;
-        break;
-      }
-    }
+    elements.push(std::move(item), consume_item);
+    item = input.pop();
   }
+  elements.flush(consume_item);
 }
 
 template <typename Queue, typename Transformer, typename ... OtherTransformers,
@@ -827,13 +1129,16 @@ void parallel_execution_omp::do_pipeline(
 
   #pragma omp task shared(transform_op, input_queue, output_queue)
   {
+    auto input = make_queue_reader(input_queue, queue_batch_);
+    auto output = make_queue_writer(output_queue, queue_batch_);
     for (;;) {
-      auto item = input_queue.pop(); 
+      auto item = input.pop(output); 
       if (!item.first) break;
       auto out = output_value_type{transform_op(*item.first)};
-      output_queue.push(make_pair(out, item.second));
+      output.push(make_pair(out, item.second));
     }
-    output_queue.push(make_pair(output_value_type{}, -1));
+    output.push(make_pair(output_value_type{}, -1));
+    output.flush();
   }
 
   do_pipeline(output_queue, 
@@ -889,12 +1194,16 @@ void parallel_execution_omp::do_pipeline(
   for (int i=0; i<farm_obj.cardinality(); ++i) {
     #pragma omp task shared(done_threads,output_queue,farm_obj,input_queue)
     {
-      auto item = input_queue.pop();
+      // Workers share the input queue, so items are taken one at a time
+      auto input = make_queue_reader(input_queue, 1);
+      auto output = make_queue_writer(output_queue, queue_batch_);
+      auto item = input.pop(output);
       while (item.first) {
         auto out = output_value_type{farm_obj(*item.first)};
-        output_queue.push(make_pair(out,item.second));
-        item = input_queue.pop();
+        output.push(make_pair(out,item.second));
+        item = input.pop(output);
       }
+      output.flush();
       input_queue.push(item);
       done_threads++;
       if (done_threads==farm_obj.cardinality()) {
@@ -933,64 +1242,42 @@ void parallel_execution_omp::do_pipeline(
   if (is_ordered()) {
     auto filter_task = [&]() {
       {
-        auto item{input_queue.pop()};
+        auto input = make_queue_reader(input_queue, queue_batch_);
+        auto output = make_queue_writer(filter_queue, queue_batch_);
+        auto item{input.pop(output)};
         while (item.first) {
           if(filter_obj(*item.first)) {
-            filter_queue.push(item);
+            output.push(item);
           }
           else {
-            filter_queue.push(make_pair(input_value_type{} ,item.second));
+            output.push(make_pair(input_value_type{} ,item.second));
           }
-          item = input_queue.pop();
+          item = input.pop(output);
         }
-        filter_queue.push (make_pair(input_value_type{}, -1));
+        output.push(make_pair(input_value_type{}, -1));
+        output.flush();
       }
     };
 
     auto output_queue = make_queue<input_type>();
     auto reorder_task = [&]() {
-      vector<input_type> elements;
-      int current = 0;
+      reorder_buffer<input_type> elements;
       long order = 0;
-      auto item = filter_queue.pop();
-      for (;;) {
-        if (!item.first && item.second == -1) break;
-        if (item.second == current) {
-          if (item.first) {
-            output_queue.push(make_pair(item.first, order++));
-          }
-          current++;
-        }
-        else {
-          elements.push_back(item);
-        }
-        for (auto it=elements.begin(); it<elements.end(); it++) {
-          if ((*it).second==current) {
-            if((*it).first){
-              output_queue.push(make_pair((*it).first,order++));
-            }
-            elements.erase(it);
-            current++;
-            break;
-          }
+      auto input = make_queue_reader(filter_queue, queue_batch_);
+      auto output = make_queue_writer(output_queue, queue_batch_);
+      auto forward_item = [&](input_type && item) {
+        if (item.first) {
+          output.push(make_pair(std::move(item.first), order++));
         }
-        item = filter_queue.pop();
+      };
+      auto item = input.pop(output);
+      while (item.first || item.second != -1) {
+        elements.push(std::move(item), forward_item);
+        item = input.pop(output);
       }
-
-      while (elements.size()>0) {
-        for (auto it=elements.begin(); it<elements.end(); it++) {
-          if ((*it).second == current) {
-            if((*it).first) {
-              output_queue.push(make_pair((*it).first,order++));
-            }
-            elements.erase(it);
-            current++;
-            break;
-          }
-        }
-      }
-
-      output_queue.push(item);
+      elements.flush(forward_item);
+      output.push(item);
+      output.flush();
     };
 
     
@@ -1011,14 +1298,17 @@ void parallel_execution_omp::do_pipeline(
   }
   else {
     auto filter_task = [&]() {
-      auto item = input_queue.pop( ) ;
+      auto input = make_queue_reader(input_queue, queue_batch_);
+      auto output = make_queue_writer(filter_queue, queue_batch_);
+      auto item = input.pop(output);
       while (item.first) {
         if (filter_obj(*item.first)) {
-          filter_queue.push(item);
+          output.push(item);
         }
-        item = input_queue.pop();
+        item = input.pop(output);
       }
-      filter_queue.push(make_pair(input_value_type{}, -1));
+      output.push(make_pair(input_value_type{}, -1));
+      output.flush();
     };
 
     #pragma omp task shared(filter_queue,filter_obj,input_queue)
@@ -1051,19 +1341,22 @@ void parallel_execution_omp::do_pipeline(
   auto output_queue = make_queue<output_item_type>();
 
   auto reduce_task = [&,this]() {
-    auto item{input_queue.pop()};
+    auto input = make_queue_reader(input_queue, queue_batch_);
+    auto output = make_queue_writer(output_queue, queue_batch_);
+    auto item{input.pop(output)};
     int order = 0;
     while (item.first) {
       std::cerr << "item: " << *item.first << " , " << item.second << "\n";
       reduce_obj.add_item(std::forward<Identity>(*item.first));
-      item = input_queue.pop();
+      item = input.pop(output);
       if (reduce_obj.reduction_needed()) {
         constexpr sequential_execution seq;
         auto red = reduce_obj.reduce_window(seq);
-        output_queue.push(make_pair(red, order++));
+        output.push(make_pair(red, order++));
       }
     }
-    output_queue.push(make_pair(output_item_value_type{}, -1));
+    output.push(make_pair(output_item_value_type{}, -1));
+    output.flush();
   };
 
   #pragma omp task shared(reduce_obj,input_queue, output_queue)
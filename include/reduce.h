@@ -25,6 +25,7 @@
 
 #include "common/iterator_traits.h"
 #include "common/execution_traits.h"
+#include "common/range.h"
 
 namespace grppi {
 
@@ -59,8 +60,42 @@ auto reduce(const Execution & ex,
 {
   static_assert(supports_reduce<Execution>(),
       "reduce not supported on execution type");
-  return ex.reduce(first, std::distance(first,last), 
-      std::forward<Result>(identity), std::forward<Combiner>(combine_op));
+  // Non random access sequences are split once instead of in every chunk
+  subrange<InputIt> range{first, last, 
+      static_cast<std::size_t>(std::distance(first,last))};
+  return internal::reduce_range(ex, range, std::forward<Result>(identity), 
+      std::forward<Combiner>(combine_op), 
+      std::integral_constant<bool, is_random_access_range<decltype(range)>>{});
+}
+
+/**
+\brief Invoke \ref md_reduce with identity value on a range.
+Random access ranges are chunked in constant time and contiguous ranges are
+accessed through pointers. Other ranges are split through the split 
+customization point.
+\tparam Execution Execution type.
+\tparam Range Type of the input range.
+\tparam Result Type for the identity value.
+\tparam Combiner Callable type for the combiner operation.
+\param ex Execution policy object.
+\param range Input range.
+\param identity Identity value for the combiner operation.
+\param combiner_op Combiner operation for the reduction.
+\return The result of the reduction.
+*/
+template <typename Execution, typename Range, typename Result, 
+          typename Combiner,
+          requires_range<Range> = 0>
+auto reduce(const Execution & ex, 
+            Range && range,
+            Result && identity,
+            Combiner && combine_op)
+{
+  static_assert(supports_reduce<Execution>(),
+      "reduce not supported on execution type");
+  return internal::reduce_range(ex, range, std::forward<Result>(identity), 
+      std::forward<Combiner>(combine_op), 
+      std::integral_constant<bool, is_random_access_range<Range>>{});
 }
 
 /**
@@ -0,0 +1,228 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_REDUCE_BY_KEY_H
+#define GRPPI_REDUCE_BY_KEY_H
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/execution_traits.h"
+#include "common/iterator_traits.h"
+#include "common/range.h"
+
+namespace grppi {
+
+namespace internal {
+
+/**
+\brief Minimum number of elements per part in a reduction by key.
+*/
+constexpr std::size_t min_reduce_by_key_part = 1024;
+
+/**
+\brief Splits a sequence in parts for a reduction by key. There is at most a
+part per thread, as every part privatizes its own tables.
+*/
+template <typename Execution, typename InputIt>
+auto reduce_by_key_parts(const Execution & ex, InputIt first, InputIt last)
+{
+  const auto size = static_cast<std::size_t>(std::distance(first, last));
+  const auto degree = static_cast<std::size_t>(
+      std::max(1, ex.concurrency_degree()));
+  const auto num_parts = std::min(degree, 
+      std::max<std::size_t>(1, size / min_reduce_by_key_part));
+  return grppi::split(subrange<InputIt>{first, last, size}, num_parts);
+}
+
+/**
+\brief Combines a value into the entry of a key in a table, inserting the 
+key if needed.
+*/
+template <typename Table, typename Key, typename Value, typename Identity,
+          typename Combiner>
+void combine_entry(Table & table, Key && key, Value && value, 
+                   const Identity & identity, Combiner & combine_op)
+{
+  auto it = table.find(key);
+  if (it == table.end()) {
+    table.emplace(std::forward<Key>(key), 
+        combine_op(identity, std::forward<Value>(value)));
+  }
+  else {
+    it->second = combine_op(it->second, std::forward<Value>(value));
+  }
+}
+
+} // namespace internal
+
+/** 
+\addtogroup data_patterns
+@{
+\defgroup reduce_by_key_pattern Reduce by key pattern
+\brief Interface for applying the \ref md_reduce-by-key.
+@{
+*/
+
+/**
+\brief Invoke \ref md_reduce-by-key on a data sequence. Elements are grouped 
+by a key and the transformed elements of every group are reduced.
+\tparam Execution Execution type.
+\tparam InputIt Iterator type used for the input sequence.
+\tparam KeyExtractor Callable type for the key extraction.
+\tparam Identity Type for the identity value.
+\tparam Transformer Callable type for the transformation operation.
+\tparam Combiner Callable type for the combiner operation.
+\param ex Execution policy object.
+\param first Iterator to the first element in the input sequence.
+\param last Iterator to one past the end of the input sequence.
+\param key_op Operation returning the key of an element. Keys must be 
+hashable with std::hash.
+\param identity Identity value for the combiner operation.
+\param transform_op Transformation operation.
+\param combine_op Associative and commutative combiner operation.
+\return An unordered map from every key to the reduction of its elements.
+*/
+template <typename Execution, typename InputIt, typename KeyExtractor,
+          typename Identity, typename Transformer, typename Combiner,
+          requires_iterator<InputIt> = 0>
+auto reduce_by_key(const Execution & ex, 
+                   InputIt first, InputIt last,
+                   KeyExtractor && key_op,
+                   Identity && identity,
+                   Transformer && transform_op,
+                   Combiner && combine_op)
+{
+  static_assert(supports_map<Execution>(),
+      "map not supported on execution type");
+  using key_type = std::decay_t<decltype(key_op(*first))>;
+  using value_type = std::decay_t<Identity>;
+  using table_type = std::unordered_map<key_type, value_type>;
+
+  // Every part (one per thread) privatizes a table per shard. Keys are 
+  // assigned to shards by their hash, so that shards may be merged 
+  // independently.
+  const auto parts = internal::reduce_by_key_parts(ex, first, last);
+  const auto num_parts = parts.size();
+  std::vector<std::vector<table_type>> tables(num_parts, 
+      std::vector<table_type>(num_parts));
+  const value_type init{std::forward<Identity>(identity)};
+  const std::hash<key_type> hasher{};
+
+  internal::for_each_index(ex, num_parts, [&](std::size_t p) {
+    auto & shards = tables[p];
+    for (auto && x : parts[p]) {
+      auto key = key_op(x);
+      auto & shard = shards[hasher(key) % num_parts];
+      internal::combine_entry(shard, std::move(key), transform_op(x), init, 
+          combine_op);
+    }
+  });
+
+  internal::for_each_index(ex, num_parts, [&](std::size_t s) {
+    auto & merged = tables[0][s];
+    for (std::size_t p = 1; p < num_parts; ++p) {
+      for (auto & entry : tables[p][s]) {
+        internal::combine_entry(merged, entry.first, std::move(entry.second),
+            init, combine_op);
+      }
+      table_type{}.swap(tables[p][s]);
+    }
+  });
+
+  std::size_t num_keys = 0;
+  for (std::size_t s = 0; s < num_parts; ++s) { 
+    num_keys += tables[0][s].size(); 
+  }
+  table_type result;
+  result.reserve(num_keys);
+  for (std::size_t s = 0; s < num_parts; ++s) {
+    for (auto & entry : tables[0][s]) {
+      result.emplace(entry.first, std::move(entry.second));
+    }
+  }
+  return result;
+}
+
+/**
+\brief Invoke \ref md_reduce-by-key on a data sequence, counting the elements
+in every bin of a dense set of bins.
+\tparam Execution Execution type.
+\tparam InputIt Iterator type used for the input sequence.
+\tparam BinSelector Callable type for the bin selection.
+\param ex Execution policy object.
+\param first Iterator to the first element in the input sequence.
+\param last Iterator to one past the end of the input sequence.
+\param num_bins Number of bins.
+\param bin_op Operation returning the bin of an element. Elements whose bin
+is not in [0,num_bins) are not counted.
+\return The number of elements in every bin.
+*/
+template <typename Execution, typename InputIt, typename BinSelector,
+          requires_iterator<InputIt> = 0>
+std::vector<std::size_t> histogram(const Execution & ex, 
+                                   InputIt first, InputIt last,
+                                   std::size_t num_bins,
+                                   BinSelector && bin_op)
+{
+  static_assert(supports_map<Execution>(),
+      "map not supported on execution type");
+  const auto parts = internal::reduce_by_key_parts(ex, first, last);
+  const auto num_parts = parts.size();
+  std::vector<std::vector<std::size_t>> bins(num_parts, 
+      std::vector<std::size_t>(num_bins, 0));
+
+  internal::for_each_index(ex, num_parts, [&](std::size_t p) {
+    auto & counts = bins[p];
+    for (auto && x : parts[p]) {
+      const auto bin = static_cast<std::size_t>(bin_op(x));
+      if (bin < num_bins) counts[bin]++;
+    }
+  });
+
+  // Every block of bins is added up independently
+  std::vector<std::size_t> result(num_bins, 0);
+  const auto num_blocks = std::max<std::size_t>(1, 
+      std::min(num_bins, num_parts));
+  internal::for_each_index(ex, num_blocks, [&](std::size_t b) {
+    const auto block_first = b * num_bins / num_blocks;
+    const auto block_last = (b+1) * num_bins / num_blocks;
+    for (const auto & counts : bins) {
+      for (auto i = block_first; i < block_last; ++i) { 
+        result[i] += counts[i]; 
+      }
+    }
+  });
+  return result;
+}
+
+/**
+@}
+@}
+*/
+
+}
+
+#endif
@@ -0,0 +1,118 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_SCAN_H
+#define GRPPI_SCAN_H
+
+#include <utility>
+#include <iterator>
+
+#include "common/execution_traits.h"
+#include "common/iterator_traits.h"
+#include "common/scan_mode.h"
+
+namespace grppi {
+
+/** 
+\addtogroup data_patterns
+@{
+\defgroup scan_pattern Scan pattern
+\brief Interface for applying the \ref md_scan.
+@{
+*/
+
+/**
+\brief Invoke \ref md_scan computing an inclusive prefix combination of a 
+data sequence. Every output element is the combination of the identity and 
+all the input elements up to the same position.
+\tparam Execution Execution type.
+\tparam InputIt Iterator type used for the input sequence.
+\tparam OutputIt Iterator type used for the output sequence.
+\tparam Identity Type for the identity value.
+\tparam Combiner Callable type for the combiner operation.
+\param ex Execution policy object.
+\param first Iterator to the first element in the input sequence.
+\param last Iterator to one past the end of the input sequence.
+\param first_out Iterator to the first element in the output sequence. It 
+may be equal to first.
+\param identity Identity value for the combiner operation.
+\param combine_op Associative combiner operation.
+\return The combination of all the elements in the input sequence.
+*/
+template <typename Execution, typename InputIt, typename OutputIt, 
+          typename Identity, typename Combiner,
+          requires_iterator<InputIt> = 0,
+          requires_iterator<OutputIt> = 0>
+auto scan(const Execution & ex, 
+          InputIt first, InputIt last, 
+          OutputIt first_out,
+          Identity && identity,
+          Combiner && combine_op)
+{
+  static_assert(supports_scan<Execution>(),
+      "scan not supported on execution type");
+  return ex.scan(first, first_out, std::distance(first,last),
+      std::forward<Identity>(identity), std::forward<Combiner>(combine_op),
+      scan_mode::inclusive);
+}
+
+/**
+\brief Invoke \ref md_scan computing an exclusive prefix combination of a 
+data sequence. The first output element is the identity and every other 
+output element is the combination of the identity and all the input elements 
+before the same position.
+\tparam Execution Execution type.
+\tparam InputIt Iterator type used for the input sequence.
+\tparam OutputIt Iterator type used for the output sequence.
+\tparam Identity Type for the identity value.
+\tparam Combiner Callable type for the combiner operation.
+\param ex Execution policy object.
+\param first Iterator to the first element in the input sequence.
+\param last Iterator to one past the end of the input sequence.
+\param first_out Iterator to the first element in the output sequence. It 
+may be equal to first.
+\param identity Identity value for the combiner operation.
+\param combine_op Associative combiner operation.
+\return The combination of all the elements in the input sequence.
+*/
+template <typename Execution, typename InputIt, typename OutputIt, 
+          typename Identity, typename Combiner,
+          requires_iterator<InputIt> = 0,
+          requires_iterator<OutputIt> = 0>
+auto exclusive_scan(const Execution & ex, 
+                    InputIt first, InputIt last, 
+                    OutputIt first_out,
+                    Identity && identity,
+                    Combiner && combine_op)
+{
+  static_assert(supports_scan<Execution>(),
+      "scan not supported on execution type");
+  return ex.scan(first, first_out, std::distance(first,last),
+      std::forward<Identity>(identity), std::forward<Combiner>(combine_op),
+      scan_mode::exclusive);
+}
+
+/**
+@}
+@}
+*/
+}
+
+#endif
@@ -26,6 +26,11 @@
 #include "../common/execution_traits.h"
 #include "../common/patterns.h"
 #include "../common/pack_traits.h"
+#include "../common/vectorization.h"
+#include "../common/grid_stencil.h"
+#include "../common/fixed_neighbourhood.h"
+#include "../common/scan_mode.h"
+#include "../common/per_thread_storage.h"
 
 #include <type_traits>
 #include <tuple>
@@ -56,6 +61,29 @@ public:
   */
   constexpr int concurrency_degree() const noexcept { return 1; }
 
+  /**
+  \brief Makes a scratch storage with one lazily created instance of T per 
+  thread.
+  A single instance is created, as all the work is run by the calling 
+  thread.
+  \pre The storage is not used by two threads concurrently.
+  \tparam T Type of the per thread instances.
+  \param init_op Callable object returning the initial value of an instance.
+  By default, instances are value initialized.
+  \return A storage whose member local() returns the instance of the 
+  calling thread, and whose member for_each() visits all the instances.
+  */
+  template <typename T, typename Initializer>
+  auto thread_local_storage(Initializer && init_op) const {
+    return per_thread_storage<T, std::function<int()>>{
+        std::forward<Initializer>(init_op), []() { return 0; }};
+  }
+
+  template <typename T>
+  auto thread_local_storage() const {
+    return thread_local_storage<T>([]() { return T{}; });
+  }
+
   /**
   \brief Enable ordering.
   \note Enabling ordering of sequential execution is always ignored.
@@ -133,6 +161,28 @@ public:
                   Identity && identity,
                   Transformer && transform_op, Combiner && combine_op) const;
 
+  /**
+  \brief Applies a scan (prefix combination) to a sequence of data items.
+  \tparam InputIterator Iterator type for the input sequence.
+  \tparam OutputIterator Iterator type for the output sequence.
+  \tparam Identity Type for the identity value.
+  \tparam Combiner Callable object type for the combination.
+  \param first Iterator to the first element of the sequence.
+  \param first_out Iterator to the first element of the output sequence.
+  \param sequence_size Size of the input sequence.
+  \param identity Identity value for the combination.
+  \param combine_op Associative combination callable object.
+  \param mode Inclusive or exclusive scan.
+  \pre Iterators in the ranges `[first, next(first,sequence_size))` and
+  `[first_out, next(first_out,sequence_size))` are valid. 
+  \return The combination of the identity and all the elements.
+  */
+  template <typename InputIterator, typename OutputIterator, 
+            typename Identity, typename Combiner>
+  constexpr auto scan(InputIterator first, OutputIterator first_out, 
+                      std::size_t sequence_size, Identity && identity, 
+                      Combiner && combine_op, scan_mode mode) const;
+
   /**
   \brief Applies a stencil to multiple sequences leaving the result in
   another sequence.
@@ -156,6 +206,28 @@ public:
                StencilTransformer && transform_op,
                Neighbourhood && neighbour_op) const;
 
+  /**
+  \brief Applies a number of time steps of a stencil to a multi-dimensional 
+  grid leaving the result in another grid.
+  \tparam InputIt Random access iterator type for the input grid.
+  \tparam OutputIt Random access iterator type for the output grid.
+  \tparam D Number of dimensions of the grid.
+  \tparam StencilTransformer Callable object type for the stencil 
+  transformation.
+  \param shape Shape of the grid.
+  \param first Iterator to the first element of the input grid.
+  \param first_out Iterator to the first element of the output grid.
+  \param num_steps Number of time steps computed per tile without 
+  synchronization.
+  \param transform_op Stencil transformation callable object invoked with a
+  grid_neighbourhood.
+  */
+  template <typename InputIt, typename OutputIt, std::size_t D,
+            typename StencilTransformer>
+  constexpr void stencil(const grid_shape<D> & shape, InputIt first, 
+               OutputIt first_out, std::size_t num_steps,
+               StencilTransformer && transform_op) const;
+
   /**
   \brief Invoke \ref md_divide-conquer.
   \tparam Input Type used for the input problem.
@@ -174,6 +246,27 @@ public:
                       Solver && solve_op, 
                       Combiner && combine_op) const; 
 
+  /**
+  \brief Invoke \ref md_divide-conquer with a base case predicate.
+  \tparam Input Type used for the input problem.
+  \tparam Divider Callable type for the divider operation.
+  \tparam Predicate Callable type for the base case predicate.
+  \tparam Solver Callable type for the solver operation.
+  \tparam Combiner Callable type for the combiner operation.
+  \param input Input problem to be solved.
+  \param divider_op Divider operation.
+  \param predicate_op Base case predicate operation.
+  \param solver_op Solver operation.
+  \param combine_op Combiner operation.
+  */
+  template <typename Input, typename Divider, typename Predicate, 
+            typename Solver, typename Combiner>
+  auto divide_conquer(Input && input, 
+                      Divider && divide_op, 
+                      Predicate && predicate_op,
+                      Solver && solve_op, 
+                      Combiner && combine_op) const; 
+
   /**
   \brief Invoke \ref md_pipeline.
   \tparam Generator Callable type for the generator operation.
@@ -353,6 +446,13 @@ constexpr bool supports_reduce<sequential_execution>() { return true; }
 template <>
 constexpr bool supports_map_reduce<sequential_execution>() { return true; }
 
+/**
+\brief Determines if an execution policy supports the scan pattern.
+\note Specialization for sequential_execution.
+*/
+template <>
+constexpr bool supports_scan<sequential_execution>() { return true; }
+
 /**
 \brief Determines if an execution policy supports the stencil pattern.
 \note Specialization for sequential_execution.
@@ -382,11 +482,8 @@ constexpr void sequential_execution::map(
     std::size_t sequence_size, 
     Transformer && transform_op) const
 {
-  const auto last = std::next(std::get<0>(firsts), sequence_size);
-  while (std::get<0>(firsts) != last) {
-    *first_out++ = apply_deref_increment(
-        std::forward<Transformer>(transform_op), firsts);
-  }
+  map_sequence(firsts, first_out, sequence_size, 
+      std::forward<Transformer>(transform_op));
 }
 
 template <typename InputIterator, typename Identity, typename Combiner>
@@ -421,6 +518,25 @@ constexpr auto sequential_execution::map_reduce(
   return result;
 }
 
+template <typename InputIterator, typename OutputIterator, 
+          typename Identity, typename Combiner>
+constexpr auto sequential_execution::scan(
+    InputIterator first, OutputIterator first_out,
+    std::size_t sequence_size,
+    Identity && identity,
+    Combiner && combine_op,
+    scan_mode mode) const
+{
+  std::decay_t<Identity> result{identity};
+  for (std::size_t i=0; i<sequence_size; ++i) {
+    // Input is read before writing so that the scan may be done in place
+    auto next = combine_op(result, *first++);
+    *first_out++ = (mode == scan_mode::inclusive) ? next : result;
+    result = std::move(next);
+  }
+  return result;
+}
+
 template <typename ... InputIterators, typename OutputIterator,
           typename StencilTransformer, typename Neighbourhood>
 constexpr void sequential_execution::stencil(
@@ -429,12 +545,23 @@ constexpr void sequential_execution::stencil(
     StencilTransformer && transform_op,
     Neighbourhood && neighbour_op) const
 {
-  const auto last = std::next(std::get<0>(firsts), sequence_size);
-  while (std::get<0>(firsts) != last) {
-    const auto f = std::get<0>(firsts);
-    *first_out++ = transform_op(f, 
-        apply_increment(std::forward<Neighbourhood>(neighbour_op), firsts));
-  }
+  internal::stencil_sequence(firsts, first_out, sequence_size,
+      std::forward<StencilTransformer>(transform_op),
+      std::forward<Neighbourhood>(neighbour_op),
+      is_fixed_neighbourhood<std::decay_t<Neighbourhood>>{});
+}
+
+template <typename InputIt, typename OutputIt, std::size_t D,
+          typename StencilTransformer>
+constexpr void sequential_execution::stencil(
+    const grid_shape<D> & shape, 
+    InputIt first, OutputIt first_out, 
+    std::size_t num_steps,
+    StencilTransformer && transform_op) const
+{
+  grid_tiling<D> tiling{shape};
+  grid_stencil_tiles(shape, tiling, first, first_out, num_steps,
+      std::forward<StencilTransformer>(transform_op), 0, tiling.num_tiles());
 }
 
 template <typename Input, typename Divider, typename Solver, typename Combiner>
@@ -460,6 +587,33 @@ auto sequential_execution::divide_conquer(
       std::forward<Combiner>(combine_op));
 }
 
+template <typename Input, typename Divider, typename Predicate, 
+          typename Solver, typename Combiner>
+auto sequential_execution::divide_conquer(
+    Input && input, 
+    Divider && divide_op, 
+    Predicate && predicate_op,
+    Solver && solve_op, 
+    Combiner && combine_op) const
+{
+  if (predicate_op(input)) { return solve_op(std::forward<Input>(input)); }
+  auto subproblems = divide_op(std::forward<Input>(input));
+  if (subproblems.size()<=1) { return solve_op(std::forward<Input>(input)); }
+
+  using subproblem_type = 
+      std::decay_t<typename std::result_of<Solver(Input)>::type>;
+  std::vector<subproblem_type> solutions;
+  for (auto && sp : subproblems) {
+    solutions.push_back(divide_conquer(sp, 
+        std::forward<Divider>(divide_op), 
+        std::forward<Predicate>(predicate_op), 
+        std::forward<Solver>(solve_op), 
+        std::forward<Combiner>(combine_op)));
+  }
+  return reduce(std::next(solutions.begin()), solutions.size()-1, solutions[0],
+      std::forward<Combiner>(combine_op));
+}
+
 template <typename Generator, typename ... Transformers>
 void sequential_execution::pipeline(
     Generator && generate_op,
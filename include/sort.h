@@ -0,0 +1,401 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+
+#ifndef GRPPI_SORT_H
+#define GRPPI_SORT_H
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/execution_traits.h"
+#include "common/iterator_traits.h"
+#include "common/range.h"
+
+namespace grppi {
+
+namespace internal {
+
+/**
+\brief Minimum number of elements per part in a parallel sort.
+*/
+constexpr std::size_t min_sort_part = 4096;
+
+/**
+\brief Number of parts in which a sequence is sorted. It is a power of two 
+so that parts may be merged pairwise.
+*/
+template <typename Execution>
+std::size_t sort_parts(const Execution & ex, std::size_t sequence_size) {
+  std::size_t parts = 1;
+  while (parts < default_num_parts(ex) && 
+         sequence_size / (2*parts) >= min_sort_part) 
+  {
+    parts *= 2;
+  }
+  return parts;
+}
+
+/**
+\brief Finds the split point of the merge path of two sorted sequences.
+\return The number of elements of the first sequence among the first 
+diagonal elements of their stable merge.
+*/
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+std::size_t merge_path(RandomIt1 first1, std::size_t size1,
+                       RandomIt2 first2, std::size_t size2,
+                       std::size_t diagonal, Compare & comp)
+{
+  auto low = (diagonal > size2) ? diagonal - size2 : 0;
+  auto high = std::min(diagonal, size1);
+  while (low < high) {
+    const auto mid = low + (high - low) / 2;
+    if (comp(first2[diagonal - mid - 1], first1[mid])) { high = mid; }
+    else { low = mid + 1; }
+  }
+  return low;
+}
+
+/**
+\brief Merges pairs of consecutive sorted runs from a source sequence into a 
+target sequence. Every merge is split with the merge path into as many
+segments as runs it merges, so that all the segments have similar sizes.
+Split points are found before any element is moved, as searches read 
+elements merged by other segments.
+*/
+template <typename Execution, typename SourceIt, typename TargetIt,
+          typename Compare>
+void merge_runs(const Execution & ex, SourceIt source, TargetIt target, 
+                std::size_t sequence_size, std::size_t num_parts, 
+                std::size_t run_parts, Compare & comp)
+{
+  struct segment_bounds {
+    std::size_t first, middle, last; // Runs [first,middle) and [middle,last)
+    std::size_t diagonal, next_diagonal;
+  };
+  auto bounds = [=](std::size_t segment) {
+    auto part_begin = [=](std::size_t p) { 
+      return p * sequence_size / num_parts; 
+    };
+    const auto pair = segment / (2*run_parts);
+    const auto position = segment % (2*run_parts);
+    segment_bounds result;
+    result.first = part_begin(pair * 2 * run_parts);
+    result.middle = part_begin(pair * 2 * run_parts + run_parts);
+    result.last = part_begin((pair+1) * 2 * run_parts);
+    const auto size = result.last - result.first;
+    result.diagonal = position * size / (2*run_parts);
+    result.next_diagonal = (position + 1) * size / (2*run_parts);
+    return result;
+  };
+
+  std::vector<std::size_t> splits(num_parts);
+  for_each_index(ex, num_parts, [&](std::size_t segment) {
+    const auto b = bounds(segment);
+    splits[segment] = merge_path(
+        std::next(source, b.first), b.middle - b.first, 
+        std::next(source, b.middle), b.last - b.middle, b.diagonal, comp);
+  });
+
+  for_each_index(ex, num_parts, [&](std::size_t segment) {
+    const auto b = bounds(segment);
+    const auto i = splits[segment];
+    const auto next_i = (segment % (2*run_parts) + 1 < 2*run_parts) ?
+        splits[segment+1] : b.middle - b.first;
+    const auto first1 = std::next(source, b.first);
+    const auto first2 = std::next(source, b.middle);
+    std::merge(
+        std::make_move_iterator(std::next(first1, i)),
+        std::make_move_iterator(std::next(first1, next_i)),
+        std::make_move_iterator(std::next(first2, b.diagonal - i)),
+        std::make_move_iterator(std::next(first2, b.next_diagonal - next_i)),
+        std::next(target, b.first + b.diagonal), comp);
+  });
+}
+
+/**
+\brief Sorts a sequence with a parallel merge sort. Parts of the sequence are 
+sorted independently and then merged pairwise with parallel merges.
+*/
+template <typename Execution, typename RandomIt, typename Compare>
+void merge_sort(const Execution & ex, RandomIt first, RandomIt last, 
+                Compare & comp)
+{
+  const auto size = static_cast<std::size_t>(std::distance(first, last));
+  const auto num_parts = sort_parts(ex, size);
+  if (num_parts == 1) {
+    std::stable_sort(first, last, comp);
+    return;
+  }
+
+  for_each_index(ex, num_parts, [&](std::size_t p) {
+    std::stable_sort(std::next(first, p * size / num_parts), 
+        std::next(first, (p+1) * size / num_parts), comp);
+  });
+
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  std::vector<value_type> buffer(size);
+  bool in_buffer = false;
+  for (std::size_t run_parts = 1; run_parts < num_parts; run_parts *= 2) {
+    if (in_buffer) {
+      merge_runs(ex, buffer.begin(), first, size, num_parts, run_parts, comp);
+    }
+    else {
+      merge_runs(ex, first, buffer.begin(), size, num_parts, run_parts, comp);
+    }
+    in_buffer = !in_buffer;
+  }
+  if (in_buffer) {
+    ex.map(std::make_tuple(std::make_move_iterator(buffer.begin())), first, 
+        size, [](auto && x) { return std::move(x); });
+  }
+}
+
+/**
+\brief Maps an integral value to an unsigned key with the same order.
+*/
+template <typename T>
+auto radix_key(T value) {
+  using key_type = std::make_unsigned_t<T>;
+  constexpr key_type sign = std::is_signed<T>::value ?
+      key_type{1} << (std::numeric_limits<key_type>::digits - 1) : 0;
+  return static_cast<key_type>(static_cast<key_type>(value) ^ sign);
+}
+
+/**
+\brief Distributes the elements of a source sequence in a target sequence 
+according to one byte of their keys. Every part counts its elements per
+digit and then writes them to their positions, preserving their order.
+\return false if all the elements have the same digit, in which case no 
+element is moved.
+*/
+template <typename Execution, typename SourceIt, typename TargetIt>
+bool radix_pass(const Execution & ex, SourceIt source, TargetIt target,
+                std::size_t sequence_size, std::size_t num_parts, int shift)
+{
+  constexpr std::size_t num_digits = 256;
+  using histogram = std::array<std::size_t, num_digits>;
+  auto part_begin = [=](std::size_t p) { 
+    return p * sequence_size / num_parts; 
+  };
+  auto digit = [shift](const auto & x) {
+    return (radix_key(x) >> shift) & (num_digits - 1);
+  };
+
+  std::vector<histogram> offsets(num_parts);
+  for_each_index(ex, num_parts, [&](std::size_t p) {
+    auto & counts = offsets[p];
+    counts.fill(0);
+    auto it = std::next(source, part_begin(p));
+    const auto last = std::next(source, part_begin(p+1));
+    for (; it != last; ++it) { counts[digit(*it)]++; }
+  });
+
+  for (std::size_t d = 0; d < num_digits; ++d) {
+    std::size_t count = 0;
+    for (const auto & counts : offsets) { count += counts[d]; }
+    if (count == sequence_size) return false;
+  }
+
+  // Exclusive prefix in digit major order keeps the sort stable
+  std::size_t position = 0;
+  for (std::size_t d = 0; d < num_digits; ++d) {
+    for (auto & counts : offsets) {
+      const auto count = counts[d];
+      counts[d] = position;
+      position += count;
+    }
+  }
+
+  for_each_index(ex, num_parts, [&](std::size_t p) {
+    auto & positions = offsets[p];
+    auto it = std::next(source, part_begin(p));
+    const auto last = std::next(source, part_begin(p+1));
+    for (; it != last; ++it) { 
+      *std::next(target, positions[digit(*it)]++) = std::move(*it); 
+    }
+  });
+  return true;
+}
+
+/**
+\brief Sorts a sequence of integral values with a parallel least 
+significant digit radix sort.
+*/
+template <typename Execution, typename RandomIt>
+void radix_sort(const Execution & ex, RandomIt first, RandomIt last)
+{
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  const auto size = static_cast<std::size_t>(std::distance(first, last));
+  const auto num_parts = sort_parts(ex, size);
+  std::vector<value_type> buffer(size);
+  bool in_buffer = false;
+  for (int shift = 0; shift < std::numeric_limits<
+       std::make_unsigned_t<value_type>>::digits; shift += 8) 
+  {
+    const bool moved = in_buffer ?
+        radix_pass(ex, buffer.begin(), first, size, num_parts, shift) :
+        radix_pass(ex, first, buffer.begin(), size, num_parts, shift);
+    if (moved) in_buffer = !in_buffer;
+  }
+  if (in_buffer) {
+    ex.map(std::make_tuple(buffer.begin()), first, size,
+        [](value_type x) { return x; });
+  }
+}
+
+/**
+\brief Determines if a sort may use the radix sort: values are integral 
+(but not bool) and compared with std::less.
+*/
+template <typename T, typename Compare>
+constexpr bool is_radix_sortable() {
+  return std::is_integral<T>::value && !std::is_same<T,bool>::value &&
+      (std::is_same<Compare, std::less<T>>::value || 
+       std::is_same<Compare, std::less<>>::value);
+}
+
+/**
+\brief Minimum number of elements for which the radix sort is used.
+*/
+constexpr std::size_t min_radix_sort = 1 << 16;
+
+template <typename Execution, typename RandomIt, typename Compare>
+void sort(const Execution & ex, RandomIt first, RandomIt last, 
+          Compare & comp, std::true_type)
+{
+  if (static_cast<std::size_t>(std::distance(first,last)) >= min_radix_sort) {
+    radix_sort(ex, first, last);
+  }
+  else {
+    merge_sort(ex, first, last, comp);
+  }
+}
+
+template <typename Execution, typename RandomIt, typename Compare>
+void sort(const Execution & ex, RandomIt first, RandomIt last, 
+          Compare & comp, std::false_type)
+{
+  merge_sort(ex, first, last, comp);
+}
+
+} // namespace internal
+
+/** 
+\addtogroup data_patterns
+@{
+\defgroup sort_pattern Sort pattern
+\brief Interface for applying the \ref md_sort.
+@{
+*/
+
+/**
+\brief Invoke \ref md_sort on a data sequence, sorting it in place. The sort
+is stable.
+\tparam Execution Execution type.
+\tparam RandomIt Iterator type used for the sequence. It must be a random
+access iterator.
+\tparam Compare Callable type for the comparison.
+\param ex Execution policy object.
+\param first Iterator to the first element in the sequence.
+\param last Iterator to one past the end of the sequence.
+\param comp Strict weak ordering comparison.
+\note Large sequences of integral values compared with std::less are sorted
+with a radix sort.
+*/
+template <typename Execution, typename RandomIt, typename Compare,
+          requires_iterator<RandomIt> = 0>
+void sort(const Execution & ex, RandomIt first, RandomIt last, Compare comp)
+{
+  static_assert(supports_map<Execution>(),
+      "map not supported on execution type");
+  static_assert(std::is_base_of<std::random_access_iterator_tag,
+      typename std::iterator_traits<RandomIt>::iterator_category>::value,
+      "sort requires random access iterators");
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  internal::sort(ex, first, last, comp, std::integral_constant<bool,
+      internal::is_radix_sortable<value_type,Compare>()>{});
+}
+
+/**
+\brief Invoke \ref md_sort on a data sequence, sorting it in place in 
+ascending order. The sort is stable.
+\tparam Execution Execution type.
+\tparam RandomIt Iterator type used for the sequence. It must be a random
+access iterator.
+\param ex Execution policy object.
+\param first Iterator to the first element in the sequence.
+\param last Iterator to one past the end of the sequence.
+*/
+template <typename Execution, typename RandomIt,
+          requires_iterator<RandomIt> = 0>
+void sort(const Execution & ex, RandomIt first, RandomIt last)
+{
+  grppi::sort(ex, first, last, std::less<>{});
+}
+
+/**
+\brief Invoke \ref md_sort on a data sequence, leaving the sorted sequence in
+another sequence. The sort is stable.
+\tparam Execution Execution type.
+\tparam InputIt Iterator type used for the input sequence.
+\tparam RandomIt Iterator type used for the output sequence. It must be a 
+random access iterator.
+\tparam Compare Callable type for the comparison.
+\param ex Execution policy object.
+\param first Iterator to the first element in the input sequence.
+\param last Iterator to one past the end of the input sequence.
+\param first_out Iterator to the first element in the output sequence.
+\param comp Strict weak ordering comparison.
+\return Iterator to one past the end of the output sequence.
+*/
+template <typename Execution, typename InputIt, typename RandomIt, 
+          typename Compare = std::less<>,
+          requires_iterator<InputIt> = 0,
+          requires_iterator<RandomIt> = 0>
+RandomIt sort_copy(const Execution & ex, InputIt first, InputIt last, 
+                   RandomIt first_out, Compare comp = Compare{})
+{
+  static_assert(supports_map<Execution>(),
+      "map not supported on execution type");
+  using value_type = typename std::iterator_traits<InputIt>::value_type;
+  const auto size = std::distance(first, last);
+  ex.map(std::make_tuple(first), first_out, size,
+      [](const value_type & x) { return x; });
+  const auto last_out = std::next(first_out, size);
+  grppi::sort(ex, first_out, last_out, comp);
+  return last_out;
+}
+
+/**
+@}
+@}
+*/
+
+}
+
+#endif
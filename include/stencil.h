@@ -26,6 +26,8 @@
 
 #include "common/execution_traits.h"
 #include "common/iterator_traits.h"
+#include "common/grid_stencil.h"
+#include "common/fixed_neighbourhood.h"
 
 namespace grppi {
 
@@ -50,7 +52,8 @@ sequential execution.
 \param last Iterator to one past the end of the input sequence.
 \param out Iterator to the first element in the output sequence.
 \param transform_op Stencil transformation operation.
-\param neighbour_op Neighbourhood operation.
+\param neighbour_op Neighbourhood operation, or a neighbour_offsets object
+for a neighbourhood with fixed offsets.
 */
 template <typename Execution, typename InputIt, typename OutputIt, 
           typename StencilTransformer, typename Neighbourhood,
@@ -64,10 +67,11 @@ void stencil(
 {
   static_assert(supports_stencil<Execution>(),
       "stencil not supported for execution type");
-  ex.stencil(std::make_tuple(first), out,
-      std::distance(first,last),
+  const auto size = std::distance(first,last);
+  ex.stencil(std::make_tuple(first), out, size,
       std::forward<StencilTransformer>(transform_op),
-      std::forward<Neighbourhood>(neighbour_op));
+      internal::bind_neighbourhood(first, size,
+          std::forward<Neighbourhood>(neighbour_op)));
 }
 
 /**
@@ -84,7 +88,8 @@ sequential execution.
 \param last Iterator to one past the end of the input sequence.
 \param out Iterator to the first element in the output sequence.
 \param transform_op Stencil transformation operation.
-\param neighbour_op Neighbourhood operation.
+\param neighbour_op Neighbourhood operation, or a neighbour_offsets object
+for a neighbourhood with fixed offsets.
 \param other_firsts Iterators to the first element of additional input sequences.
 */
 template <typename Execution, typename InputIt, typename OutputIt, 
@@ -101,10 +106,100 @@ void stencil(
 {
   static_assert(supports_stencil<Execution>(),
       "stencil not supported for execution type");
-  ex.stencil(std::make_tuple(first,other_firsts...), out,
-      std::distance(first,last),
+  const auto size = std::distance(first,last);
+  ex.stencil(std::make_tuple(first,other_firsts...), out, size,
       std::forward<StencilTransformer>(transform_op),
-      std::forward<Neighbourhood>(neighbour_op));
+      internal::bind_neighbourhood(first, size,
+          std::forward<Neighbourhood>(neighbour_op)));
+}
+
+/**
+\brief Invoke \ref md_stencil on a multi-dimensional grid.
+The grid is processed by tiles, which are distributed among the threads of the
+execution policy.
+\tparam Execution Execution type.
+\tparam D Number of dimensions of the grid.
+\tparam InputIt Random access iterator type used for the input grid.
+\tparam OutputIt Random access iterator type used for the output grid.
+\tparam StencilTransformer Callable type for performing the stencil 
+transformation.
+\param ex Execution policy object.
+\param shape Shape of the grid (extents, halo width, boundary policy and
+tile size).
+\param first Iterator to the first element of the input grid.
+\param out Iterator to the first element of the output grid.
+\param transform_op Stencil transformation operation. It is invoked with a 
+grid_neighbourhood giving access to the neighbours of every element.
+\pre Input and output grids do not overlap.
+*/
+template <typename Execution, std::size_t D, typename InputIt, 
+          typename OutputIt, typename StencilTransformer,
+          requires_iterator<InputIt> = 0,
+          requires_iterator<OutputIt> = 0>
+void stencil(
+    const Execution & ex, 
+    const grid_shape<D> & shape,
+    InputIt first, OutputIt out, 
+    StencilTransformer && transform_op)
+{
+  static_assert(supports_stencil<Execution>(),
+      "stencil not supported for execution type");
+  ex.stencil(shape, first, out, 1,
+      std::forward<StencilTransformer>(transform_op));
+}
+
+/**
+\brief Invoke \ref md_stencil on a multi-dimensional grid for a number of
+time steps.
+Every step reads the grid produced by the previous one. Steps are computed in
+blocks of shape.time_tile steps (temporal blocking): every tile computes all 
+the steps of a block on a local copy extended by the halo of those steps, so 
+that it stays in cache and tiles do not synchronize within a block. Two 
+buffers are used alternatively as input and output of the blocks (double 
+buffering).
+\tparam Execution Execution type.
+\tparam D Number of dimensions of the grid.
+\tparam RandomIt Random access iterator type used for the grids.
+\tparam StencilTransformer Callable type for performing the stencil 
+transformation.
+\param ex Execution policy object.
+\param shape Shape of the grid (extents, halo width, boundary policy, tile 
+size and time steps per tile).
+\param first Iterator to the first element of the grid. After the last step
+the grid holds the result.
+\param buffer Iterator to the first element of an auxiliary grid with the
+same shape.
+\param num_steps Number of time steps.
+\param transform_op Stencil transformation operation. It is invoked with a 
+grid_neighbourhood giving access to the neighbours of every element.
+*/
+template <typename Execution, std::size_t D, typename RandomIt, 
+          typename StencilTransformer,
+          requires_iterator<RandomIt> = 0>
+void stencil(
+    const Execution & ex, 
+    const grid_shape<D> & shape,
+    RandomIt first, RandomIt buffer, 
+    std::size_t num_steps,
+    StencilTransformer && transform_op)
+{
+  static_assert(supports_stencil<Execution>(),
+      "stencil not supported for execution type");
+  const auto time_tile = grid_tiling<D>{shape}.time_tile();
+  std::size_t num_blocks = 0;
+  for (std::size_t step=0; step<num_steps; step+=time_tile, ++num_blocks) {
+    const auto steps = std::min(time_tile, num_steps - step);
+    if (num_blocks % 2 == 0) {
+      ex.stencil(shape, first, buffer, steps, transform_op);
+    }
+    else {
+      ex.stencil(shape, buffer, first, steps, transform_op);
+    }
+  }
+  if (num_blocks % 2 != 0) {
+    ex.map(std::make_tuple(buffer), first, shape.size(), 
+        [](const auto & x) { return x; });
+  }
 }
 
 /**
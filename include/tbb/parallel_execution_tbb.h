@@ -25,17 +25,62 @@
 
 #include "../common/mpmc_queue.h"
 #include "../common/iterator.h"
+#include "../common/cache_aligned.h"
+#include "../common/grid_stencil.h"
+#include "../common/scan_mode.h"
 #include "../common/patterns.h"
 #include "../common/farm_pattern.h"
 #include "../common/execution_traits.h"
 
 #include <type_traits>
 #include <tuple>
+#include <functional>
 
 #include <tbb/tbb.h>
 
 namespace grppi {
 
+/**
+\brief Scratch storage with one lazily created instance per TBB thread.
+Provides the same interface as per_thread_storage on top of a 
+tbb::enumerable_thread_specific.
+\tparam T Type of the per thread instances.
+*/
+template <typename T>
+class tbb_thread_storage {
+public:
+  using value_type = T;
+
+  /**
+  \brief Creates an empty storage.
+  \param init_op Callable object returning the initial value of an instance.
+  */
+  explicit tbb_thread_storage(std::function<T()> init_op) 
+      : storage_{std::move(init_op)} {}
+
+  /**
+  \brief Get the instance of the calling thread, creating it if needed.
+  */
+  T & local() { return storage_.local(); }
+
+  /**
+  \brief Applies an operation to every instance created so far.
+  \pre No thread is calling local() concurrently.
+  */
+  template <typename F>
+  void for_each(F && f) {
+    for (auto & instance : storage_) { f(instance); }
+  }
+
+  /**
+  \brief Get the number of instances created so far.
+  */
+  int size() const noexcept { return static_cast<int>(storage_.size()); }
+
+private:
+  tbb::enumerable_thread_specific<T> storage_;
+};
+
 /** 
  \brief TBB parallel execution policy.
 
@@ -94,6 +139,25 @@ public:
   */
   bool is_ordered() const noexcept { return ordering_; }
 
+  /**
+  \brief Enable parallel combination of partial results.
+  Partial results of map_reduce are combined with a tbb::parallel_reduce. 
+  Useful for expensive combiners. Partial results of reduce are always 
+  combined by tbb::parallel_reduce.
+  */
+  void enable_parallel_combine() noexcept { parallel_combine_ = true; }
+
+  /**
+  \brief Disable parallel combination of partial results.
+  Partial results of map_reduce are combined in order by the calling thread.
+  */
+  void disable_parallel_combine() noexcept { parallel_combine_ = false; }
+
+  /**
+  \brief Are partial results combined in parallel.
+  */
+  bool is_parallel_combine() const noexcept { return parallel_combine_; }
+
   /**
   \brief Sets the attributes for the queues built through make_queue<T>()
   */
@@ -113,6 +177,26 @@ public:
     return {queue_size_, queue_mode_};
   }
 
+  /**
+  \brief Makes a scratch storage with one lazily created instance of T per 
+  thread.
+  Instances are kept in a tbb::enumerable_thread_specific.
+  \tparam T Type of the per thread instances.
+  \param init_op Callable object returning the initial value of an instance.
+  By default, instances are value initialized.
+  \return A storage whose member local() returns the instance of the 
+  calling thread, and whose member for_each() visits all the instances.
+  */
+  template <typename T, typename Initializer>
+  auto thread_local_storage(Initializer && init_op) const {
+    return tbb_thread_storage<T>{std::forward<Initializer>(init_op)};
+  }
+
+  template <typename T>
+  auto thread_local_storage() const {
+    return thread_local_storage<T>([]() { return T{}; });
+  }
+
   /**
   \brien Get num of tokens.
   */
@@ -176,6 +260,28 @@ public:
                   Identity && identity,
                   Transformer && transform_op, Combiner && combine_op) const;
 
+  /**
+  \brief Applies a scan (prefix combination) to a sequence of data items.
+  \tparam InputIterator Iterator type for the input sequence.
+  \tparam OutputIterator Iterator type for the output sequence.
+  \tparam Identity Type for the identity value.
+  \tparam Combiner Callable object type for the combination.
+  \param first Iterator to the first element of the sequence.
+  \param first_out Iterator to the first element of the output sequence.
+  \param sequence_size Size of the input sequence.
+  \param identity Identity value for the combination.
+  \param combine_op Associative combination callable object.
+  \param mode Inclusive or exclusive scan.
+  \pre Iterators in the ranges `[first, next(first,sequence_size))` and
+  `[first_out, next(first_out,sequence_size))` are valid. 
+  \return The combination of the identity and all the elements.
+  */
+  template <typename InputIterator, typename OutputIterator, 
+            typename Identity, typename Combiner>
+  auto scan(InputIterator first, OutputIterator first_out, 
+            std::size_t sequence_size, Identity && identity, 
+            Combiner && combine_op, scan_mode mode) const;
+
   /**
   \brief Applies a trasnformation to multiple sequences leaving the result in
   another sequence.
@@ -197,6 +303,28 @@ public:
                StencilTransformer && transform_op,
                Neighbourhood && neighbour_op) const;
 
+  /**
+  \brief Applies a number of time steps of a stencil to a multi-dimensional 
+  grid leaving the result in another grid.
+  \tparam InputIt Random access iterator type for the input grid.
+  \tparam OutputIt Random access iterator type for the output grid.
+  \tparam D Number of dimensions of the grid.
+  \tparam StencilTransformer Callable object type for the stencil 
+  transformation.
+  \param shape Shape of the grid.
+  \param first Iterator to the first element of the input grid.
+  \param first_out Iterator to the first element of the output grid.
+  \param num_steps Number of time steps computed per tile without 
+  synchronization.
+  \param transform_op Stencil transformation callable object invoked with a
+  grid_neighbourhood.
+  */
+  template <typename InputIt, typename OutputIt, std::size_t D,
+            typename StencilTransformer>
+  void stencil(const grid_shape<D> & shape, InputIt first, 
+               OutputIt first_out, std::size_t num_steps,
+               StencilTransformer && transform_op) const;
+
   /**
   \brief Invoke \ref md_divide-conquer.
   \tparam Input Type used for the input problem.
@@ -215,6 +343,27 @@ public:
                       Solver && solve_op, 
                       Combiner && combine_op) const; 
 
+  /**
+  \brief Invoke \ref md_divide-conquer with a base case predicate.
+  \tparam Input Type used for the input problem.
+  \tparam Divider Callable type for the divider operation.
+  \tparam Predicate Callable type for the base case predicate.
+  \tparam Solver Callable type for the solver operation.
+  \tparam Combiner Callable type for the combiner operation.
+  \param input Input problem to be solved.
+  \param divider_op Divider operation.
+  \param predicate_op Base case predicate operation.
+  \param solver_op Solver operation.
+  \param combine_op Combiner operation.
+  */
+  template <typename Input, typename Divider, typename Predicate, 
+            typename Solver, typename Combiner>
+  auto divide_conquer(Input && input, 
+                      Divider && divide_op, 
+                      Predicate && predicate_op,
+                      Solver && solve_op, 
+                      Combiner && combine_op) const; 
+
   /**
   \brief Invoke \ref md_pipeline.
   \tparam Generator Callable type for the generator operation.
@@ -382,6 +531,8 @@ private:
 
   bool ordering_ = true;
 
+  bool parallel_combine_ = false;
+
   constexpr static int default_queue_size = 100;
   int queue_size_ = default_queue_size;
 
@@ -428,6 +579,13 @@ constexpr bool supports_reduce<parallel_execution_tbb>() { return true; }
 template <>
 constexpr bool supports_map_reduce<parallel_execution_tbb>() { return true; }
 
+/**
+\brief Determines if an execution policy supports the scan pattern.
+\note Specialization for parallel_execution_tbb when GRPPI_TBB is enabled.
+*/
+template <>
+constexpr bool supports_scan<parallel_execution_tbb>() { return true; }
+
 /**
 \brief Determines if an execution policy supports the stencil pattern.
 \note Specialization for parallel_execution_omp when GRPPI_TBB is enabled.
@@ -456,12 +614,14 @@ void parallel_execution_tbb::map(
     OutputIterator first_out, 
     std::size_t sequence_size, Transformer transform_op) const
 {
+  constexpr sequential_execution seq;
   tbb::parallel_for(
-    std::size_t{0}, sequence_size, 
-    [&] (std::size_t index){
-      first_out[index] = apply_iterators_indexed(transform_op, firsts, index);
+    tbb::blocked_range<std::size_t>{0, sequence_size}, 
+    [&] (const tbb::blocked_range<std::size_t> & range) {
+      seq.map(iterators_next(firsts, range.begin()), 
+          std::next(first_out, range.begin()), range.size(), transform_op);
     }
- );   
+  );
 
 }
 
@@ -494,11 +654,12 @@ auto parallel_execution_tbb::map_reduce(
   tbb::task_group g;
 
   using result_type = std::decay_t<Identity>;
-  std::vector<result_type> partial_results(concurrency_degree_);
+  cache_aligned_vector<result_type> partial_results(concurrency_degree_);
 
   auto process_chunk = [&](auto fins, std::size_t sz, std::size_t i) {
-    partial_results[i] = seq.map_reduce(fins, sz,
-        std::forward<result_type>(partial_results[i]),
+    // Accumulate locally and write the partial result once
+    partial_results[i].value = seq.map_reduce(fins, sz,
+        identity,
         std::forward<Transformer>(transform_op), 
         std::forward<Combiner>(combine_op));
   };
@@ -521,9 +682,58 @@ auto parallel_execution_tbb::map_reduce(
 
   g.wait(); 
 
-  return seq.reduce(std::next(partial_results.begin()), 
-      partial_results.size()-1, std::forward<result_type>(partial_results[0]), 
-      std::forward<Combiner>(combine_op));
+  if (parallel_combine_) {
+    // Subranges are joined left to right, keeping the order of the partials
+    return tbb::parallel_reduce(
+        tbb::blocked_range<std::size_t>{0, partial_results.size()},
+        result_type{identity},
+        [&](const tbb::blocked_range<std::size_t> & range, result_type value) {
+          for (auto i=range.begin(); i!=range.end(); ++i) {
+            value = combine_op(value, partial_results[i].value);
+          }
+          return value;
+        },
+        [&](const result_type & x, const result_type & y) { 
+          return combine_op(x, y); 
+        });
+  }
+
+  auto result = std::move(partial_results[0].value);
+  for (std::size_t i=1; i<partial_results.size(); ++i) {
+    result = combine_op(result, partial_results[i].value);
+  }
+  return result;
+}
+
+template <typename InputIterator, typename OutputIterator, 
+          typename Identity, typename Combiner>
+auto parallel_execution_tbb::scan(
+    InputIterator first, OutputIterator first_out,
+    std::size_t sequence_size,
+    Identity && identity,
+    Combiner && combine_op,
+    scan_mode mode) const
+{
+  using result_type = std::decay_t<Identity>;
+  return tbb::parallel_scan(
+      tbb::blocked_range<std::size_t>{0, sequence_size},
+      result_type{identity},
+      [&](const tbb::blocked_range<std::size_t> & range, result_type value, 
+          bool is_final) {
+        auto in = std::next(first, range.begin());
+        if (!is_final) {
+          for (auto i=range.begin(); i!=range.end(); ++i) {
+            value = combine_op(value, *in++);
+          }
+          return value;
+        }
+        constexpr sequential_execution seq;
+        return seq.scan(in, std::next(first_out, range.begin()), range.size(),
+            value, combine_op, mode);
+      },
+      [&](const result_type & x, const result_type & y) { 
+        return combine_op(x, y); 
+      });
 }
 
 template <typename ... InputIterators, typename OutputIterator,
@@ -560,6 +770,24 @@ void parallel_execution_tbb::stencil(
   g.wait();
 }
 
+template <typename InputIt, typename OutputIt, std::size_t D,
+          typename StencilTransformer>
+void parallel_execution_tbb::stencil(
+    const grid_shape<D> & shape, 
+    InputIt first, OutputIt first_out, 
+    std::size_t num_steps,
+    StencilTransformer && transform_op) const
+{
+  grid_tiling<D> tiling{shape};
+  tbb::parallel_for(
+    tbb::blocked_range<std::size_t>{0, tiling.num_tiles()},
+    [&](const tbb::blocked_range<std::size_t> & range) {
+      grid_stencil_tiles(shape, tiling, first, first_out, num_steps,
+          transform_op, range.begin(), range.end());
+    }
+  );
+}
+
 template <typename Input, typename Divider, typename Solver, typename Combiner>
 auto parallel_execution_tbb::divide_conquer(
     Input && input, 
@@ -573,6 +801,47 @@ auto parallel_execution_tbb::divide_conquer(
         std::forward<Combiner>(combine_op), num_threads);
 }
 
+template <typename Input, typename Divider, typename Predicate, 
+          typename Solver, typename Combiner>
+auto parallel_execution_tbb::divide_conquer(
+    Input && input, 
+    Divider && divide_op, 
+    Predicate && predicate_op,
+    Solver && solve_op, 
+    Combiner && combine_op) const
+{
+  if (predicate_op(input)) { return solve_op(std::forward<Input>(input)); }
+  auto subproblems = divide_op(std::forward<Input>(input));
+  if (subproblems.size()<=1) { return solve_op(std::forward<Input>(input)); }
+
+  using subresult_type = std::decay_t<typename std::result_of<Solver(Input)>::type>;
+  std::vector<subresult_type> partials(subproblems.size()-1);
+
+  tbb::task_group g;
+  for (std::size_t i=1; i<subproblems.size(); ++i) {
+    g.run([&,this,i]() {
+      partials[i-1] = this->divide_conquer(std::forward<Input>(subproblems[i]), 
+          std::forward<Divider>(divide_op), 
+          std::forward<Predicate>(predicate_op), 
+          std::forward<Solver>(solve_op), 
+          std::forward<Combiner>(combine_op));
+    });
+  }
+
+  //Main thread works on the first subproblem.
+  auto out = divide_conquer(std::forward<Input>(subproblems[0]),  
+      std::forward<Divider>(divide_op), 
+      std::forward<Predicate>(predicate_op), 
+      std::forward<Solver>(solve_op), 
+      std::forward<Combiner>(combine_op));
+
+  g.wait();
+
+  constexpr sequential_execution seq;
+  return seq.reduce(partials.begin(), partials.size(), 
+      std::forward<subresult_type>(out), std::forward<Combiner>(combine_op));
+}
+
 template <typename Generator, typename ... Transformers>
 void parallel_execution_tbb::pipeline(
     Generator && generate_op, 
@@ -27,6 +27,7 @@
 #include <numeric>
 #include <stdexcept>
 #include <random>
+#include <algorithm>
 
 // grppi
 #include "grppi.h"
@@ -65,13 +66,15 @@ void sort_sequence(grppi::dynamic_execution & exec, int n) {
   
   range problem{begin(v), end(v)};
 
+  constexpr int cutoff = 64;
   auto res = grppi::divide_conquer(exec,
     problem,
-    [](auto r) -> vector<range> {
-      if (1>=r.size()) { return {r}; }
-      else { return divide(r); }
+    [](auto r) -> vector<range> { return divide(r); },
+    [](auto r) { return r.size() <= cutoff; },
+    [](auto r) {
+      std::sort(r.first, r.last);
+      return r;
     },
-    [](auto x) { return x; },
     [](auto r1, auto r2) {
       std::inplace_merge(r1.first, r1.last, r2.last);
       return range{r1.first, r2.last};
@@ -0,0 +1,95 @@
+/**
+* @version    GrPPI v0.1
+* @copyright    Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license    GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+// Standard library
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <numeric>
+#include <stdexcept>
+
+// grppi
+#include "grppi.h"
+
+// Samples shared utilities
+#include "../../util/util.h"
+
+void even_squares(grppi::dynamic_execution & e, int n) {
+  using namespace std;
+  using namespace chrono;
+
+  vector<long> v(n);
+  iota(begin(v), end(v), 0);
+
+  // Two patterns with an intermediate sequence
+  auto t1 = steady_clock::now();
+  vector<long> squares(n);
+  grppi::map(e, begin(v), end(v), begin(squares), 
+      [](long x) { return (x % 2 == 0) ? x*x : 0; });
+  auto unfused = grppi::reduce(e, begin(squares), end(squares), 0L,
+      [](long x, long y) { return x + y; });
+  auto t2 = steady_clock::now();
+
+  // Single pass without intermediate sequence
+  auto fused = grppi::lazy_map(e, begin(v), end(v), 
+        [](long x) { return x*x; })
+    | grppi::keep([](long x) { return x % 2 == 0; })
+    | grppi::fold(0L, [](long x, long y) { return x + y; });
+  auto t3 = steady_clock::now();
+
+  cout << "Two passes: " << unfused << " in " 
+       << duration_cast<microseconds>(t2-t1).count() << " us" << endl;
+  cout << "Single pass: " << fused << " in " 
+       << duration_cast<microseconds>(t3-t2).count() << " us" << endl;
+}
+
+void print_message(const std::string & prog, const std::string & msg) {
+  using namespace std;
+
+  cerr << msg << endl;
+  cerr << "Usage: " << prog << " size mode" << endl;
+  cerr << "  size: Integer value with problem size" << endl;
+  cerr << "  mode:" << endl;
+  print_available_modes(cerr);
+}
+
+
+int main(int argc, char **argv) {
+    
+  using namespace std;
+
+  if(argc < 3){
+    print_message(argv[0], "Invalid number of arguments.");
+    return -1;
+  }
+
+  int n = stoi(argv[1]);
+  if(n <= 0){
+    print_message(argv[0], "Invalid problem size. Use a positive number.");
+    return -1;
+  }
+
+  if (!run_test(argv[2], even_squares, n)) {
+    print_message(argv[0], "Invalid policy.");
+    return -1;
+  }
+
+  return 0;
+}
@@ -22,6 +22,8 @@
 #include <iterator>
 #include <vector>
 #include <map>
+#include <functional>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <chrono>
@@ -44,20 +46,18 @@ void test_mapreduce(grppi::dynamic_execution & ex,
   copy(istream_iterator<string>{file}, istream_iterator<string>{},
     back_inserter(words));
 
-  // Word count for vector of lines
-  auto result = map_reduce(ex,
-    words.begin(), words.end(), map<string,int>{},
-    [](string word) -> map<string,int> { return {{word,1}}; },
-    [](map<string,int> & lhs, const map<string,int> & rhs) -> map<string,int> & {
-      for (auto & w : rhs) {
-        lhs[w.first]+= w.second;
-      }
-      return lhs;
-    }
+  // Every word counts as one appearance of itself
+  auto result = grppi::reduce_by_key(ex, words.begin(), words.end(),
+    [](const string & w) { return w; },
+    0,
+    [](const string &) { return 1; },
+    [](int x, int y) { return x + y; }
   );
 
+  map<string,int> counts{result.begin(), result.end()};
+
   cout << "Word : count " << endl;
-  for (const auto & w : result) {
+  for (const auto & w : counts) {
     cout << w.first << " : " << w.second << endl;
   }
 }
@@ -88,10 +88,12 @@ int main(int argc, char **argv) {
     return -1;
   }
 
-  if (!run_test(argv[2], test_mapreduce, file)) {
+  auto ex = execution_mode(argv[2]);
+  if (!ex.has_execution()) {
     print_message(argv[0], "Invalid policy.");
     return -1;
   }
+  test_mapreduce(ex, file);
 
   return 0;
 }
@@ -49,11 +49,12 @@ void test_map(grppi::dynamic_execution & e, int n) {
     [&]() { return value_gen(rengine); });
   double a = coef_gen(rengine);
 
+  // Vectorized transformer invoked with batches of values of x and y
   grppi::map(e, begin(x), end(x), begin(y),
-    [a](int vx, int vy) { return a * vx + vy; },
+    grppi::vectorize([a](auto vx, auto vy) { return a * vx + vy; }),
     begin(y));
 
-  copy(begin(y), end(y), ostream_iterator<int>(cout, " "));
+  copy(begin(y), end(y), ostream_iterator<double>(cout, " "));
   cout << endl;
 }
 
@@ -0,0 +1,161 @@
+/**
+* @version    GrPPI v0.1
+* @copyright    Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license    GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+// Standard library
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <memory>
+#include <numeric>
+
+// grppi
+#include "grppi.h"
+#include "dyn/dynamic_execution.h"
+
+/*
+Dispatch through a heap allocated policy and a chain of dynamic_cast, as 
+done by former versions of dynamic_execution. Kept here as a baseline.
+*/
+class cast_dispatch_execution {
+public:
+  template <typename E>
+  cast_dispatch_execution(const E & e) : 
+    execution_{std::make_unique<execution<E>>(e)} {}
+
+  template <typename ... InputIterators, typename OutputIterator, 
+            typename Transformer>
+  void map(std::tuple<InputIterators...> firsts, OutputIterator first_out, 
+           std::size_t sequence_size, Transformer && transform_op) const 
+  {
+    using namespace grppi;
+    if (try_map<sequential_execution>(firsts, first_out, sequence_size, 
+        transform_op)) return;
+    if (try_map<parallel_execution_native>(firsts, first_out, sequence_size, 
+        transform_op)) return;
+#ifdef GRPPI_OMP
+    if (try_map<parallel_execution_omp>(firsts, first_out, sequence_size, 
+        transform_op)) return;
+#endif
+  }
+
+private:
+  class execution_base {
+  public:
+    virtual ~execution_base() {};
+  };
+
+  template <typename E>
+  class execution : public execution_base {
+  public:
+    execution(const E & e) : ex_{e} {}
+    E ex_;
+  };
+
+  template <typename E, typename ... Args>
+  bool try_map(Args && ... args) const {
+    auto * ex = dynamic_cast<execution<E>*>(execution_.get());
+    if (!ex) return false;
+    ex->ex_.map(std::forward<Args>(args)...);
+    return true;
+  }
+
+private:
+  std::unique_ptr<execution_base> execution_;
+};
+
+namespace grppi {
+template <>
+constexpr bool supports_map<cast_dispatch_execution>() { return true; }
+}
+
+template <typename Execution>
+double measure(const Execution & ex, std::vector<int> & v, int iterations) {
+  using namespace std;
+  using namespace chrono;
+
+  auto t1 = steady_clock::now();
+  for (int i=0; i<iterations; ++i) {
+    grppi::map(ex, begin(v), end(v), begin(v), [](int x) { return x+1; });
+  }
+  auto t2 = steady_clock::now();
+  return duration_cast<duration<double,nano>>(t2-t1).count() / iterations;
+}
+
+template <typename Execution>
+void run_benchmark(const std::string & name, const Execution & ex, 
+                   int n, int iterations)
+{
+  using namespace std;
+
+  vector<int> v(n);
+  const double direct = measure(ex, v, iterations);
+  const double tagged = measure(grppi::dynamic_execution{ex}, v, iterations);
+  const double cast = measure(cast_dispatch_execution{ex}, v, iterations);
+  if (accumulate(begin(v), end(v), 0L) != 3L * n * iterations) {
+    cerr << "Unexpected result" << endl;
+  }
+
+  cout << setw(8) << name 
+       << setw(16) << direct << setw(16) << tagged << setw(16) << cast << endl;
+}
+
+void dispatch_overhead(int n, int iterations) {
+  using namespace std;
+
+  cout << "Time per map call (ns)" << endl;
+  cout << setw(8) << "policy" << setw(16) << "direct" 
+       << setw(16) << "dynamic" << setw(16) << "dynamic_cast" << endl;
+  run_benchmark("seq", grppi::sequential_execution{}, n, iterations);
+  run_benchmark("thr", grppi::parallel_execution_native{}, n, iterations);
+#ifdef GRPPI_OMP
+  run_benchmark("omp", grppi::parallel_execution_omp{}, n, iterations);
+#endif
+}
+
+void print_message(const std::string & prog, const std::string & msg) {
+  using namespace std;
+
+  cerr << msg << endl;
+  cerr << "Usage: " << prog << " size iterations" << endl;
+  cerr << "  size: Number of elements in every map" << endl;
+  cerr << "  iterations: Number of map calls per measure" << endl;
+}
+
+int main(int argc, char **argv) {
+    
+  using namespace std;
+
+  if(argc < 3){
+    print_message(argv[0], "Invalid number of arguments.");
+    return -1;
+  }
+
+  int n = stoi(argv[1]);
+  int iterations = stoi(argv[2]);
+  if(n <= 0 || iterations <= 0){
+    print_message(argv[0], "Invalid arguments. Use positive numbers.");
+    return -1;
+  }
+
+  dispatch_overhead(n, iterations);
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+/**
+* @version    GrPPI v0.1
+* @copyright    Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license    GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+// Standard library
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <numeric>
+#include <stdexcept>
+
+// grppi
+#include "grppi.h"
+#include "dyn/dynamic_execution.h"
+
+grppi::thread_placement placement_from_name(const std::string & name) {
+  using grppi::thread_placement;
+  if (name == "none") return thread_placement::none;
+  if (name == "compact") return thread_placement::compact;
+  if (name == "scatter") return thread_placement::scatter;
+  if (name == "numa") return thread_placement::numa_node;
+  throw std::invalid_argument{"Invalid placement: " + name};
+}
+
+void first_touch(int n, int iterations, grppi::thread_placement placement) {
+  using namespace std;
+  using namespace chrono;
+
+  grppi::parallel_execution_native ex;
+  ex.set_thread_placement(placement);
+  ex.set_scheduling(grppi::scheduling_mode::pinned);
+
+  // Pages are placed in the NUMA node of the first thread writing them, so
+  // vectors are initialized by the same workers that will process them.
+  vector<double> x(n), y(n);
+  grppi::map(ex, begin(x), end(x), begin(x), [](double) { return 1.0; });
+  grppi::map(ex, begin(y), end(y), begin(y), [](double) { return 2.0; });
+
+  auto t1 = steady_clock::now();
+  for (int i=0; i<iterations; ++i) {
+    grppi::map(ex, begin(x), end(x), begin(y), 
+      [](double vx, double vy) { return 0.5 * vx + vy; },
+      begin(y));
+  }
+  auto t2 = steady_clock::now();
+  auto diff = duration_cast<milliseconds>(t2-t1);
+
+  cout << "Sum: " << accumulate(begin(y), end(y), 0.0) << endl;
+  cout << "Time: " << diff.count() << " ms" << endl;
+}
+
+void print_message(const std::string & prog, const std::string & msg) {
+  using namespace std;
+
+  cerr << msg << endl;
+  cerr << "Usage: " << prog << " size iterations placement" << endl;
+  cerr << "  size: Integer value with problem size" << endl;
+  cerr << "  iterations: Number of times the vectors are updated" << endl;
+  cerr << "  placement: none | compact | scatter | numa" << endl;
+}
+
+
+int main(int argc, char **argv) {
+    
+  using namespace std;
+
+  if(argc < 4){
+    print_message(argv[0], "Invalid number of arguments.");
+    return -1;
+  }
+
+  int n = stoi(argv[1]);
+  int iterations = stoi(argv[2]);
+  if(n <= 0 || iterations < 0){
+    print_message(argv[0], "Invalid problem size. Use a positive number.");
+    return -1;
+  }
+
+  try {
+    first_touch(n, iterations, placement_from_name(argv[3]));
+  }
+  catch (std::invalid_argument & e) {
+    print_message(argv[0], e.what());
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,210 @@
+/**
+* @version    GrPPI v0.1
+* @copyright    Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license    GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+// Standard library
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <stdexcept>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+// grppi
+#include "common/mpmc_queue.h"
+
+/*
+Lock-based queue used by former versions of mpmc_queue. In lock-free mode
+every push and pop reserves a position and then spins until the positions 
+before it have been published. Kept here as a baseline.
+*/
+template <typename T>
+class former_mpmc_queue {
+public:
+  former_mpmc_queue(int size, grppi::queue_mode mode) :
+    size_{size}, buffer_(size), mode_{mode} {}
+
+  T pop();
+  void push(T item);
+
+private:
+  bool is_empty(unsigned long long current) const noexcept {
+    return current >= pwrite_.load();
+  }
+
+  bool is_full(unsigned long long current) const noexcept {
+    return current >= pread_.load() + size_;
+  }
+
+private:
+  int size_;
+  std::vector<T> buffer_;
+  grppi::queue_mode mode_;
+
+  std::atomic<unsigned long long> pread_{0};
+  std::atomic<unsigned long long> pwrite_{0};
+  std::atomic<unsigned long long> internal_pread_{0};
+  std::atomic<unsigned long long> internal_pwrite_{0};
+
+  std::mutex mutex_;
+  std::condition_variable empty_;
+  std::condition_variable full_;
+};
+
+template <typename T>
+T former_mpmc_queue<T>::pop()
+{
+  if (mode_ == grppi::queue_mode::lockfree) {
+    auto current = internal_pread_++;
+    while (is_empty(current)) {}
+    auto item = std::move(buffer_[current % size_]);
+    auto expected = current;
+    while (!pread_.compare_exchange_weak(expected, current+1)) { 
+      expected = current; 
+    }
+    return item;
+  }
+
+  std::unique_lock<std::mutex> lock{mutex_};
+  while (is_empty(pread_)) { empty_.wait(lock); }
+  auto item = std::move(buffer_[pread_ % size_]);
+  pread_++;
+  lock.unlock();
+  full_.notify_one();
+  return item;
+}
+
+template <typename T>
+void former_mpmc_queue<T>::push(T item)
+{
+  if (mode_ == grppi::queue_mode::lockfree) {
+    auto current = internal_pwrite_++;
+    while (is_full(current)) {}
+    buffer_[current % size_] = std::move(item);
+    auto expected = current;
+    while (!pwrite_.compare_exchange_weak(expected, current+1)) { 
+      expected = current; 
+    }
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock{mutex_};
+  while (is_full(pwrite_)) { full_.wait(lock); }
+  buffer_[pwrite_ % size_] = std::move(item);
+  pwrite_++;
+  lock.unlock();
+  empty_.notify_one();
+}
+
+template <typename Queue>
+double measure(grppi::queue_mode mode, int queue_size, int num_threads, 
+               long num_items) 
+{
+  using namespace std;
+  using namespace chrono;
+
+  Queue queue{queue_size, mode};
+
+  auto t1 = steady_clock::now();
+
+  vector<thread> threads;
+  for (int i=0; i<num_threads; ++i) {
+    threads.emplace_back([&queue,num_items]() {
+      for (long j=0; j<num_items; ++j) { queue.push(j); }
+    });
+    threads.emplace_back([&queue,num_items]() {
+      long sum = 0;
+      for (long j=0; j<num_items; ++j) { sum += queue.pop(); }
+      if (sum < 0) cerr << "Unexpected sum" << endl;
+    });
+  }
+  for (auto & t : threads) { t.join(); }
+
+  auto t2 = steady_clock::now();
+  return duration_cast<duration<double>>(t2-t1).count();
+}
+
+void run_benchmark(grppi::queue_mode mode, int queue_size, long num_items, 
+                   int max_threads) 
+{
+  using namespace std;
+
+  cout << setw(10) << "threads" 
+       << setw(16) << "current (s)" << setw(16) << "items/s"
+       << setw(16) << "former (s)" << setw(16) << "items/s" << endl;
+  for (int n=1; n<=max_threads; n*=2) {
+    const double total = static_cast<double>(num_items) * n;
+    auto tc = measure<grppi::mpmc_queue<long>>(mode, queue_size, n, num_items);
+    auto tf = measure<former_mpmc_queue<long>>(mode, queue_size, n, num_items);
+    cout << setw(10) << n 
+         << setw(16) << tc << setw(16) << total / tc
+         << setw(16) << tf << setw(16) << total / tf << endl;
+  }
+}
+
+void run_benchmark(int queue_size, long num_items, int max_threads) {
+  using namespace std;
+
+  cout << "Blocking mode" << endl;
+  run_benchmark(grppi::queue_mode::blocking, queue_size, num_items, 
+      max_threads);
+  cout << endl << "Lock-free mode" << endl;
+  run_benchmark(grppi::queue_mode::lockfree, queue_size, num_items, 
+      max_threads);
+}
+
+void print_message(const std::string & prog, const std::string & msg) {
+  using namespace std;
+
+  cerr << msg << endl;
+  cerr << "Usage: " << prog << " items [max_threads] [queue_size]" << endl;
+  cerr << "  items: Number of items pushed by every producer" << endl;
+  cerr << "  max_threads: Maximum number of producers/consumers (default 64)" << endl;
+  cerr << "  queue_size: Capacity of the queue (default 100)" << endl;
+}
+
+int main(int argc, char **argv) {
+    
+  using namespace std;
+
+  if(argc < 2){
+    print_message(argv[0], "Invalid number of arguments.");
+    return -1;
+  }
+
+  long n = stol(argv[1]);
+  if(n <= 0){
+    print_message(argv[0], "Invalid number of items. Use a positive number.");
+    return -1;
+  }
+
+  int max_threads = (argc > 2) ? stoi(argv[2]) : 64;
+  int queue_size = (argc > 3) ? stoi(argv[3]) : 100;
+  if (max_threads <= 0 || queue_size <= 0) {
+    print_message(argv[0], "Invalid arguments. Use positive numbers.");
+    return -1;
+  }
+
+  run_benchmark(queue_size, n, max_threads);
+
+  return 0;
+}
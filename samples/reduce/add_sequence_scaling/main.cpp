@@ -0,0 +1,142 @@
+/**
+* @version    GrPPI v0.1
+* @copyright    Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license    GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+// Standard library
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <numeric>
+#include <stdexcept>
+
+// grppi
+#include "grppi.h"
+#include "dyn/dynamic_execution.h"
+#include "common/cache_aligned.h"
+
+template <typename F>
+double measure(int repetitions, F && f) {
+  using namespace std::chrono;
+  auto t1 = steady_clock::now();
+  for (int i=0; i<repetitions; ++i) { f(); }
+  auto t2 = steady_clock::now();
+  return duration_cast<duration<double>>(t2-t1).count() / repetitions;
+}
+
+// Every thread accumulates directly on its slot of a partials container
+template <typename Partials, typename Slot>
+long add_with_slots(const std::vector<long> & v, int num_threads, 
+                    Partials & partials, Slot && slot)
+{
+  using namespace std;
+  const auto chunk = v.size() / num_threads;
+  vector<thread> threads;
+  for (int i=0; i<num_threads; ++i) {
+    threads.emplace_back([&,i]() {
+      auto & acc = slot(partials[i]);
+      acc = 0;
+      const auto last = (i==num_threads-1) ? v.size() : chunk*(i+1);
+      for (auto j=chunk*i; j<last; ++j) { acc += v[j]; }
+    });
+  }
+  for (auto & t : threads) { t.join(); }
+  long result = 0;
+  for (auto & p : partials) { result += slot(p); }
+  return result;
+}
+
+void run_benchmark(long n, int max_threads, int repetitions) {
+  using namespace std;
+
+  vector<long> v(n);
+  iota(begin(v), end(v), 1L);
+  const long expected = n * (n+1) / 2;
+
+  cout << setw(10) << "threads" 
+       << setw(18) << "contiguous (ms)" 
+       << setw(18) << "padded (ms)" 
+       << setw(18) << "grppi thr (ms)" << endl;
+  for (int nt=1; nt<=max_threads; nt*=2) {
+    long r1 = 0, r2 = 0, r3 = 0;
+
+    vector<long> contiguous(nt);
+    auto t1 = measure(repetitions, [&]() {
+      r1 = add_with_slots(v, nt, contiguous, [](long & x) -> long & { return x; });
+    });
+
+    grppi::cache_aligned_vector<long> padded(nt);
+    auto t2 = measure(repetitions, [&]() {
+      r2 = add_with_slots(v, nt, padded, 
+          [](grppi::cache_aligned<long> & x) -> long & { return x.value; });
+    });
+
+    grppi::parallel_execution_native ex{nt};
+    auto t3 = measure(repetitions, [&]() {
+      r3 = grppi::reduce(ex, begin(v), end(v), 0L,
+          [](long x, long y) { return x+y; });
+    });
+
+    if (r1 != expected || r2 != expected || r3 != expected) {
+      cerr << "Unexpected result" << endl;
+    }
+    cout << setw(10) << nt 
+         << setw(18) << t1 * 1000 
+         << setw(18) << t2 * 1000 
+         << setw(18) << t3 * 1000 << endl;
+  }
+}
+
+void print_message(const std::string & prog, const std::string & msg) {
+  using namespace std;
+
+  cerr << msg << endl;
+  cerr << "Usage: " << prog << " size [max_threads] [repetitions]" << endl;
+  cerr << "  size: Integer value with problem size" << endl;
+  cerr << "  max_threads: Maximum number of threads (default 16)" << endl;
+  cerr << "  repetitions: Number of runs averaged per measure (default 10)" << endl;
+}
+
+int main(int argc, char **argv) {
+    
+  using namespace std;
+
+  if(argc < 2){
+    print_message(argv[0], "Invalid number of arguments.");
+    return -1;
+  }
+
+  long n = stol(argv[1]);
+  if(n <= 0){
+    print_message(argv[0], "Invalid problem size. Use a positive number.");
+    return -1;
+  }
+
+  int max_threads = (argc > 2) ? stoi(argv[2]) : 16;
+  int repetitions = (argc > 3) ? stoi(argv[3]) : 10;
+  if (max_threads <= 0 || repetitions <= 0) {
+    print_message(argv[0], "Invalid arguments. Use positive numbers.");
+    return -1;
+  }
+
+  run_benchmark(n, max_threads, repetitions);
+
+  return 0;
+}
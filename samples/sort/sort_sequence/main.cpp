@@ -0,0 +1,100 @@
+/**
+* @version    GrPPI v0.1
+* @copyright    Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license    GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+// Standard library
+// Standard library
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+
+// grppi
+#include "grppi.h"
+
+// Samples shared utilities
+#include "../../util/util.h"
+
+template <typename T>
+void sort_and_check(grppi::dynamic_execution & e, std::vector<T> & v,
+                    const std::string & name) 
+{
+  using namespace std;
+  using namespace chrono;
+
+  auto t1 = system_clock::now();
+  grppi::sort(e, begin(v), end(v));
+  auto t2 = system_clock::now();
+  auto diff = duration_cast<milliseconds>(t2-t1);
+
+  cout << name << (is_sorted(begin(v), end(v)) ? " sorted" : " NOT sorted") 
+       << " in " << diff.count() << " ms" << endl;
+}
+
+void sort_sequence(grppi::dynamic_execution & e, int n) {
+  using namespace std;
+
+  mt19937 engine{42};
+  uniform_int_distribution<int> dist{0, 1000000000};
+
+  vector<int> numbers(n);
+  generate(begin(numbers), end(numbers), [&]() { return dist(engine); });
+  vector<string> words(n);
+  transform(begin(numbers), end(numbers), begin(words), 
+      [](int x) { return to_string(x); });
+
+  sort_and_check(e, numbers, "Integers");
+  sort_and_check(e, words, "Strings");
+}
+
+void print_message(const std::string & prog, const std::string & msg) {
+  using namespace std;
+
+  cerr << msg << endl;
+  cerr << "Usage: " << prog << " size mode" << endl;
+  cerr << "  size: Integer value with problem size" << endl;
+  cerr << "  mode:" << endl;
+  print_available_modes(cerr);
+}
+
+
+int main(int argc, char **argv) {
+    
+  using namespace std;
+
+  if(argc < 3){
+    print_message(argv[0], "Invalid number of arguments.");
+    return -1;
+  }
+
+  int n = stoi(argv[1]);
+  if(n <= 0){
+    print_message(argv[0], "Invalid problem size. Use a positive number.");
+    return -1;
+  }
+
+  if (!run_test(argv[2], sort_sequence, n)) {
+    print_message(argv[0], "Invalid policy.");
+    return -1;
+  }
+
+  return 0;
+}
@@ -41,16 +41,15 @@ void compute_avg(grppi::dynamic_execution & e, int n) {
 
   vector<double> out(n);
 
+  // Neighbours at fixed offsets are passed in a std::array, so that no memory 
+  // is allocated for every element. Missing neighbours at both ends of the 
+  // sequence take a zero value and are left out of the average.
   grppi::stencil(e, begin(in), end(in), begin(out),
-    [](auto it, auto n) {
-      return (*it + std::accumulate(begin(n), end(n), 0)) / double(n.size()+1);
+    [&in](auto it, const auto & n) {
+      const int count = 1 + (it != begin(in)) + (std::next(it) != end(in));
+      return (*it + n[0] + n[1]) / double(count);
     },
-    [&in](auto it) {
-      vector<double> r;
-      if (it!=begin(in)) r.push_back(*prev(it));
-      if (std::distance(it,end(in))>1) r.push_back(*next(it));
-      return r;
-    }
+    grppi::neighbour_offsets<-1,1>{grppi::boundary_mode::constant}
   );
 
   copy(begin(out), end(out), ostream_iterator<double>(cout, " "));
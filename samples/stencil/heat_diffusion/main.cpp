@@ -0,0 +1,105 @@
+/**
+* @version    GrPPI v0.1
+* @copyright    Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license    GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+// Standard library
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <numeric>
+#include <stdexcept>
+
+// grppi
+#include "grppi.h"
+
+// Samples shared utilities
+#include "../../util/util.h"
+
+void heat_diffusion(grppi::dynamic_execution & e, int n, int steps, 
+                    int time_tile) {
+  using namespace std;
+  using namespace chrono;
+
+  // Square plate at 0 degrees with a hot spot in the center
+  vector<double> u(n*n, 0.0);
+  vector<double> aux(n*n);
+  for (int i=n/2-n/8; i<n/2+n/8; ++i) {
+    for (int j=n/2-n/8; j<n/2+n/8; ++j) {
+      u[i*n+j] = 100.0;
+    }
+  }
+
+  grppi::grid_shape<2> shape{{{size_t(n),size_t(n)}}, 1, 
+      grppi::boundary_mode::constant};
+  shape.time_tile = time_tile;
+
+  auto t1 = steady_clock::now();
+
+  grppi::stencil(e, shape, begin(u), begin(aux), steps,
+    [](const auto & x) {
+      return x(0,0) + 0.2 * (x(-1,0) + x(1,0) + x(0,-1) + x(0,1) - 4 * x(0,0));
+    }
+  );
+
+  auto t2 = steady_clock::now();
+  auto diff = duration_cast<milliseconds>(t2-t1);
+
+  cout << "Total heat: " << accumulate(begin(u), end(u), 0.0) << endl;
+  cout << "Center temperature: " << u[(n/2)*n + n/2] << endl;
+  cout << "Diffusion time: " << diff.count() << " ms" << endl;
+}
+
+void print_message(const std::string & prog, const std::string & msg) {
+  using namespace std;
+
+  cerr << msg << endl;
+  cerr << "Usage: " << prog << " size steps mode [time_tile]" << endl;
+  cerr << "  size: Number of points in every dimension of the plate" << endl;
+  cerr << "  steps: Number of time steps" << endl;
+  cerr << "  mode:" << endl;
+  print_available_modes(cerr);
+  cerr << "  time_tile: Time steps computed per tile (0 for default)" << endl;
+}
+
+
+int main(int argc, char **argv) {
+    
+  using namespace std;
+
+  if(argc < 4){
+    print_message(argv[0], "Invalid number of arguments.");
+    return -1;
+  }
+
+  int n = stoi(argv[1]);
+  int steps = stoi(argv[2]);
+  int time_tile = (argc > 4) ? stoi(argv[4]) : 0;
+  if(n <= 0 || steps < 0 || time_tile < 0){
+    print_message(argv[0], "Invalid problem size. Use a positive number.");
+    return -1;
+  }
+
+  if (!run_test(argv[3], heat_diffusion, n, steps, time_tile)) {
+    print_message(argv[0], "Invalid policy.");
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,56 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+#include "common/cache_aligned.h"
+
+using namespace std;
+using namespace grppi;
+
+TEST(cache_aligned, size_and_alignment){
+  EXPECT_EQ(0u, sizeof(cache_aligned<char>) % cache_line_size);
+  EXPECT_EQ(0u, sizeof(cache_aligned<double>) % cache_line_size);
+  EXPECT_EQ(cache_line_size, alignof(cache_aligned<int>));
+}
+
+TEST(cache_aligned, vector_elements_in_different_lines){
+  cache_aligned_vector<int> v(17);
+  for (auto & x : v) {
+    auto address = reinterpret_cast<std::uintptr_t>(&x.value);
+    EXPECT_EQ(0u, address % cache_line_size);
+  }
+  for (std::size_t i=1; i<v.size(); ++i) {
+    auto previous = reinterpret_cast<std::uintptr_t>(&v[i-1].value);
+    auto current = reinterpret_cast<std::uintptr_t>(&v[i].value);
+    EXPECT_LE(cache_line_size, current - previous);
+  }
+}
+
+TEST(cache_aligned, value_initialized){
+  cache_aligned_vector<string> v(4);
+  for (auto & x : v) { EXPECT_TRUE(x.value.empty()); }
+  v[2].value = "grppi";
+  v.resize(100);
+  EXPECT_EQ("grppi", v[2].value);
+  for (std::size_t i=4; i<v.size(); ++i) { EXPECT_EQ(0u, v[i].value.size()); }
+}
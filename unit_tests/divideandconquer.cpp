@@ -120,6 +120,32 @@ public:
         return p1 + p2;
       });
   }
+  template <typename E>
+  auto run_vecsum_predicate(const E & e) {
+    return grppi::divide_conquer(e, v,
+      // Divide
+      [this](auto & v) { 
+        invocations_divide++; 
+        std::vector<std::vector<int>> subproblem;
+        auto mid = std::next(v.begin(), v.size()/2);
+        subproblem.push_back({v.begin(), mid});
+        subproblem.push_back({mid, v.end()});
+        return subproblem; 
+      },
+      // Base case predicate
+      [](auto & v) { return v.size()<=2; },
+      // Solve base case
+      [this](auto problem) { 
+        invocations_base++; 
+        return std::accumulate(problem.begin(), problem.end(), 0);
+      }, 
+      // Combine
+      [this](auto  p1, auto  p2) { 
+        invocations_merge++; 
+        return p1 + p2;
+      });
+  }
+
   void setup_empty() {
   }
 
@@ -165,6 +191,29 @@ public:
     EXPECT_EQ(55, this->out);
   }
 
+  void setup_multiple_predicate() {
+    v = vector<int>{1,2,3,4,5,6,7,8,9,10};
+    out = 0;
+  }
+
+  void check_multiple_predicate() {
+    EXPECT_EQ(5, this->invocations_divide);
+    EXPECT_EQ(6, this->invocations_base); 
+    EXPECT_EQ(5, this->invocations_merge); 
+    EXPECT_EQ(55, this->out);
+  }
+
+  void setup_large_predicate() {
+    v.resize(10000);
+    iota(v.begin(), v.end(), 0);
+    out = 0;
+  }
+
+  void check_large_predicate() {
+    EXPECT_EQ(std::accumulate(v.begin(), v.end(), 0), this->out);
+    EXPECT_EQ(this->invocations_base, this->invocations_merge + 1); 
+  }
+
 };
 
 // Test for execution policies defined in supported_executions.h
@@ -248,3 +297,31 @@ TYPED_TEST(divideconquer_test, static_multiple_triple_div_4_threads)
   this->out =  this->run_vecsum_chunked(this->execution_);
   this->check_multiple_triple_div();
 }
+
+TYPED_TEST(divideconquer_test, static_multiple_predicate)
+{
+  this->setup_multiple_predicate();
+  this->out = this->run_vecsum_predicate(this->execution_);
+  this->check_multiple_predicate();
+}
+
+TYPED_TEST(divideconquer_test, dyn_multiple_predicate)
+{
+  this->setup_multiple_predicate();
+  this->out = this->run_vecsum_predicate(this->dyn_execution_);
+  this->check_multiple_predicate();
+}
+
+TYPED_TEST(divideconquer_test, static_large_predicate)
+{
+  this->setup_large_predicate();
+  this->out = this->run_vecsum_predicate(this->execution_);
+  this->check_large_predicate();
+}
+
+TYPED_TEST(divideconquer_test, dyn_large_predicate)
+{
+  this->setup_large_predicate();
+  this->out = this->run_vecsum_predicate(this->dyn_execution_);
+  this->check_large_predicate();
+}
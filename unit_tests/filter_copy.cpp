@@ -0,0 +1,165 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+#include <vector>
+#include <list>
+#include <string>
+#include <numeric>
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include "filter_copy.h"
+#include "map.h"
+#include "dyn/dynamic_execution.h"
+
+#include "supported_executions.h"
+
+using namespace std;
+using namespace grppi;
+
+template <typename T>
+class filter_copy_test : public ::testing::Test {
+public:
+  T execution_;
+  dynamic_execution dyn_execution_{execution_};
+
+  // Vectors
+  vector<int> v{};
+  vector<int> w{};
+  vector<int> u{};
+  vector<int> expected_true{};
+  vector<int> expected_false{};
+
+  void setup_empty() {
+  }
+
+  void setup_multiple() {
+    v = vector<int>(10000);
+    iota(v.begin(), v.end(), 0);
+    w = vector<int>(v.size(), -1);
+    u = vector<int>(v.size(), -1);
+    copy_if(v.begin(), v.end(), back_inserter(expected_true), is_selected);
+    remove_copy_if(v.begin(), v.end(), back_inserter(expected_false), 
+        is_selected);
+  }
+
+  static bool is_selected(int x) { return x % 10 == 3; }
+
+  template <typename E>
+  void run_filter_copy(const E & e) {
+    auto last = grppi::filter_copy(e, v.begin(), v.end(), w.begin(), 
+        is_selected);
+    EXPECT_EQ(expected_true.size(), std::distance(w.begin(), last));
+    EXPECT_TRUE(equal(expected_true.begin(), expected_true.end(), 
+        w.begin()));
+    EXPECT_TRUE(all_of(last, w.end(), [](int x) { return x == -1; }));
+  }
+
+  template <typename E>
+  void run_partition_copy(const E & e) {
+    auto lasts = grppi::partition_copy(e, v.begin(), v.end(), 
+        w.begin(), u.begin(), is_selected);
+    EXPECT_EQ(expected_true.size(), std::distance(w.begin(), lasts.first));
+    EXPECT_EQ(expected_false.size(), std::distance(u.begin(), lasts.second));
+    EXPECT_TRUE(equal(expected_true.begin(), expected_true.end(), 
+        w.begin()));
+    EXPECT_TRUE(equal(expected_false.begin(), expected_false.end(), 
+        u.begin()));
+  }
+
+  template <typename E>
+  void run_partition(const E & e) {
+    auto middle = grppi::partition(e, v.begin(), v.end(), is_selected);
+    EXPECT_EQ(expected_true.size(), std::distance(v.begin(), middle));
+    EXPECT_TRUE(equal(expected_true.begin(), expected_true.end(), 
+        v.begin()));
+    EXPECT_TRUE(equal(expected_false.begin(), expected_false.end(), 
+        middle));
+  }
+};
+
+// Test for execution policies defined in supported_executions.h
+TYPED_TEST_CASE(filter_copy_test, executions);
+
+TYPED_TEST(filter_copy_test, static_empty)
+{
+  this->setup_empty();
+  this->run_filter_copy(this->execution_);
+  this->run_partition_copy(this->execution_);
+  this->run_partition(this->execution_);
+}
+
+TYPED_TEST(filter_copy_test, dyn_empty)
+{
+  this->setup_empty();
+  this->run_filter_copy(this->dyn_execution_);
+  this->run_partition_copy(this->dyn_execution_);
+  this->run_partition(this->dyn_execution_);
+}
+
+TYPED_TEST(filter_copy_test, static_filter_copy)
+{
+  this->setup_multiple();
+  this->run_filter_copy(this->execution_);
+}
+
+TYPED_TEST(filter_copy_test, dyn_filter_copy)
+{
+  this->setup_multiple();
+  this->run_filter_copy(this->dyn_execution_);
+}
+
+TYPED_TEST(filter_copy_test, static_partition_copy)
+{
+  this->setup_multiple();
+  this->run_partition_copy(this->execution_);
+}
+
+TYPED_TEST(filter_copy_test, dyn_partition_copy)
+{
+  this->setup_multiple();
+  this->run_partition_copy(this->dyn_execution_);
+}
+
+TYPED_TEST(filter_copy_test, static_partition)
+{
+  this->setup_multiple();
+  this->run_partition(this->execution_);
+}
+
+TYPED_TEST(filter_copy_test, dyn_partition)
+{
+  this->setup_multiple();
+  this->run_partition(this->dyn_execution_);
+}
+
+TYPED_TEST(filter_copy_test, static_list)
+{
+  list<int> l(100);
+  iota(l.begin(), l.end(), 0);
+  auto odd = [](int x) { return x % 2; };
+  auto middle = grppi::partition(this->execution_, l.begin(), l.end(), odd);
+  EXPECT_EQ(50, std::distance(l.begin(), middle));
+  int i = 1;
+  for (auto x : l) {
+    EXPECT_EQ(i, x);
+    i = (i==99) ? 0 : i+2;
+  }
+}
@@ -18,6 +18,9 @@
 * See COPYRIGHT.txt for copyright notices and details.
 */
 #include <atomic>
+#include <numeric>
+#include <list>
+#include <thread>
 
 #include <gtest/gtest.h>
 
@@ -68,6 +71,17 @@ public:
     );
   }
 
+  template <typename E>
+  void run_reference(const E & e) {
+    grppi::map(e, 
+      v.begin(), v.end(), w.begin(),
+      [this](int & i) {
+        invocations++; 
+        return i*2; 
+      }
+    );
+  }
+
   void setup_empty() {
   }
 
@@ -168,6 +182,20 @@ TYPED_TEST(map_test, dyn_multiple_unary)
   this->check_multiple_unary();
 }
 
+TYPED_TEST(map_test, static_reference_unary)
+{
+  this->setup_multiple_unary();
+  this->run_reference(this->execution_);
+  this->check_multiple_unary();
+}
+
+TYPED_TEST(map_test, dyn_reference_unary)
+{
+  this->setup_multiple_unary();
+  this->run_reference(this->dyn_execution_);
+  this->check_multiple_unary();
+}
+
 TYPED_TEST(map_test, static_empty_nary)
 {
   this->setup_empty();
@@ -210,3 +238,177 @@ TYPED_TEST(map_test, dyn_multiple_nary)
   this->run_nary(this->execution_);
   this->check_multiple_nary();
 }
+
+template <typename T>
+class map_scheduling_test : public ::testing::Test {
+public:
+  T execution_;
+
+  vector<int> v;
+  vector<int> w;
+
+  void setup() {
+    v.resize(1000);
+    iota(v.begin(), v.end(), 0);
+    w.assign(1000, 0);
+  }
+
+  template <typename E>
+  void run_irregular(const E & e) {
+    grppi::map(e, v.begin(), v.end(), w.begin(),
+      [](int x) {
+        // Cost grows with the position of the element
+        int r = 0;
+        for (int i=0; i<x; ++i) { r += i % 3; }
+        return r;
+      }
+    );
+  }
+
+  void check_irregular() {
+    for (int x=0; x<1000; ++x) {
+      int r = 0;
+      for (int i=0; i<x; ++i) { r += i % 3; }
+      EXPECT_EQ(r, w[x]);
+    }
+  }
+};
+
+// Scheduling is supported by native and OpenMP policies
+TYPED_TEST_CASE(map_scheduling_test, executions_notbb);
+
+TYPED_TEST(map_scheduling_test, irregular)
+{
+  this->setup();
+  for (auto mode : {scheduling_mode::fixed, scheduling_mode::pinned,
+                    scheduling_mode::dynamic, scheduling_mode::guided}) 
+  {
+    this->execution_.set_scheduling(mode, 3);
+    this->run_irregular(this->execution_);
+    this->check_irregular();
+  }
+}
+
+TEST(map_scheduling, native_fixed_busy_worker)
+{
+  // The only worker is kept busy until a nested map completes. Fixed chunks
+  // are not pinned, so the calling thread runs the chunk of that worker.
+  parallel_execution_native ex{2};
+  std::atomic<bool> nested_done{false};
+  const auto caller = this_thread::get_id();
+  vector<int> v{0, 1};
+  grppi::map(ex, v.begin(), v.end(), v.begin(), 
+    [&](int i) {
+      if (i == 0) {
+        while (this_thread::get_id() != caller && !nested_done) { 
+          this_thread::yield(); 
+        }
+        return 0;
+      }
+      vector<int> w{1, 2};
+      grppi::map(ex, w.begin(), w.end(), w.begin(), 
+          [](int x) { return 2*x; });
+      nested_done = true;
+      return w[0] + w[1];
+    });
+  EXPECT_EQ(0, v[0]);
+  EXPECT_EQ(6, v[1]);
+}
+
+template <typename T>
+class map_vectorized_test : public ::testing::Test {
+public:
+  T execution_;
+  dynamic_execution dyn_execution_{execution_};
+
+  vector<double> x;
+  vector<double> y;
+  vector<double> expected;
+  std::atomic<int> batch_invocations{0};
+  std::atomic<int> scalar_invocations{0};
+
+  void setup(int n) {
+    for (int i=0; i<n; ++i) {
+      x.push_back(i * 0.5);
+      y.push_back(n - i);
+      expected.push_back(2.0 * x.back() + y.back());
+    }
+  }
+
+  auto daxpy() {
+    return grppi::vectorize<4>([this](auto vx, auto vy) {
+      count(vx);
+      return 2.0 * vx + vy;
+    });
+  }
+
+  void count(double) { scalar_invocations++; }
+  void count(const lane_batch<double,4> &) { batch_invocations++; }
+
+  template <typename E>
+  void run_contiguous(const E & e) {
+    grppi::map(e, x.begin(), x.end(), y.begin(), daxpy(), y.begin());
+  }
+
+  template <typename E>
+  void run_list(const E & e) {
+    list<double> lx{x.begin(), x.end()};
+    grppi::map(e, lx.begin(), lx.end(), y.begin(), daxpy(), y.begin());
+  }
+
+  void check_contiguous(int n) {
+    EXPECT_EQ(expected, y);
+    // Every element is processed either in a batch or as a scalar
+    EXPECT_EQ(n, 4 * batch_invocations + scalar_invocations);
+    EXPECT_LE(1, batch_invocations);
+  }
+
+  void check_list(int n) {
+    EXPECT_EQ(expected, y);
+    EXPECT_EQ(0, batch_invocations);
+    EXPECT_EQ(n, scalar_invocations);
+  }
+};
+
+TYPED_TEST_CASE(map_vectorized_test, executions);
+
+TYPED_TEST(map_vectorized_test, static_contiguous)
+{
+  this->setup(1003);
+  this->run_contiguous(this->execution_);
+  this->check_contiguous(1003);
+}
+
+TYPED_TEST(map_vectorized_test, dyn_contiguous)
+{
+  this->setup(1003);
+  this->run_contiguous(this->dyn_execution_);
+  this->check_contiguous(1003);
+}
+
+TYPED_TEST(map_vectorized_test, static_list)
+{
+  this->setup(101);
+  this->run_list(this->execution_);
+  this->check_list(101);
+}
+
+TYPED_TEST(map_vectorized_test, dyn_list)
+{
+  this->setup(101);
+  this->run_list(this->dyn_execution_);
+  this->check_list(101);
+}
+
+TEST(lane_batch, arithmetic)
+{
+  auto x = lane_batch<int,4>{{1,2,3,4}};
+  auto y = lane_batch<double,4>{{0.5,0.5,0.5,0.5}};
+  auto z = 2 * x + y - x / 2 * 1.0;
+  for (int i=0; i<4; ++i) {
+    EXPECT_DOUBLE_EQ(2*(i+1) + 0.5 - (i+1)/2, z[i]);
+  }
+  float out[4];
+  (-z).store(out);
+  EXPECT_FLOAT_EQ(-z[3], out[3]);
+}
@@ -0,0 +1,167 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+#include <atomic>
+#include <vector>
+#include <iterator>
+#include <numeric>
+
+#include <gtest/gtest.h>
+
+#include "map_expression.h"
+#include "dyn/dynamic_execution.h"
+
+#include "supported_executions.h"
+
+using namespace std;
+using namespace grppi;
+
+template <typename T>
+class map_expression_test : public ::testing::Test {
+public:
+  T execution_;
+  dynamic_execution dyn_execution_{execution_};
+
+  vector<int> v{};
+  vector<double> w{};
+
+  // Invocation counters
+  std::atomic<int> invocations_first{0};
+  std::atomic<int> invocations_second{0};
+
+  void setup(int n) {
+    v.resize(n);
+    iota(v.begin(), v.end(), 1);
+    w.assign(n, 0);
+  }
+
+  // Sum of the halves of the squares of the even numbers
+  template <typename E>
+  double run_filtered_sum(const E & e) {
+    return grppi::lazy_map(e, v.begin(), v.end(), 
+        [this](int x) { invocations_first++; return x*x; })
+      | grppi::keep([](int x) { return x % 2 == 0; })
+      | grppi::transform([this](int x) { 
+          invocations_second++; 
+          return x / 2.0; 
+        })
+      | grppi::fold(0.0, [](double x, double y) { return x + y; });
+  }
+
+  double expected_filtered_sum() const {
+    double r = 0;
+    for (auto x : v) { if (x % 2 == 0) r += x * x / 2.0; }
+    return r;
+  }
+
+  template <typename E>
+  void run_store(const E & e) {
+    grppi::lazy_map(e, v.begin(), v.end(), 
+        [this](int x) { invocations_first++; return x + 1; })
+      | grppi::transform([this](int x) { 
+          invocations_second++; 
+          return 0.5 * x; 
+        })
+      | grppi::store(w.begin());
+  }
+
+  void check_store() {
+    EXPECT_EQ(static_cast<int>(v.size()), invocations_first);
+    EXPECT_EQ(static_cast<int>(v.size()), invocations_second);
+    for (size_t i=0; i<v.size(); ++i) {
+      EXPECT_DOUBLE_EQ(0.5 * (v[i] + 1), w[i]);
+    }
+  }
+};
+
+TYPED_TEST_CASE(map_expression_test, executions);
+
+TYPED_TEST(map_expression_test, static_filtered_sum)
+{
+  this->setup(1000);
+  auto result = this->run_filtered_sum(this->execution_);
+  EXPECT_DOUBLE_EQ(this->expected_filtered_sum(), result);
+  // Every element is transformed once and filtered elements are skipped
+  EXPECT_EQ(1000, this->invocations_first);
+  EXPECT_EQ(500, this->invocations_second);
+}
+
+TYPED_TEST(map_expression_test, dyn_filtered_sum)
+{
+  this->setup(1000);
+  auto result = this->run_filtered_sum(this->dyn_execution_);
+  EXPECT_DOUBLE_EQ(this->expected_filtered_sum(), result);
+  EXPECT_EQ(1000, this->invocations_first);
+  EXPECT_EQ(500, this->invocations_second);
+}
+
+TYPED_TEST(map_expression_test, static_empty)
+{
+  this->setup(0);
+  EXPECT_DOUBLE_EQ(0.0, this->run_filtered_sum(this->execution_));
+  EXPECT_EQ(0, this->invocations_first);
+}
+
+TYPED_TEST(map_expression_test, static_discard_all)
+{
+  this->setup(100);
+  auto result = grppi::lazy_map(this->execution_, this->v.begin(), 
+        this->v.end(), [](int x) { return x; })
+      | grppi::discard([](int) { return true; })
+      | grppi::fold(0, [](int x, int y) { return x + y; });
+  EXPECT_EQ(0, result);
+}
+
+TYPED_TEST(map_expression_test, static_store)
+{
+  this->setup(1000);
+  this->run_store(this->execution_);
+  this->check_store();
+}
+
+TYPED_TEST(map_expression_test, dyn_store)
+{
+  this->setup(1000);
+  this->run_store(this->dyn_execution_);
+  this->check_store();
+}
+
+TYPED_TEST(map_expression_test, static_reuse_expression)
+{
+  this->setup(10);
+  auto squares = grppi::lazy_map(this->execution_, this->v.begin(), 
+      this->v.end(), [](int x) { return x*x; });
+  auto sum = squares | grppi::fold(0, [](int x, int y) { return x + y; });
+  auto max = squares | grppi::fold(0, [](int x, int y) { 
+      return std::max(x,y); });
+  EXPECT_EQ(385, sum);
+  EXPECT_EQ(100, max);
+}
+
+TYPED_TEST(map_expression_test, static_named_stages)
+{
+  this->setup(10);
+  auto half = grppi::transform([](int x) { return x / 2.0; });
+  auto even = grppi::keep([](int x) { return x % 2 == 0; });
+  auto sum = grppi::fold(0.0, [](double x, double y) { return x + y; });
+  auto result = grppi::lazy_map(this->execution_, this->v.begin(), 
+        this->v.end(), [](int x) { return x; })
+      | even | half | sum;
+  EXPECT_DOUBLE_EQ(15.0, result);
+}
@@ -18,6 +18,8 @@
 * See COPYRIGHT.txt for copyright notices and details.
 */
 #include <atomic>
+#include <string>
+#include <numeric>
 
 #include <gtest/gtest.h>
 #include <iostream>
@@ -111,3 +113,78 @@ TYPED_TEST(map_reduce_test, dyn_multiple)
   this->output = this->run_square_sum(this->dyn_execution_);
   this->check_multiple();
 }
+
+template <typename T>
+class map_reduce_scheduling_test : public ::testing::Test {
+public:
+  T execution_;
+
+  vector<int> v;
+  string expected;
+
+  void setup() {
+    for (int i=0; i<1000; ++i) {
+      v.push_back(i);
+      expected += to_string(i);
+    }
+  }
+
+  template <typename E>
+  string run_concat(const E & e) {
+    return grppi::map_reduce(e, v.begin(), v.end(), string{},
+      [](int x) { return to_string(x); },
+      [](const string & x, const string & y) { return x + y; }
+    );
+  }
+};
+
+// Scheduling is supported by native and OpenMP policies
+TYPED_TEST_CASE(map_reduce_scheduling_test, executions_notbb);
+
+TYPED_TEST(map_reduce_scheduling_test, non_commutative)
+{
+  this->setup();
+  for (auto mode : {scheduling_mode::fixed, scheduling_mode::pinned,
+                    scheduling_mode::dynamic, scheduling_mode::guided}) 
+  {
+    for (std::size_t grain : {0, 1, 7, 5000}) {
+      this->execution_.set_scheduling(mode, grain);
+      EXPECT_EQ(this->expected, this->run_concat(this->execution_));
+    }
+  }
+}
+
+TYPED_TEST(map_reduce_scheduling_test, parallel_combine)
+{
+  this->setup();
+  EXPECT_FALSE(this->execution_.is_parallel_combine());
+  this->execution_.enable_parallel_combine();
+  EXPECT_TRUE(this->execution_.is_parallel_combine());
+  for (std::size_t grain : {0, 1, 7, 5000}) {
+    this->execution_.set_scheduling(scheduling_mode::dynamic, grain);
+    EXPECT_EQ(this->expected, this->run_concat(this->execution_));
+  }
+
+  // Options are kept by the dynamic execution
+  grppi::dynamic_execution dyn{this->execution_};
+  EXPECT_EQ(this->expected, this->run_concat(dyn));
+}
+
+#ifdef GRPPI_TBB
+TEST(map_reduce_tbb, parallel_combine)
+{
+  parallel_execution_tbb ex;
+  EXPECT_FALSE(ex.is_parallel_combine());
+  ex.enable_parallel_combine();
+  EXPECT_TRUE(ex.is_parallel_combine());
+
+  vector<int> v(1000);
+  iota(v.begin(), v.end(), 0);
+  string expected;
+  for (auto x : v) { expected += to_string(x); }
+  auto result = grppi::map_reduce(ex, v.begin(), v.end(), string{},
+    [](int x) { return to_string(x); },
+    [](const string & x, const string & y) { return x + y; });
+  EXPECT_EQ(expected, result);
+}
+#endif
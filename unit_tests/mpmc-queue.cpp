@@ -23,6 +23,8 @@
 #include <gtest/gtest.h>
 #include <iostream>
 #include <thread>
+#include <numeric>
+#include <iterator>
 #include "common/mpmc_queue.h"
 
 using namespace std;
@@ -134,3 +136,65 @@ mpmc_queue<int> queue(3, queue_mode::lockfree);
 
 
 
+
+TEST(mpmc_queue_lockfree, many_producers_consumers){
+ mpmc_queue<long> queue(7, queue_mode::lockfree);
+ std::vector<std::thread> thrs;
+ std::atomic<long> val{0};
+ const long items = 10000;
+
+ for(auto i = 0; i<4; i++){
+   thrs.push_back(std::thread([&](){
+     for (long j=1; j<=items; j++) queue.push(j);
+   }));
+   thrs.push_back(std::thread([&](){
+     long sum = 0;
+     for (long j=0; j<items; j++) sum += queue.pop();
+     val += sum;
+   }));
+ }
+ for(auto & t : thrs) t.join();
+
+ EXPECT_EQ(4 * items * (items+1) / 2, val.load());
+ EXPECT_EQ(true, queue.is_empty());
+}
+
+TEST(mpmc_queue_blocking, bulk_push_pop){
+  mpmc_queue<long> queue(5, queue_mode::blocking);
+  std::thread producer([&](){
+    std::vector<long> items(100);
+    for (long i=0; i<100; i++) {
+      std::iota(items.begin(), items.end(), i*100);
+      queue.push_bulk(items.begin(), items.end());
+    }
+  });
+  std::vector<long> values;
+  while (values.size()<10000) {
+    queue.pop_bulk(std::back_inserter(values), 7);
+  }
+  producer.join();
+  std::vector<long> expected(10000);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(expected, values);
+  EXPECT_EQ(0, queue.try_pop_bulk(std::back_inserter(values), 7));
+}
+
+TEST(mpmc_queue_lockfree, bulk_push_pop){
+  mpmc_queue<long> queue(5, queue_mode::lockfree);
+  std::thread producer([&](){
+    std::vector<long> items(100);
+    for (long i=0; i<100; i++) {
+      std::iota(items.begin(), items.end(), i*100);
+      queue.push_bulk(items.begin(), items.end());
+    }
+  });
+  std::vector<long> values;
+  while (values.size()<10000) {
+    queue.pop_bulk(std::back_inserter(values), 7);
+  }
+  producer.join();
+  std::vector<long> expected(10000);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(expected, values);
+  EXPECT_EQ(0, queue.try_pop_bulk(std::back_inserter(values), 7));
+}
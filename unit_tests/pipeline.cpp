@@ -25,6 +25,9 @@
 #include <gtest/gtest.h>
 
 #include "pipeline.h"
+#include "farm.h"
+#include "stream_filter.h"
+#include "stream_reduce.h"
 #include "dyn/dynamic_execution.h"
 
 #include "supported_executions.h"
@@ -306,3 +309,89 @@ TYPED_TEST(pipeline_test, static_composed_piecewise)
   this->run_composed_piecewise(this->execution_);
   this->check_composed();
 }
+
+TEST(pipeline_native, batched_transfer)
+{
+  auto run = [](auto & ex) {
+    vector<int> result;
+    int n = 0;
+    grppi::pipeline(ex,
+      [&n]() -> optional<int> {
+        if (n<1000) return ++n;
+        return {};
+      },
+      [](int x) { return 2*x; },
+      grppi::keep([](int x) { return x % 3 != 0; }),
+      grppi::farm(4, [](int x) { return x+1; }),
+      [&result](int x) { result.push_back(x); }
+    );
+    n = 0;
+    grppi::pipeline(ex,
+      [&n]() -> optional<int> {
+        if (n<1000) return ++n;
+        return {};
+      },
+      grppi::reduce(10, 10, 0, [](int x, int y) { return x+y; }),
+      [&result](int x) { result.push_back(x); }
+    );
+    return result;
+  };
+
+  sequential_execution seq;
+  auto expected = run(seq);
+
+  parallel_execution_native ex{4};
+  ex.set_queue_attributes(16, queue_mode::blocking, 8);
+  EXPECT_EQ(expected, run(ex));
+
+  ex.set_queue_attributes(16, queue_mode::lockfree, 32);
+  EXPECT_EQ(expected, run(ex));
+}
+
+#ifdef GRPPI_OMP
+TEST(pipeline_omp, batched_transfer)
+{
+  auto run = [](auto & ex) {
+    vector<int> result;
+    int n = 0;
+    grppi::pipeline(ex,
+      [&n]() -> optional<int> {
+        if (n<1000) return ++n;
+        return {};
+      },
+      [](int x) { return 2*x; },
+      grppi::farm(4, [](int x) { return x+1; }),
+      [&result](int x) { result.push_back(x); }
+    );
+    n = 0;
+    grppi::pipeline(ex,
+      [&n]() -> optional<int> {
+        if (n<1000) return ++n;
+        return {};
+      },
+      grppi::keep([](int x) { return x % 3 != 0; }),
+      [&result](int x) { result.push_back(x); }
+    );
+    n = 0;
+    grppi::pipeline(ex,
+      [&n]() -> optional<int> {
+        if (n<1000) return ++n;
+        return {};
+      },
+      grppi::reduce(10, 10, 0, [](int x, int y) { return x+y; }),
+      [&result](int x) { result.push_back(x); }
+    );
+    return result;
+  };
+
+  sequential_execution seq;
+  auto expected = run(seq);
+
+  parallel_execution_omp ex{4};
+  ex.set_queue_attributes(16, queue_mode::blocking, 8);
+  EXPECT_EQ(expected, run(ex));
+
+  ex.set_queue_attributes(16, queue_mode::lockfree, 32);
+  EXPECT_EQ(expected, run(ex));
+}
+#endif
@@ -0,0 +1,178 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+#include <vector>
+#include <list>
+#include <array>
+#include <string>
+#include <iterator>
+#include <numeric>
+
+#include <gtest/gtest.h>
+
+#include "map.h"
+#include "reduce.h"
+#include "mapreduce.h"
+#include "map_expression.h"
+#include "dyn/dynamic_execution.h"
+
+#include "supported_executions.h"
+
+using namespace std;
+using namespace grppi;
+
+namespace test_ranges {
+
+// Range over a list providing its own split customization
+struct segmented {
+  list<int> values;
+  mutable int splits = 0;
+  mutable size_t last_num_parts = 0;
+  auto begin() const { return values.begin(); }
+  auto end() const { return values.end(); }
+};
+
+vector<subrange<list<int>::const_iterator>> split(const segmented & r, 
+                                                  size_t num_parts) 
+{
+  r.splits++;
+  r.last_num_parts = num_parts;
+  return grppi::split(r.values, num_parts);
+}
+
+}
+
+static_assert(is_range<vector<int>>, "vector is a range");
+static_assert(is_range<int(&)[4]>, "array is a range");
+static_assert(!is_range<int>, "int is not a range");
+static_assert(is_contiguous_range<vector<double>>, "vector is contiguous");
+static_assert(is_contiguous_range<array<int,3>>, "array is contiguous");
+static_assert(!is_contiguous_range<vector<bool>>, "vector<bool> is not");
+static_assert(is_random_access_range<subrange<vector<int>::iterator>>,
+    "subrange of random access iterators is random access");
+static_assert(!is_random_access_range<list<int>>, "list is not");
+
+TEST(range, split_list){
+  list<int> l(10);
+  iota(l.begin(), l.end(), 0);
+  auto parts = split(l, 3);
+  ASSERT_EQ(3u, parts.size());
+  EXPECT_EQ(4u, parts[0].size());
+  EXPECT_EQ(3u, parts[1].size());
+  EXPECT_EQ(3u, parts[2].size());
+  EXPECT_EQ(0, *parts[0].begin());
+  EXPECT_EQ(4, *parts[1].begin());
+  EXPECT_EQ(7, *parts[2].begin());
+  EXPECT_EQ(l.end(), parts[2].end());
+}
+
+TEST(range, split_small){
+  list<int> l{1,2};
+  EXPECT_EQ(2u, split(l, 8).size());
+  EXPECT_TRUE(split(list<int>{}, 8).empty());
+}
+
+TEST(range, contiguous_first){
+  vector<int> v{1,2,3};
+  const int * p = range_first(v);
+  EXPECT_EQ(v.data(), p);
+  list<int> l{1,2,3};
+  EXPECT_EQ(l.begin(), range_first(l));
+}
+
+template <typename T>
+class range_test : public ::testing::Test {
+public:
+  T execution_;
+  dynamic_execution dyn_execution_{execution_};
+
+  template <typename E>
+  void run_all(const E & e) {
+    list<int> l(1000);
+    iota(l.begin(), l.end(), 1);
+    vector<int> v(l.begin(), l.end());
+
+    // map: list -> list, vector -> vector, iterators of lists
+    list<int> lout(l.size());
+    grppi::map(e, l, lout, [](int x) { return 2*x; });
+    EXPECT_EQ(l.size(), lout.size());
+    EXPECT_EQ(2*500500, accumulate(lout.begin(), lout.end(), 0));
+    EXPECT_EQ(2, lout.front());
+    EXPECT_EQ(2000, lout.back());
+
+    vector<int> vout(v.size());
+    grppi::map(e, v, vout, [](int x) { return x+1; });
+    EXPECT_EQ(501500, accumulate(vout.begin(), vout.end(), 0));
+
+    list<int> lout2(l.size());
+    grppi::map(e, l.begin(), l.end(), lout2.begin(), [](int x) { return -x; });
+    EXPECT_EQ(-500500, accumulate(lout2.begin(), lout2.end(), 0));
+    EXPECT_EQ(-1000, lout2.back());
+
+    // reduce and map_reduce
+    EXPECT_EQ(500500, grppi::reduce(e, l, 0, 
+        [](int x, int y) { return x+y; }));
+    EXPECT_EQ(500500, grppi::reduce(e, v, 0, 
+        [](int x, int y) { return x+y; }));
+    EXPECT_EQ(500500, grppi::reduce(e, l.begin(), l.end(), 0, 
+        [](int x, int y) { return x+y; }));
+    EXPECT_EQ(1001000, grppi::map_reduce(e, l, 0, 
+        [](int x) { return 2*x; }, [](int x, int y) { return x+y; }));
+    EXPECT_EQ(1001000, grppi::map_reduce(e, l.begin(), l.end(), 0, 
+        [](int x) { return 2*x; }, [](int x, int y) { return x+y; }));
+
+    // empty ranges
+    list<int> empty;
+    EXPECT_EQ(0, grppi::reduce(e, empty, 0, 
+        [](int x, int y) { return x+y; }));
+
+    // lazy expression on a range
+    EXPECT_EQ(1001000, grppi::lazy_map(e, v, [](int x) { return 2*x; })
+        | grppi::fold(0, [](int x, int y) { return x+y; }));
+
+    // custom split, not needed by a sequential execution
+    test_ranges::segmented s{l};
+    EXPECT_EQ(500500, grppi::reduce(e, s, 0, 
+        [](int x, int y) { return x+y; }));
+    EXPECT_EQ(is_sequential_execution<E>() ? 0 : 1, s.splits);
+    // parts follow the concurrency degree of the policy
+    if (s.splits > 0) {
+      const size_t degree = e.concurrency_degree();
+      EXPECT_EQ(degree > 1 ? 4 * degree : 1, s.last_num_parts);
+    }
+
+    // indices
+    vector<int> visits(100, 0);
+    internal::for_each_index(e, visits.size(), 
+        [&visits](size_t i) { visits[i]++; });
+    EXPECT_EQ(vector<int>(100, 1), visits);
+  }
+};
+
+TYPED_TEST_CASE(range_test, executions);
+
+TYPED_TEST(range_test, static_ranges)
+{
+  this->run_all(this->execution_);
+}
+
+TYPED_TEST(range_test, dyn_ranges)
+{
+  this->run_all(this->dyn_execution_);
+}
@@ -18,6 +18,7 @@
 * See COPYRIGHT.txt for copyright notices and details.
 */
 #include <atomic>
+#include <string>
 
 #include <gtest/gtest.h>
 
@@ -101,3 +102,54 @@ TYPED_TEST(reduce_test, dyn_multiple)
   this->check_multiple();
 }
 
+
+template <typename T>
+class reduce_scheduling_test : public ::testing::Test {
+public:
+  T execution_;
+
+  vector<string> v;
+  string expected;
+
+  void setup() {
+    for (int i=0; i<1000; ++i) {
+      v.push_back(to_string(i%10));
+      expected += v.back();
+    }
+  }
+
+  template <typename E>
+  string run_concat(const E & e) {
+    return grppi::reduce(e, v.begin(), v.end(), string{},
+      [](const string & x, const string & y) { return x + y; }
+    );
+  }
+};
+
+// Scheduling is supported by native and OpenMP policies
+TYPED_TEST_CASE(reduce_scheduling_test, executions_notbb);
+
+TYPED_TEST(reduce_scheduling_test, non_commutative)
+{
+  this->setup();
+  for (auto mode : {scheduling_mode::fixed, scheduling_mode::pinned,
+                    scheduling_mode::dynamic, scheduling_mode::guided}) 
+  {
+    for (std::size_t grain : {0, 1, 7, 5000}) {
+      this->execution_.set_scheduling(mode, grain);
+      EXPECT_EQ(this->expected, this->run_concat(this->execution_));
+    }
+  }
+}
+
+TYPED_TEST(reduce_scheduling_test, parallel_combine)
+{
+  this->setup();
+  this->execution_.enable_parallel_combine();
+  for (auto mode : {scheduling_mode::fixed, scheduling_mode::guided}) {
+    for (std::size_t grain : {0, 1, 3}) {
+      this->execution_.set_scheduling(mode, grain);
+      EXPECT_EQ(this->expected, this->run_concat(this->execution_));
+    }
+  }
+}
@@ -0,0 +1,137 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+#include <vector>
+#include <list>
+#include <string>
+#include <map>
+#include <unordered_map>
+
+#include <gtest/gtest.h>
+
+#include "reduce_by_key.h"
+#include "map.h"
+#include "dyn/dynamic_execution.h"
+
+#include "supported_executions.h"
+
+using namespace std;
+using namespace grppi;
+
+template <typename T>
+class reduce_by_key_test : public ::testing::Test {
+public:
+  T execution_;
+  dynamic_execution dyn_execution_{execution_};
+
+  template <typename E>
+  void run_empty(const E & e) {
+    vector<int> v;
+    auto sums = grppi::reduce_by_key(e, v.begin(), v.end(), 
+        [](int x) { return x % 3; }, 0,
+        [](int x) { return x; },
+        [](int x, int y) { return x + y; });
+    EXPECT_TRUE(sums.empty());
+    auto bins = grppi::histogram(e, v.begin(), v.end(), 4, 
+        [](int x) { return x; });
+    EXPECT_EQ(vector<size_t>(4, 0), bins);
+  }
+
+  template <typename E>
+  void run_sums(const E & e) {
+    vector<int> v(100000);
+    for (int i=0; i<static_cast<int>(v.size()); ++i) { v[i] = i; }
+    auto sums = grppi::reduce_by_key(e, v.begin(), v.end(), 
+        [](int x) { return x % 7; }, 0L,
+        [](int x) { return static_cast<long>(x); },
+        [](long x, long y) { return x + y; });
+    unordered_map<int,long> expected;
+    for (auto x : v) { expected[x % 7] += x; }
+    EXPECT_EQ(expected, sums);
+  }
+
+  template <typename E>
+  void run_words(const E & e) {
+    list<string> words;
+    std::map<string,int> expected;
+    for (int i=0; i<20000; ++i) {
+      words.push_back("w" + to_string((i * 31) % 1009));
+      expected[words.back()]++;
+    }
+    auto counts = grppi::reduce_by_key(e, words.begin(), words.end(), 
+        [](const string & w) { return w; }, 0,
+        [](const string &) { return 1; },
+        [](int x, int y) { return x + y; });
+    EXPECT_EQ(expected, (std::map<string,int>{counts.begin(), counts.end()}));
+  }
+
+  template <typename E>
+  void run_histogram(const E & e) {
+    vector<double> v(50000);
+    for (std::size_t i=0; i<v.size(); ++i) { v[i] = (i % 100) / 10.0; }
+    v.push_back(-1.0);
+    v.push_back(100.0);
+    auto bins = grppi::histogram(e, v.begin(), v.end(), 10, 
+        [](double x) { return static_cast<int>(x); });
+    EXPECT_EQ(vector<size_t>(10, 5000), bins);
+  }
+};
+
+// Test for execution policies defined in supported_executions.h
+TYPED_TEST_CASE(reduce_by_key_test, executions);
+
+TYPED_TEST(reduce_by_key_test, static_empty)
+{
+  this->run_empty(this->execution_);
+}
+
+TYPED_TEST(reduce_by_key_test, dyn_empty)
+{
+  this->run_empty(this->dyn_execution_);
+}
+
+TYPED_TEST(reduce_by_key_test, static_sums)
+{
+  this->run_sums(this->execution_);
+}
+
+TYPED_TEST(reduce_by_key_test, dyn_sums)
+{
+  this->run_sums(this->dyn_execution_);
+}
+
+TYPED_TEST(reduce_by_key_test, static_words)
+{
+  this->run_words(this->execution_);
+}
+
+TYPED_TEST(reduce_by_key_test, dyn_words)
+{
+  this->run_words(this->dyn_execution_);
+}
+
+TYPED_TEST(reduce_by_key_test, static_histogram)
+{
+  this->run_histogram(this->execution_);
+}
+
+TYPED_TEST(reduce_by_key_test, dyn_histogram)
+{
+  this->run_histogram(this->dyn_execution_);
+}
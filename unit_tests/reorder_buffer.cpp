@@ -0,0 +1,90 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include <gtest/gtest.h>
+#include "common/reorder_buffer.h"
+
+using namespace std;
+using namespace grppi;
+
+using item_type = pair<int,long>;
+
+TEST(reorder_buffer, in_order){
+  reorder_buffer<item_type> buffer;
+  vector<int> released;
+  auto release = [&](item_type && item) { released.push_back(item.first); };
+  for (long i=0; i<10; ++i) {
+    buffer.push(item_type{int(i)*2, i}, release);
+    EXPECT_TRUE(buffer.empty());
+  }
+  EXPECT_EQ((vector<int>{0,2,4,6,8,10,12,14,16,18}), released);
+  EXPECT_EQ(10, buffer.next());
+}
+
+TEST(reorder_buffer, reversed){
+  reorder_buffer<item_type> buffer;
+  vector<int> released;
+  auto release = [&](item_type && item) { released.push_back(item.first); };
+  for (long i=9; i>0; --i) {
+    buffer.push(item_type{int(i), i}, release);
+  }
+  EXPECT_TRUE(released.empty());
+  EXPECT_EQ(9u, buffer.size());
+  buffer.push(item_type{0, 0}, release);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ((vector<int>{0,1,2,3,4,5,6,7,8,9}), released);
+}
+
+TEST(reorder_buffer, shuffled){
+  vector<long> order(10000);
+  iota(order.begin(), order.end(), 0);
+  shuffle(order.begin(), order.end(), mt19937{42});
+
+  reorder_buffer<item_type> buffer;
+  vector<int> released;
+  auto release = [&](item_type && item) { released.push_back(item.first); };
+  for (auto i : order) {
+    buffer.push(item_type{int(i), i}, release);
+  }
+
+  vector<int> expected(10000);
+  iota(expected.begin(), expected.end(), 0);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(expected, released);
+}
+
+TEST(reorder_buffer, flush){
+  reorder_buffer<item_type> buffer;
+  vector<int> released;
+  auto release = [&](item_type && item) { released.push_back(item.first); };
+  buffer.push(item_type{5, 5}, release);
+  buffer.push(item_type{2, 2}, release);
+  buffer.push(item_type{9, 9}, release);
+  EXPECT_TRUE(released.empty());
+  buffer.flush(release);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ((vector<int>{2,5,9}), released);
+  EXPECT_EQ(10, buffer.next());
+}
@@ -0,0 +1,217 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+#include <string>
+#include <vector>
+#include <numeric>
+
+#include <gtest/gtest.h>
+
+#include "scan.h"
+#include "dyn/dynamic_execution.h"
+
+#include "supported_executions.h"
+
+using namespace std;
+using namespace grppi;
+
+template <typename T>
+class scan_test : public ::testing::Test {
+public:
+  T execution_;
+  dynamic_execution dyn_execution_{execution_};
+
+  // Variables
+  int total;
+
+  // Vectors
+  vector<int> v{};
+  vector<int> w{};
+
+  template <typename E>
+  void run_inclusive(const E & e) {
+    total = grppi::scan(e, v.begin(), v.end(), w.begin(), 0,
+      [](int x, int y) { return x + y; }
+    );
+  }
+
+  template <typename E>
+  void run_exclusive(const E & e) {
+    total = grppi::exclusive_scan(e, v.begin(), v.end(), w.begin(), 0,
+      [](int x, int y) { return x + y; }
+    );
+  }
+
+  template <typename E>
+  void run_in_place(const E & e) {
+    total = grppi::scan(e, v.begin(), v.end(), v.begin(), 0,
+      [](int x, int y) { return x + y; }
+    );
+  }
+
+  void setup_empty() {
+    total = -1;
+  }
+
+  void check_empty() {
+    EXPECT_EQ(0, total);
+  }
+
+  void setup_multiple() {
+    total = 0;
+    v = vector<int>{1,2,3,4,5};
+    w = vector<int>(5);
+  }
+
+  void check_inclusive_multiple() {
+    EXPECT_EQ(15, total);
+    EXPECT_EQ((vector<int>{1,3,6,10,15}), w);
+  }
+
+  void check_exclusive_multiple() {
+    EXPECT_EQ(15, total);
+    EXPECT_EQ((vector<int>{0,1,3,6,10}), w);
+  }
+
+  void setup_large() {
+    total = 0;
+    v = vector<int>(10000);
+    iota(v.begin(), v.end(), 0);
+    w = vector<int>(v.size());
+  }
+
+  void check_large(const vector<int> & out) {
+    EXPECT_EQ(49995000, total);
+    for (std::size_t i=0; i<out.size(); ++i) {
+      ASSERT_EQ(static_cast<int>(i*(i+1)/2), out[i]);
+    }
+  }
+};
+
+// Test for execution policies defined in supported_executions.h
+TYPED_TEST_CASE(scan_test, executions);
+
+TYPED_TEST(scan_test, static_empty)
+{
+  this->setup_empty();
+  this->run_inclusive(this->execution_);
+  this->check_empty();
+}
+
+TYPED_TEST(scan_test, dyn_empty)
+{
+  this->setup_empty();
+  this->run_exclusive(this->dyn_execution_);
+  this->check_empty();
+}
+
+TYPED_TEST(scan_test, static_inclusive_multiple)
+{
+  this->setup_multiple();
+  this->run_inclusive(this->execution_);
+  this->check_inclusive_multiple();
+}
+
+TYPED_TEST(scan_test, dyn_inclusive_multiple)
+{
+  this->setup_multiple();
+  this->run_inclusive(this->dyn_execution_);
+  this->check_inclusive_multiple();
+}
+
+TYPED_TEST(scan_test, static_exclusive_multiple)
+{
+  this->setup_multiple();
+  this->run_exclusive(this->execution_);
+  this->check_exclusive_multiple();
+}
+
+TYPED_TEST(scan_test, dyn_exclusive_multiple)
+{
+  this->setup_multiple();
+  this->run_exclusive(this->dyn_execution_);
+  this->check_exclusive_multiple();
+}
+
+TYPED_TEST(scan_test, static_in_place_large)
+{
+  this->setup_large();
+  this->run_in_place(this->execution_);
+  this->check_large(this->v);
+}
+
+TYPED_TEST(scan_test, dyn_in_place_large)
+{
+  this->setup_large();
+  this->run_in_place(this->dyn_execution_);
+  this->check_large(this->v);
+}
+
+
+template <typename T>
+class scan_scheduling_test : public ::testing::Test {
+public:
+  T execution_;
+
+  vector<string> v;
+  vector<string> inclusive;
+  vector<string> exclusive;
+
+  void setup() {
+    string prefix;
+    for (int i=0; i<1000; ++i) {
+      v.push_back(to_string(i%10));
+      exclusive.push_back(prefix);
+      prefix += v.back();
+      inclusive.push_back(prefix);
+    }
+  }
+
+  template <typename E>
+  vector<string> run_concat(const E & e, scan_mode mode) {
+    vector<string> out(v.size());
+    auto concat = [](const string & x, const string & y) { return x + y; };
+    auto total = (mode == scan_mode::inclusive) ?
+        grppi::scan(e, v.begin(), v.end(), out.begin(), string{}, concat) :
+        grppi::exclusive_scan(e, v.begin(), v.end(), out.begin(), string{},
+            concat);
+    EXPECT_EQ(inclusive.back(), total);
+    return out;
+  }
+};
+
+// Scheduling is supported by native and OpenMP policies
+TYPED_TEST_CASE(scan_scheduling_test, executions_notbb);
+
+TYPED_TEST(scan_scheduling_test, non_commutative)
+{
+  this->setup();
+  this->execution_.set_concurrency_degree(4);
+  for (auto mode : {scheduling_mode::fixed, scheduling_mode::pinned,
+                    scheduling_mode::dynamic, scheduling_mode::guided}) 
+  {
+    for (std::size_t grain : {0, 1, 7, 5000}) {
+      this->execution_.set_scheduling(mode, grain);
+      EXPECT_EQ(this->inclusive, 
+          this->run_concat(this->execution_, scan_mode::inclusive));
+      EXPECT_EQ(this->exclusive, 
+          this->run_concat(this->execution_, scan_mode::exclusive));
+    }
+  }
+}
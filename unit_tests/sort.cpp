@@ -0,0 +1,165 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "sort.h"
+#include "map.h"
+#include "dyn/dynamic_execution.h"
+
+#include "supported_executions.h"
+
+using namespace std;
+using namespace grppi;
+
+template <typename T>
+class sort_test : public ::testing::Test {
+public:
+  T execution_;
+  dynamic_execution dyn_execution_{execution_};
+
+  template <typename U>
+  vector<U> random_values(std::size_t n, U low, U high) {
+    mt19937 engine{42};
+    uniform_int_distribution<long long> dist{low, high};
+    vector<U> result(n);
+    generate(result.begin(), result.end(), 
+        [&]() { return static_cast<U>(dist(engine)); });
+    return result;
+  }
+
+  template <typename E, typename U, typename Compare>
+  void check_sort(const E & e, vector<U> v, Compare comp) {
+    auto expected = v;
+    stable_sort(expected.begin(), expected.end(), comp);
+    grppi::sort(e, v.begin(), v.end(), comp);
+    EXPECT_EQ(expected, v);
+  }
+
+  template <typename E>
+  void run_empty(const E & e) {
+    vector<int> v;
+    grppi::sort(e, v.begin(), v.end());
+    EXPECT_TRUE(v.empty());
+    v = {42};
+    grppi::sort(e, v.begin(), v.end());
+    EXPECT_EQ(vector<int>{42}, v);
+  }
+
+  template <typename E>
+  void run_merge(const E & e) {
+    check_sort(e, random_values<int>(100000, -1000, 1000), greater<int>{});
+    check_sort(e, random_values<int>(10007, 0, 10), less<int>{});
+  }
+
+  template <typename E>
+  void run_radix(const E & e) {
+    check_sort(e, random_values<int>(200000, -1000000, 1000000), less<>{});
+    check_sort(e, random_values<unsigned>(100000, 0, 1u<<31), less<>{});
+    check_sort(e, random_values<int64_t>(100000, -(1ll<<40), 1ll<<40), 
+        less<int64_t>{});
+    check_sort(e, random_values<int8_t>(100000, -128, 127), less<>{});
+    check_sort(e, vector<short>(100000, 7), less<>{});
+  }
+
+  template <typename E>
+  void run_stable(const E & e) {
+    auto keys = random_values<int>(50000, 0, 100);
+    vector<pair<int,int>> v;
+    for (int i=0; i<static_cast<int>(keys.size()); ++i) { 
+      v.emplace_back(keys[i], i); 
+    }
+    check_sort(e, v, [](const auto & x, const auto & y) { 
+      return x.first < y.first; 
+    });
+  }
+
+  template <typename E>
+  void run_copy(const E & e) {
+    vector<string> v;
+    for (int i=0; i<20000; ++i) { v.push_back(to_string((i * 7919) % 20000)); }
+    vector<string> out(v.size());
+    auto last = grppi::sort_copy(e, v.begin(), v.end(), out.begin());
+    EXPECT_EQ(out.end(), last);
+    auto expected = v;
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(expected, out);
+  }
+};
+
+// Test for execution policies defined in supported_executions.h
+TYPED_TEST_CASE(sort_test, executions);
+
+TYPED_TEST(sort_test, static_empty)
+{
+  this->run_empty(this->execution_);
+}
+
+TYPED_TEST(sort_test, dyn_empty)
+{
+  this->run_empty(this->dyn_execution_);
+}
+
+TYPED_TEST(sort_test, static_merge)
+{
+  this->run_merge(this->execution_);
+}
+
+TYPED_TEST(sort_test, dyn_merge)
+{
+  this->run_merge(this->dyn_execution_);
+}
+
+TYPED_TEST(sort_test, static_radix)
+{
+  this->run_radix(this->execution_);
+}
+
+TYPED_TEST(sort_test, dyn_radix)
+{
+  this->run_radix(this->dyn_execution_);
+}
+
+TYPED_TEST(sort_test, static_stable)
+{
+  this->run_stable(this->execution_);
+}
+
+TYPED_TEST(sort_test, dyn_stable)
+{
+  this->run_stable(this->dyn_execution_);
+}
+
+TYPED_TEST(sort_test, static_copy)
+{
+  this->run_copy(this->execution_);
+}
+
+TYPED_TEST(sort_test, dyn_copy)
+{
+  this->run_copy(this->dyn_execution_);
+}
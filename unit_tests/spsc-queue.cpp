@@ -0,0 +1,130 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+#include <thread>
+#include <numeric>
+#include <iterator>
+
+#include <gtest/gtest.h>
+#include "common/spsc_queue.h"
+
+using namespace std;
+using namespace grppi;
+
+TEST(spsc_queue_blocking, constructor){
+  spsc_queue<int> queue(10, queue_mode::blocking);
+  EXPECT_EQ(true,queue.is_empty());
+}
+
+TEST(spsc_queue_lockfree, constructor){
+  spsc_queue<int> queue(10, queue_mode::lockfree);
+  EXPECT_EQ(true,queue.is_empty());
+}
+
+TEST(spsc_queue_blocking, push_pop){
+  spsc_queue<int> queue(10, queue_mode::blocking);
+  auto inserted = queue.push(1);
+  EXPECT_EQ(true, inserted);
+  EXPECT_EQ(false, queue.is_empty());
+  auto value = queue.pop();
+  EXPECT_EQ(true, queue.is_empty());
+  EXPECT_EQ(1,value);
+}
+
+TEST(spsc_queue_lockfree, push_pop){
+  spsc_queue<int> queue(10, queue_mode::lockfree);
+  auto inserted = queue.push(1);
+  EXPECT_EQ(true, inserted);
+  EXPECT_EQ(false, queue.is_empty());
+  auto value = queue.pop();
+  EXPECT_EQ(true, queue.is_empty());
+  EXPECT_EQ(1,value);
+}
+
+TEST(spsc_queue_blocking, concurrent_push_pop){
+  spsc_queue<long> queue(3, queue_mode::blocking);
+  std::thread producer([&](){ 
+    for (long i=0; i<10000; i++) queue.push(i);
+  });
+  long val = 0;
+  for (long i=0; i<10000; i++) {
+    auto item = queue.pop();
+    if (item != i) break;
+    val += item;
+  }
+  producer.join();
+  EXPECT_EQ(49995000, val);
+  EXPECT_EQ(true, queue.is_empty());
+}
+
+TEST(spsc_queue_lockfree, concurrent_push_pop){
+  spsc_queue<long> queue(3, queue_mode::lockfree);
+  std::thread producer([&](){ 
+    for (long i=0; i<10000; i++) queue.push(i);
+  });
+  long val = 0;
+  for (long i=0; i<10000; i++) {
+    auto item = queue.pop();
+    if (item != i) break;
+    val += item;
+  }
+  producer.join();
+  EXPECT_EQ(49995000, val);
+  EXPECT_EQ(true, queue.is_empty());
+}
+
+TEST(spsc_queue_blocking, bulk_push_pop){
+  spsc_queue<long> queue(5, queue_mode::blocking);
+  std::thread producer([&](){
+    std::vector<long> items(100);
+    for (long i=0; i<100; i++) {
+      std::iota(items.begin(), items.end(), i*100);
+      queue.push_bulk(items.begin(), items.end());
+    }
+  });
+  std::vector<long> values;
+  while (values.size()<10000) {
+    queue.pop_bulk(std::back_inserter(values), 7);
+  }
+  producer.join();
+  std::vector<long> expected(10000);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(expected, values);
+  EXPECT_EQ(0, queue.try_pop_bulk(std::back_inserter(values), 7));
+}
+
+TEST(spsc_queue_lockfree, bulk_push_pop){
+  spsc_queue<long> queue(5, queue_mode::lockfree);
+  std::thread producer([&](){
+    std::vector<long> items(100);
+    for (long i=0; i<100; i++) {
+      std::iota(items.begin(), items.end(), i*100);
+      queue.push_bulk(items.begin(), items.end());
+    }
+  });
+  std::vector<long> values;
+  while (values.size()<10000) {
+    queue.pop_bulk(std::back_inserter(values), 7);
+  }
+  producer.join();
+  std::vector<long> expected(10000);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(expected, values);
+  EXPECT_EQ(0, queue.try_pop_bulk(std::back_inserter(values), 7));
+}
@@ -274,3 +274,296 @@ TYPED_TEST(stencil_test, dyn_multiple)
   this->run_unary(this->dyn_execution_);
   this->check_multiple();
 }
+
+template <typename T>
+class fixed_stencil_test : public ::testing::Test {
+public:
+  T execution_;
+  dynamic_execution dyn_execution_{execution_};
+
+  vector<int> v{};
+  vector<int> v2{};
+  vector<int> w{};
+
+  void setup(std::size_t n) {
+    v.resize(n);
+    for (std::size_t i=0; i<n; ++i) { v[i] = static_cast<int>(i*i % 97); }
+    v2 = vector<int>(n, 1);
+    w = vector<int>(n, -1);
+  }
+
+  int at(std::ptrdiff_t i, boundary_mode boundary) const {
+    const auto n = static_cast<std::ptrdiff_t>(v.size());
+    if (i >= 0 && i < n) return v[i];
+    switch (boundary) {
+      case boundary_mode::clamp: return v[std::min(std::max(i, 
+          std::ptrdiff_t{0}), n-1)];
+      case boundary_mode::periodic: return v[(i % n + n) % n];
+      default: return 0;
+    }
+  }
+
+  // Weighted sum of neighbours at offsets -2, -1 and 3
+  template <typename E>
+  void run_unary(const E & e, boundary_mode boundary) {
+    grppi::stencil(e, begin(v), end(v), begin(w),
+      [](auto it, const auto & n) {
+        static_assert(std::is_same<std::decay_t<decltype(n)>, 
+            array<int,3>>::value, "neighbours are a fixed size array");
+        return *it + 2*n[0] + 3*n[1] + 5*n[2];
+      },
+      neighbour_offsets<-2,-1,3>{boundary});
+  }
+
+  void check_unary(boundary_mode boundary) {
+    for (std::size_t i=0; i<v.size(); ++i) {
+      const auto p = static_cast<std::ptrdiff_t>(i);
+      ASSERT_EQ(v[i] + 2*at(p-2,boundary) + 3*at(p-1,boundary) + 
+          5*at(p+3,boundary), w[i]) << "at " << i;
+    }
+  }
+
+  template <typename E>
+  void run_ary(const E & e) {
+    grppi::stencil(e, begin(v), end(v), begin(w),
+      [](auto it, const auto & n) { return *it + n[0] + n[1]; },
+      neighbour_offsets<-1,1>{boundary_mode::constant}, begin(v2));
+  }
+
+  void check_ary() {
+    for (std::size_t i=0; i<v.size(); ++i) {
+      const auto p = static_cast<std::ptrdiff_t>(i);
+      ASSERT_EQ(v[i] + at(p-1,boundary_mode::constant) + 
+          at(p+1,boundary_mode::constant), w[i]) << "at " << i;
+    }
+  }
+};
+
+TYPED_TEST_CASE(fixed_stencil_test, executions);
+
+TYPED_TEST(fixed_stencil_test, static_boundaries)
+{
+  for (auto boundary : {boundary_mode::clamp, boundary_mode::periodic,
+                        boundary_mode::constant}) {
+    for (std::size_t n : {0, 1, 2, 5, 10000}) {
+      this->setup(n);
+      this->run_unary(this->execution_, boundary);
+      this->check_unary(boundary);
+    }
+  }
+}
+
+TYPED_TEST(fixed_stencil_test, dyn_boundaries)
+{
+  for (auto boundary : {boundary_mode::clamp, boundary_mode::periodic,
+                        boundary_mode::constant}) {
+    for (std::size_t n : {0, 1, 2, 5, 10000}) {
+      this->setup(n);
+      this->run_unary(this->dyn_execution_, boundary);
+      this->check_unary(boundary);
+    }
+  }
+}
+
+TYPED_TEST(fixed_stencil_test, static_ary)
+{
+  this->setup(1000);
+  this->run_ary(this->execution_);
+  this->check_ary();
+}
+
+TYPED_TEST(fixed_stencil_test, dyn_ary)
+{
+  this->setup(1000);
+  this->run_ary(this->dyn_execution_);
+  this->check_ary();
+}
+
+template <typename T>
+class grid_stencil_test : public ::testing::Test {
+public:
+  T execution_;
+  dynamic_execution dyn_execution_{execution_};
+
+  vector<double> v{};
+  vector<double> w{};
+  vector<double> expected{};
+
+  // Sum of the element and its neighbours along every axis (5 points in 2D)
+  static auto cross() {
+    return [](const auto & n) {
+      double r = n.center();
+      for (int d=0; d<2; ++d) {
+        array<ptrdiff_t,2> off{{0,0}};
+        for (int k : {-1, 1}) {
+          off[d] = k;
+          r += n.at(off);
+        }
+      }
+      return r;
+    };
+  }
+
+  static auto heat() {
+    return [](const auto & n) {
+      return n(0,0,0) + 0.1 * (n(-1,0,0) + n(1,0,0) + n(0,-1,0) + 
+          n(0,1,0) + n(0,0,-1) + n(0,0,1) - 6 * n(0,0,0)) +
+          0.01 * n.position()[0];
+    };
+  }
+
+  static long wrap(long p, long n, boundary_mode mode, bool & outside) {
+    if (p >= 0 && p < n) return p;
+    switch (mode) {
+      case boundary_mode::clamp: return (p < 0) ? 0 : n-1;
+      case boundary_mode::periodic: return ((p % n) + n) % n;
+      default: outside = true; return 0;
+    }
+  }
+
+  // Reference computation of the cross stencil in 2D
+  void reference_cross(const grid_shape<2> & shape) {
+    const long ny = shape.extents[0], nx = shape.extents[1];
+    expected.assign(v.size(), 0);
+    for (long i=0; i<ny; ++i) {
+      for (long j=0; j<nx; ++j) {
+        double r = v[i*nx+j];
+        for (auto off : {make_pair(-1,0), make_pair(1,0), 
+                         make_pair(0,-1), make_pair(0,1)}) {
+          bool outside = false;
+          auto y = wrap(i+off.first, ny, shape.boundary, outside);
+          auto x = wrap(j+off.second, nx, shape.boundary, outside);
+          if (!outside) r += v[y*nx+x];
+        }
+        expected[i*nx+j] = r;
+      }
+    }
+  }
+
+  void setup_grid(size_t n) {
+    v.resize(n);
+    for (size_t i=0; i<n; ++i) { v[i] = (i * 37) % 101; }
+    w.assign(n, -1);
+  }
+
+  template <typename E>
+  void run_cross(const E & e, const grid_shape<2> & shape) {
+    setup_grid(shape.size());
+    reference_cross(shape);
+    grppi::stencil(e, shape, v.begin(), w.begin(), cross());
+  }
+
+  template <typename E>
+  void run_heat(const E & e, const grid_shape<3> & shape, size_t steps) {
+    setup_grid(shape.size());
+    // Reference computation with the sequential policy and no tiling
+    expected = v;
+    vector<double> aux(v.size());
+    auto untiled = shape;
+    untiled.tile = shape.extents;
+    for (size_t s=0; s<steps; ++s) {
+      grppi::stencil(sequential_execution{}, untiled, 
+          expected.begin(), aux.begin(), heat());
+      swap(expected, aux);
+    }
+    grppi::stencil(e, shape, v.begin(), w.begin(), steps, heat());
+  }
+
+  void check_cross() {
+    EXPECT_EQ(expected, w);
+  }
+
+  void check_heat() {
+    ASSERT_EQ(expected.size(), v.size());
+    for (size_t i=0; i<v.size(); ++i) {
+      EXPECT_DOUBLE_EQ(expected[i], v[i]);
+    }
+  }
+};
+
+TYPED_TEST_CASE(grid_stencil_test, executions);
+
+TYPED_TEST(grid_stencil_test, static_clamp_tiled)
+{
+  this->run_cross(this->execution_, 
+      grid_shape<2>{{{37,53}}, 1, boundary_mode::clamp, {{8,16}}});
+  this->check_cross();
+}
+
+TYPED_TEST(grid_stencil_test, dyn_clamp_tiled)
+{
+  this->run_cross(this->dyn_execution_, 
+      grid_shape<2>{{{37,53}}, 1, boundary_mode::clamp, {{8,16}}});
+  this->check_cross();
+}
+
+TYPED_TEST(grid_stencil_test, static_periodic)
+{
+  this->run_cross(this->execution_, 
+      grid_shape<2>{{{64,300}}, 1, boundary_mode::periodic});
+  this->check_cross();
+}
+
+TYPED_TEST(grid_stencil_test, dyn_periodic)
+{
+  this->run_cross(this->dyn_execution_, 
+      grid_shape<2>{{{64,300}}, 1, boundary_mode::periodic});
+  this->check_cross();
+}
+
+TYPED_TEST(grid_stencil_test, static_constant_single_row)
+{
+  this->run_cross(this->execution_, 
+      grid_shape<2>{{{1,10}}, 1, boundary_mode::constant, {{1,3}}});
+  this->check_cross();
+}
+
+TYPED_TEST(grid_stencil_test, dyn_constant_single_row)
+{
+  this->run_cross(this->dyn_execution_, 
+      grid_shape<2>{{{1,10}}, 1, boundary_mode::constant, {{1,3}}});
+  this->check_cross();
+}
+
+TYPED_TEST(grid_stencil_test, static_heat_steps)
+{
+  this->run_heat(this->execution_, 
+      grid_shape<3>{{{9,10,11}}, 1, boundary_mode::clamp, {{4,3,5}}}, 3);
+  this->check_heat();
+}
+
+TYPED_TEST(grid_stencil_test, dyn_heat_steps)
+{
+  this->run_heat(this->dyn_execution_, 
+      grid_shape<3>{{{9,10,11}}, 1, boundary_mode::periodic}, 4);
+  this->check_heat();
+}
+
+TYPED_TEST(grid_stencil_test, static_heat_time_tiled_clamp)
+{
+  this->run_heat(this->execution_, 
+      grid_shape<3>{{{9,10,11}}, 1, boundary_mode::clamp, {{4,3,5}}, 3}, 7);
+  this->check_heat();
+}
+
+TYPED_TEST(grid_stencil_test, dyn_heat_time_tiled_constant)
+{
+  this->run_heat(this->dyn_execution_, 
+      grid_shape<3>{{{9,10,11}}, 1, boundary_mode::constant, {{4,4,4}}, 4}, 9);
+  this->check_heat();
+}
+
+TYPED_TEST(grid_stencil_test, static_heat_time_tiled_periodic)
+{
+  // The halo of a tile is wider than the grid
+  this->run_heat(this->execution_, 
+      grid_shape<3>{{{5,4,6}}, 1, boundary_mode::periodic, {{2,2,3}}, 5}, 10);
+  this->check_heat();
+}
+
+TYPED_TEST(grid_stencil_test, dyn_heat_time_tiled_default)
+{
+  this->run_heat(this->dyn_execution_, 
+      grid_shape<3>{{{20,30,40}}, 1, boundary_mode::clamp}, 17);
+  this->check_heat();
+}
@@ -0,0 +1,129 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+#include <vector>
+#include <iterator>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include "map.h"
+#include "dyn/dynamic_execution.h"
+
+using namespace std;
+using namespace grppi;
+
+namespace {
+// Two NUMA nodes with two cores of two hardware threads each
+cpu_topology two_nodes() {
+  return cpu_topology{{
+    {0,0,0,0}, {1,1,0,0}, {2,0,0,0}, {3,1,0,0},
+    {4,0,1,1}, {5,1,1,1}, {6,0,1,1}, {7,1,1,1}
+  }};
+}
+}
+
+TEST(thread_affinity, parse_cpu_list){
+  EXPECT_EQ((vector<int>{0,1,2,3,8,10,11}), 
+      internal::parse_cpu_list("0-3,8,10-11"));
+  EXPECT_EQ((vector<int>{5}), internal::parse_cpu_list("5"));
+  EXPECT_TRUE(internal::parse_cpu_list("").empty());
+  EXPECT_TRUE(internal::parse_cpu_list("x-y").empty());
+}
+
+TEST(thread_affinity, no_placement){
+  auto cpus = two_nodes().placement(thread_placement::none, 3);
+  ASSERT_EQ(3u, cpus.size());
+  for (auto & c : cpus) { EXPECT_TRUE(c.empty()); }
+}
+
+TEST(thread_affinity, compact){
+  auto cpus = two_nodes().placement(thread_placement::compact, 5);
+  EXPECT_EQ((vector<vector<int>>{{0},{2},{1},{3},{4}}), cpus);
+}
+
+TEST(thread_affinity, scatter){
+  auto cpus = two_nodes().placement(thread_placement::scatter, 10);
+  EXPECT_EQ((vector<vector<int>>{{0},{4},{1},{5},{2},{6},{3},{7},{0},{4}}), 
+      cpus);
+}
+
+TEST(thread_affinity, numa_node){
+  auto topology = two_nodes();
+  EXPECT_EQ(2, topology.num_nodes());
+  auto cpus = topology.placement(thread_placement::numa_node, 3);
+  EXPECT_EQ((vector<vector<int>>{{0,2,1,3},{0,2,1,3},{4,6,5,7}}), cpus);
+}
+
+TEST(thread_affinity, machine_topology){
+  cpu_topology topology;
+  EXPECT_FALSE(topology.cpus().empty());
+  EXPECT_LE(1, topology.num_nodes());
+  auto cpus = topology.placement(thread_placement::compact, 1);
+  ASSERT_EQ(1u, cpus.size());
+  ASSERT_EQ(1u, cpus[0].size());
+
+#ifdef __linux__
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  ASSERT_EQ(0, sched_getaffinity(0, sizeof(allowed), &allowed));
+  for (const auto & info : topology.cpus()) {
+    EXPECT_TRUE(CPU_ISSET(info.cpu, &allowed));
+  }
+
+  bool bound = false;
+  std::thread t{[&]() { bound = bind_current_thread(cpus[0]); }};
+  t.join();
+  EXPECT_TRUE(bound);
+#endif
+}
+
+TEST(thread_affinity, native_execution){
+  parallel_execution_native ex{4};
+  EXPECT_EQ(thread_placement::none, ex.placement());
+  ex.set_thread_placement(thread_placement::compact);
+  EXPECT_EQ(thread_placement::compact, ex.placement());
+
+  auto copy = ex;
+  EXPECT_EQ(thread_placement::compact, copy.placement());
+
+  vector<int> v(1000);
+  for (int k=0; k<3; ++k) {
+    grppi::map(copy, begin(v), end(v), begin(v), [](int x) { return x+1; });
+  }
+  for (auto x : v) { EXPECT_EQ(3, x); }
+}
+
+TEST(thread_affinity, stable_chunks){
+  parallel_execution_native ex{4};
+  ex.set_scheduling(scheduling_mode::pinned);
+  vector<int> v(400);
+  vector<std::thread::id> first(v.size()), ids(v.size());
+  for (int k=0; k<10; ++k) {
+    grppi::map(ex, begin(v), end(v), begin(v), [&](const int & x) {
+      ids[&x - v.data()] = std::this_thread::get_id();
+      return x;
+    });
+    if (k == 0) first = ids;
+    EXPECT_EQ(first, ids);
+  }
+  // Every chunk runs in a different thread
+  EXPECT_NE(first[0], first[100]);
+  EXPECT_NE(first[100], first[200]);
+  EXPECT_NE(first[200], first[300]);
+}
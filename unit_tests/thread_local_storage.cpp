@@ -0,0 +1,154 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+#include <atomic>
+#include <vector>
+#include <numeric>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "map.h"
+#include "dyn/dynamic_execution.h"
+
+#include "supported_executions.h"
+
+using namespace std;
+using namespace grppi;
+
+template <typename T>
+class thread_local_storage_test : public ::testing::Test {
+public:
+  T execution_{};
+
+  vector<int> v{};
+  vector<int> w{};
+  std::atomic<int> invocations_init{0};
+
+  void setup_sequence(int n) {
+    v = vector<int>(n);
+    iota(v.begin(), v.end(), 0);
+    w = vector<int>(n);
+  }
+
+  template <typename S>
+  void run_map(S & storage) {
+    grppi::map(execution_, begin(v), end(v), begin(w),
+      [&storage](int x) {
+        auto & buffer = storage.local();
+        buffer.assign(16, x);
+        return accumulate(buffer.begin(), buffer.end(), 0);
+      });
+  }
+
+  void check_map() {
+    for (std::size_t i=0; i<v.size(); ++i) {
+      EXPECT_EQ(16*v[i], w[i]);
+    }
+  }
+
+  int max_instances() const {
+    return std::max(1, execution_.concurrency_degree());
+  }
+};
+
+TYPED_TEST_CASE(thread_local_storage_test, executions);
+
+TYPED_TEST(thread_local_storage_test, default_init)
+{
+  auto storage = this->execution_.template thread_local_storage<int>();
+  EXPECT_EQ(0, storage.size());
+  EXPECT_EQ(0, storage.local());
+  storage.local() = 42;
+  EXPECT_EQ(42, storage.local());
+  EXPECT_EQ(1, storage.size());
+}
+
+TYPED_TEST(thread_local_storage_test, map)
+{
+  this->setup_sequence(10000);
+  auto storage = this->execution_.template thread_local_storage<vector<int>>(
+    [this]() { 
+      this->invocations_init++; 
+      return vector<int>{}; 
+    });
+  this->run_map(storage);
+  this->check_map();
+  EXPECT_EQ(this->invocations_init, storage.size());
+  EXPECT_LE(storage.size(), this->max_instances());
+}
+
+TYPED_TEST(thread_local_storage_test, reuse)
+{
+  this->setup_sequence(10000);
+  auto storage = this->execution_.template thread_local_storage<vector<int>>(
+    [this]() { 
+      this->invocations_init++; 
+      return vector<int>{}; 
+    });
+  for (int i=0; i<5; ++i) {
+    this->run_map(storage);
+    this->check_map();
+  }
+  EXPECT_LE(this->invocations_init, this->max_instances());
+}
+
+TYPED_TEST(thread_local_storage_test, for_each)
+{
+  this->setup_sequence(10000);
+  auto storage = this->execution_.template thread_local_storage<long>();
+  grppi::map(this->execution_, begin(this->v), end(this->v), begin(this->w),
+    [&storage](int x) {
+      storage.local() += x;
+      return x;
+    });
+  long total = 0;
+  storage.for_each([&total](long partial) { total += partial; });
+  EXPECT_EQ(10000L * 9999L / 2, total);
+}
+
+TEST(thread_local_storage_native, concurrent_callers)
+{
+  parallel_execution_native ex{3};
+  auto storage = ex.thread_local_storage<long>();
+  constexpr int num_callers = 2;
+  constexpr int size = 10000;
+  std::atomic<int> started{0};
+  vector<thread> callers;
+  for (int c=0; c<num_callers; ++c) {
+    callers.emplace_back([&]() {
+      vector<int> v(size);
+      iota(v.begin(), v.end(), 0);
+      started++;
+      while (started < num_callers) { this_thread::yield(); }
+      for (int n=0; n<10; ++n) {
+        grppi::map(ex, begin(v), end(v), begin(v),
+          [&storage](int x) {
+            storage.local() += x;
+            return x;
+          });
+      }
+    });
+  }
+  for (auto & t : callers) { t.join(); }
+
+  long total = 0;
+  storage.for_each([&total](long partial) { total += partial; });
+  EXPECT_EQ(num_callers * 10L * size * (size-1L) / 2, total);
+}
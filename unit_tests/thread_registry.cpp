@@ -0,0 +1,298 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <set>
+#include <mutex>
+
+#include <gtest/gtest.h>
+#include "map.h"
+#include "dyn/dynamic_execution.h"
+
+using namespace std;
+using namespace grppi;
+
+TEST(thread_registry, unregistered){
+  thread_registry registry;
+  EXPECT_EQ(0, registry.current_index());
+  registry.register_thread();
+  EXPECT_EQ(0, registry.current_index());
+  registry.deregister_thread();
+}
+
+TEST(thread_registry, concurrent_indices){
+  thread_registry registry;
+  constexpr int num_threads = 8;
+  vector<int> indices(num_threads, -1);
+  std::atomic<int> registered{0};
+  std::atomic<bool> done{false};
+  vector<thread> threads;
+  for (int i=0; i<num_threads; ++i) {
+    threads.emplace_back([&,i]() {
+      native_thread_manager manager{registry};
+      registered++;
+      while (!done) { this_thread::yield(); }
+      indices[i] = registry.current_index();
+    });
+  }
+  while (registered < num_threads) { this_thread::yield(); }
+  done = true;
+  for (auto & t : threads) { t.join(); }
+
+  sort(indices.begin(), indices.end());
+  for (int i=0; i<num_threads; ++i) {
+    EXPECT_EQ(i, indices[i]);
+  }
+}
+
+TEST(thread_registry, unregistered_threads){
+  thread_registry registry;
+  constexpr int num_threads = 2;
+  vector<int> indices(num_threads, -1);
+  std::atomic<int> looked_up{0};
+  vector<thread> threads;
+  for (int i=0; i<num_threads; ++i) {
+    threads.emplace_back([&,i]() {
+      indices[i] = registry.current_index();
+      looked_up++;
+      while (looked_up < num_threads) { this_thread::yield(); }
+      EXPECT_EQ(indices[i], registry.current_index());
+    });
+  }
+  for (auto & t : threads) { t.join(); }
+  EXPECT_NE(indices[0], indices[1]);
+
+  // Indices are released when the threads finish
+  int index = -1;
+  thread t{[&]() { index = registry.current_index(); }};
+  t.join();
+  EXPECT_EQ(0, index);
+}
+
+TEST(thread_registry, reuse_indices){
+  thread_registry registry;
+  registry.register_thread();
+  for (int i=0; i<100; ++i) {
+    int index = -1;
+    thread t{[&]() {
+      native_thread_manager manager{registry};
+      index = registry.current_index();
+    }};
+    t.join();
+    EXPECT_EQ(1, index);
+  }
+  EXPECT_EQ(0, registry.current_index());
+  registry.deregister_thread();
+}
+
+TEST(thread_registry, nested_registration){
+  thread_registry registry;
+  registry.register_thread();
+  registry.register_thread();
+  EXPECT_EQ(0, registry.current_index());
+  registry.deregister_thread();
+  EXPECT_EQ(0, registry.current_index());
+
+  int index = -1;
+  thread t{[&]() {
+    native_thread_manager manager{registry};
+    index = registry.current_index();
+  }};
+  t.join();
+  EXPECT_EQ(1, index);
+  registry.deregister_thread();
+}
+
+TEST(thread_registry, independent_registries){
+  thread_registry first;
+  thread_registry second;
+  int index = -1;
+  thread t{[&]() {
+    native_thread_manager manager{second};
+    index = second.current_index();
+  }};
+  t.join();
+  EXPECT_EQ(0, index);
+
+  first.register_thread();
+  second.register_thread();
+  EXPECT_EQ(0, first.current_index());
+  EXPECT_EQ(0, second.current_index());
+  first.deregister_thread();
+  second.deregister_thread();
+}
+
+TEST(thread_registry, native_thread_ids){
+  parallel_execution_native ex{4};
+  for (int degree : {4, 2, 3}) {
+    ex.set_concurrency_degree(degree);
+    vector<int> ids(10000);
+    vector<int> values(ids.size());
+    ex.map(make_tuple(values.begin()), ids.begin(), ids.size(),
+      [&ex](int) { return ex.get_thread_id(); });
+    for (auto id : ids) {
+      EXPECT_LE(0, id);
+      EXPECT_GT(degree, id);
+    }
+  }
+}
+
+TEST(thread_registry, native_concurrent_callers){
+  parallel_execution_native ex{3};
+  constexpr int num_callers = 2;
+  vector<int> caller_ids(num_callers, -1);
+  vector<vector<int>> pattern_ids(num_callers);
+  std::atomic<int> started{0};
+  vector<thread> callers;
+  for (int c=0; c<num_callers; ++c) {
+    callers.emplace_back([&,c]() {
+      started++;
+      while (started < num_callers) { this_thread::yield(); }
+      const auto self = this_thread::get_id();
+      for (int n=0; n<20; ++n) {
+        vector<int> values(1000);
+        ex.map(make_tuple(values.begin()), values.begin(), values.size(),
+          [&,c,self](int v) {
+            if (this_thread::get_id() == self) {
+              pattern_ids[c].push_back(ex.get_thread_id());
+            }
+            return v;
+          });
+      }
+      caller_ids[c] = ex.get_thread_id();
+      started++;
+      while (started < 2*num_callers) { this_thread::yield(); }
+    });
+  }
+  for (auto & t : callers) { t.join(); }
+
+  EXPECT_NE(caller_ids[0], caller_ids[1]);
+  for (int c=0; c<num_callers; ++c) {
+    for (auto id : pattern_ids[c]) {
+      // Calling threads never share an index with workers
+      EXPECT_LE(ex.concurrency_degree()-1, id);
+    }
+  }
+}
+
+template <typename E>
+void check_caller_id(E & ex) {
+  for (int degree : {4, 2, 3}) {
+    ex.set_concurrency_degree(degree);
+    const auto self = this_thread::get_id();
+    vector<int> caller_ids;
+    vector<int> ids(10000);
+    vector<int> values(ids.size());
+    ex.map(make_tuple(values.begin()), ids.begin(), ids.size(),
+      [&ex,&caller_ids,self](int) { 
+        if (this_thread::get_id() != self) return ex.get_thread_id();
+        caller_ids.push_back(ex.get_thread_id());
+        return -1;
+      });
+    for (auto id : caller_ids) {
+      EXPECT_EQ(degree-1, id);
+    }
+    for (auto id : ids) {
+      // Elements of the calling thread are marked with -1
+      EXPECT_LE(-1, id);
+      EXPECT_GT(degree-1, id);
+    }
+  }
+}
+
+TEST(thread_registry, native_caller_id){
+  parallel_execution_native ex{4};
+  check_caller_id(ex);
+
+  int id = -1;
+  thread t{[&]() { id = ex.get_thread_id(); }};
+  t.join();
+  EXPECT_EQ(2, id);
+}
+
+template <typename E>
+set<thread::id> worker_threads(const E & ex) {
+  const auto self = this_thread::get_id();
+  mutex workers_mutex;
+  set<thread::id> workers;
+  vector<int> values(10000);
+  grppi::map(ex, values.begin(), values.end(), values.begin(),
+    [&,self](int v) {
+      if (this_thread::get_id() != self) {
+        lock_guard<mutex> lock{workers_mutex};
+        workers.insert(this_thread::get_id());
+      }
+      return v;
+    });
+  return workers;
+}
+
+TEST(thread_registry, native_move){
+  // Pinned chunks are run by every worker
+  parallel_execution_native ex{4};
+  ex.set_scheduling(scheduling_mode::pinned);
+  const auto workers = worker_threads(ex);
+  EXPECT_EQ(3, workers.size());
+
+  // Moves keep the workers instead of launching new ones
+  parallel_execution_native moved{std::move(ex)};
+  EXPECT_EQ(workers, worker_threads(moved));
+  dynamic_execution dyn{std::move(moved)};
+  EXPECT_EQ(workers, worker_threads(dyn));
+  dynamic_execution dyn_moved{std::move(dyn)};
+  EXPECT_EQ(workers, worker_threads(dyn_moved));
+
+  parallel_execution_native source{3};
+  source.set_scheduling(scheduling_mode::pinned);
+  const auto source_workers = worker_threads(source);
+  parallel_execution_native target{2};
+  target = std::move(source);
+  EXPECT_EQ(source_workers, worker_threads(target));
+  EXPECT_EQ(2, target.get_thread_id());
+}
+
+#ifdef GRPPI_OMP
+TEST(omp_thread_id, sequential){
+  parallel_execution_omp ex{4};
+  EXPECT_EQ(3, ex.get_thread_id());
+}
+
+TEST(omp_thread_id, map_ids){
+  parallel_execution_omp ex{4};
+  for (int degree : {4, 2, 3}) {
+    ex.set_concurrency_degree(degree);
+    vector<int> ids(10000);
+    vector<int> values(ids.size());
+    ex.map(make_tuple(values.begin()), ids.begin(), ids.size(),
+      [&ex](int) { return ex.get_thread_id(); });
+    for (auto id : ids) {
+      EXPECT_LE(0, id);
+      EXPECT_GT(degree, id);
+    }
+  }
+}
+
+TEST(omp_thread_id, caller_id){
+  parallel_execution_omp ex{4};
+  check_caller_id(ex);
+}
+#endif
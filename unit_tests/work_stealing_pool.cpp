@@ -0,0 +1,174 @@
+/**
+* @version		GrPPI v0.2
+* @copyright		Copyright (C) 2017 Universidad Carlos III de Madrid. All rights reserved.
+* @license		GNU/GPL, see LICENSE.txt
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You have received a copy of the GNU General Public License in LICENSE.txt
+* also available in <http://www.gnu.org/licenses/gpl.html>.
+*
+* See COPYRIGHT.txt for copyright notices and details.
+*/
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <stdexcept>
+#include <chrono>
+
+#include <gtest/gtest.h>
+#include "native/work_stealing_pool.h"
+
+using namespace std;
+using namespace grppi;
+
+namespace {
+struct no_manager {};
+auto no_init = [](int) { return no_manager{}; };
+}
+
+TEST(work_stealing_pool, constructor){
+  work_stealing_pool pool{3, no_init};
+  EXPECT_EQ(3, pool.num_workers());
+  EXPECT_FALSE(pool.try_run_one());
+}
+
+TEST(work_stealing_pool, run_tasks){
+  work_stealing_pool pool{3, no_init};
+  std::atomic<int> val{0};
+  {
+    task_group tasks{pool};
+    for (int i=1; i<=100; ++i) {
+      tasks.run([&val,i]() { val += i; });
+    }
+  }
+  EXPECT_EQ(5050, val);
+}
+
+TEST(work_stealing_pool, no_workers){
+  work_stealing_pool pool{0, no_init};
+  int val = 0;
+  task_group tasks{pool};
+  for (int i=1; i<=10; ++i) {
+    tasks.run([&val,i]() { val += i; });
+  }
+  tasks.wait();
+  EXPECT_EQ(55, val);
+}
+
+TEST(work_stealing_pool, submit_no_workers){
+  work_stealing_pool pool{0, no_init};
+  int val = 0;
+  pool.submit([&val]() { val++; });
+  pool.submit([&val]() { val++; }, 0);
+  EXPECT_EQ(2, val);
+}
+
+TEST(work_stealing_pool, init_exception){
+  std::atomic<int> initialized{0};
+  EXPECT_THROW((work_stealing_pool{4, [&](int i) {
+      if (i == 2) throw std::runtime_error{"init failed"};
+      initialized++;
+      return no_manager{};
+    }}), std::runtime_error);
+  EXPECT_EQ(3, initialized);
+}
+
+TEST(work_stealing_pool, blocking_wait){
+  work_stealing_pool pool{2, no_init};
+  std::atomic<int> val{0};
+  task_group tasks{pool};
+  // The calling thread runs out of tasks and blocks until they complete
+  for (int i=0; i<2; ++i) {
+    tasks.run_on(i, [&val]() { 
+      std::this_thread::sleep_for(std::chrono::milliseconds{20});
+      val++; 
+    });
+  }
+  tasks.wait();
+  EXPECT_EQ(2, val);
+}
+
+TEST(work_stealing_pool, nested_groups){
+  work_stealing_pool pool{2, no_init};
+  std::atomic<int> val{0};
+  {
+    task_group outer{pool};
+    for (int i=0; i<8; ++i) {
+      outer.run([&]() {
+        task_group inner{pool};
+        for (int j=0; j<8; ++j) {
+          inner.run([&val]() { val++; });
+        }
+      });
+    }
+  }
+  EXPECT_EQ(64, val);
+}
+
+TEST(work_stealing_pool, repeated_groups){
+  work_stealing_pool pool{4, no_init};
+  std::vector<int> v(1000, 1);
+  for (int k=0; k<100; ++k) {
+    task_group tasks{pool};
+    for (int i=0; i<10; ++i) {
+      tasks.run([&v,i]() {
+        for (int j=i*100; j<(i+1)*100; ++j) { v[j]++; }
+      });
+    }
+  }
+  for (auto x : v) { EXPECT_EQ(101, x); }
+}
+
+TEST(work_stealing_pool, pinned_tasks){
+  work_stealing_pool pool{3, no_init};
+  std::vector<std::thread::id> first(3), ids(3);
+  for (int k=0; k<20; ++k) {
+    task_group tasks{pool};
+    for (int w=0; w<3; ++w) {
+      tasks.run_on(w, [&ids,w]() { ids[w] = std::this_thread::get_id(); });
+    }
+    tasks.wait();
+    if (k == 0) first = ids;
+    EXPECT_EQ(first, ids);
+  }
+  EXPECT_NE(first[0], first[1]);
+  EXPECT_NE(first[1], first[2]);
+  EXPECT_NE(first[0], first[2]);
+  EXPECT_NE(std::this_thread::get_id(), first[0]);
+}
+
+TEST(work_stealing_pool, task_exception){
+  work_stealing_pool pool{3, no_init};
+  std::atomic<int> val{0};
+  task_group tasks{pool};
+  for (int i=0; i<10; ++i) {
+    tasks.run([&val,i]() {
+      if (i == 5) throw std::runtime_error{"task failed"};
+      val++;
+    });
+  }
+  EXPECT_THROW(tasks.wait(), std::runtime_error);
+  EXPECT_EQ(9, val);
+
+  // The group may be reused after collecting the exception
+  tasks.run([&val]() { val++; });
+  tasks.wait();
+  EXPECT_EQ(10, val);
+}
+
+TEST(work_stealing_pool, task_exception_not_waited){
+  work_stealing_pool pool{2, no_init};
+  {
+    task_group tasks{pool};
+    tasks.run_on(1, []() { throw std::runtime_error{"task failed"}; });
+  }
+  SUCCEED();
+}